@@ -39,7 +39,7 @@ if [ "$LAMBDA_build" = "Release" ] || [ "$LAMBDA_build" = "Debug" ]; then
         -DCMAKE_BUILD_TYPE="$LAMBDA_build" \
         -DLAMSCRIPT_BUILD_EXECUTABLE=OFF \
         -DLAMSCRIPT_BUILD_LIBRARY=OFF \
-        -DLAMSCRIPT_BUILD_TESTS=OFF \
+        -DLAMSCRIPT_BUILD_TESTS=ON \
         -DLAMSCRIPT_ENABLE_EXPERIMENTATION=ON
 elif [ "$LAMBDA_build" = "Dist" ]; then
     cmake .. \
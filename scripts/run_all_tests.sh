@@ -20,6 +20,12 @@ if [ $LAMBDA_os = "Linux" ] || [ $LAMBDA_os = "Macos" ]; then
     pushd "$ROOT_DIR/build/bin" > /dev/null
     cp -r "$ROOT_DIR/examples" examples
     ./lamscript_tests
+
+    # Only built when lamscripten is compiled.
+    if [ -f lamscripten_tests ]; then
+        ./lamscripten_tests
+        LAMBDA_ASSERT_LAST_COMMAND_OK "Lamscripten's tests failed."
+    fi
 elif [ "$LAMBDA_os" = "Windows" ]; then
     pushd "$ROOT_DIR/build/bin" > /dev/null
     cp -r "$ROOT_DIR/examples/" examples
@@ -1,12 +1,34 @@
 #ifdef LAMSCRIPT_BUILD_AS_EXECUTABLE
 
+#include <cstring>
 #include <iostream>
 
 #include <Lamscript/runtime/Lamscript.h>
 
 int main(int argc, char** argv) {
+  // Allows the optimizer and execution engines to be compared on the same
+  // scripts.
+  while (argc > 1 && strncmp(argv[1], "--", 2) == 0) {
+    if (strcmp(argv[1], "--no-optimize") == 0) {
+      lamscript::runtime::Lamscript::SetOptimizationsEnabled(false);
+    } else if (strcmp(argv[1], "--engine=closures") == 0) {
+      lamscript::runtime::Lamscript::SetExecutionEngine(
+          lamscript::runtime::ExecutionEngine::ClosureCompiler);
+    } else if (strcmp(argv[1], "--engine=tree") == 0) {
+      lamscript::runtime::Lamscript::SetExecutionEngine(
+          lamscript::runtime::ExecutionEngine::TreeWalker);
+    } else {
+      break;
+    }
+
+    argv++;
+    argc--;
+  }
+
   if (argc > 2) {
-    std::cout << "Usage: lamscript [script]" << std::endl;
+    std::cout
+        << "Usage: lamscript [--no-optimize] [--engine=tree|closures] [script]"
+        << std::endl;
     exit(64);
   } else if (argc == 2) {
     lamscript::runtime::ProgramResult result =
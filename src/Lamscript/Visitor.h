@@ -3,42 +3,54 @@
 
 #include <Lamscript/parsed/Expression.h>
 #include <Lamscript/parsed/Statement.h>
+#include <Lamscript/runtime/Completion.h>
+#include <Lamscript/runtime/Value.h>
 
 namespace lamscript {
 
 /// @brief The visitor interface that allows for expressions
 class ExpressionVisitor {
  public:
-  virtual std::any VisitAssignExpression(parsed::Assign* expression) = 0;
-  virtual std::any VisitBinaryExpression(parsed::Binary* expression) = 0;
-  virtual std::any VisitCallExpression(parsed::Call* expression) = 0;
-  virtual std::any VisitGetExpression(parsed::Get* expression) = 0;
-  virtual std::any VisitGroupingExpression(parsed::Grouping* expression) = 0;
-  virtual std::any VisitLiteralExpression(parsed::Literal* expression) = 0;
-  virtual std::any VisitLogicalExpression(parsed::Logical* expression) = 0;
-  virtual std::any VisitSetExpression(parsed::Set* expression) = 0;
-  virtual std::any VisitSuperExpression(parsed::Super* expression) = 0;
-  virtual std::any VisitThisExpression(parsed::This* expression) = 0;
-  virtual std::any VisitUnaryExpression(parsed::Unary* expression) = 0;
-  virtual std::any VisitVariableExpression(parsed::Variable* expression) = 0;
-  virtual std::any VisitLambdaExpression(
+  virtual runtime::Value VisitAssignExpression(parsed::Assign* expression) = 0;
+  virtual runtime::Value VisitBinaryExpression(parsed::Binary* expression) = 0;
+  virtual runtime::Value VisitCallExpression(parsed::Call* expression) = 0;
+  virtual runtime::Value VisitGetExpression(parsed::Get* expression) = 0;
+  virtual runtime::Value VisitGroupingExpression(
+      parsed::Grouping* expression) = 0;
+  virtual runtime::Value VisitLiteralExpression(
+      parsed::Literal* expression) = 0;
+  virtual runtime::Value VisitLogicalExpression(
+      parsed::Logical* expression) = 0;
+  virtual runtime::Value VisitSetExpression(parsed::Set* expression) = 0;
+  virtual runtime::Value VisitSuperExpression(parsed::Super* expression) = 0;
+  virtual runtime::Value VisitThisExpression(parsed::This* expression) = 0;
+  virtual runtime::Value VisitUnaryExpression(parsed::Unary* expression) = 0;
+  virtual runtime::Value VisitVariableExpression(
+      parsed::Variable* expression) = 0;
+  virtual runtime::Value VisitLambdaExpression(
       parsed::LambdaExpression* expression) = 0;
 };
 
 /// @brief The visitor interface for evaluating statements.
 class StatementVisitor {
  public:
-  virtual std::any VisitBlockStatement(parsed::Block* statement) = 0;
-  virtual std::any VisitClassStatement(parsed::Class* statement) = 0;
-  virtual std::any VisitExpressionStatement(
+  virtual runtime::Completion VisitBlockStatement(
+      parsed::Block* statement) = 0;
+  virtual runtime::Completion VisitClassStatement(
+      parsed::Class* statement) = 0;
+  virtual runtime::Completion VisitExpressionStatement(
       parsed::ExpressionStatement* statement) = 0;
-  virtual std::any VisitFunctionStatement(parsed::Function* statement) = 0;
-  virtual std::any VisitIfStatement(parsed::If* statement) = 0;
-  virtual std::any VisitPrintStatement(parsed::Print* statement) = 0;
-  virtual std::any VisitReturnStatement(parsed::Return* statement) = 0;
-  virtual std::any VisitVariableStatement(
+  virtual runtime::Completion VisitFunctionStatement(
+      parsed::Function* statement) = 0;
+  virtual runtime::Completion VisitIfStatement(parsed::If* statement) = 0;
+  virtual runtime::Completion VisitPrintStatement(
+      parsed::Print* statement) = 0;
+  virtual runtime::Completion VisitReturnStatement(
+      parsed::Return* statement) = 0;
+  virtual runtime::Completion VisitVariableStatement(
       parsed::VariableStatement* statement) = 0;
-  virtual std::any VisitWhileStatement(parsed::While* statement) = 0;
+  virtual runtime::Completion VisitWhileStatement(
+      parsed::While* statement) = 0;
 };
 
 
@@ -0,0 +1,21 @@
+#ifndef SRC_LAMSCRIPT_ERRORS_STACKOVERFLOWERROR_H_
+#define SRC_LAMSCRIPT_ERRORS_STACKOVERFLOWERROR_H_
+
+#include <string>
+
+#include <Lamscript/errors/RuntimeError.h>
+#include <Lamscript/parsing/Token.h>
+
+namespace lamscript {
+
+/// @brief Runtime error for running out of stack. Function bodies and blocks
+/// don't recover from it, so it unwinds every frame and stops the program.
+class StackOverflowError : public RuntimeError {
+ public:
+  explicit StackOverflowError(parsing::Token token)
+    : RuntimeError(token, "Stack overflow.") {}
+};
+
+}  // namespace lamscript
+
+#endif  // SRC_LAMSCRIPT_ERRORS_STACKOVERFLOWERROR_H_
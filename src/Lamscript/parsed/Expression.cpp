@@ -1,61 +1,59 @@
 #include <Lamscript/parsed/Expression.h>
 
-#include <any>
-
 #include <Lamscript/Visitor.h>
 
 namespace lamscript {
 namespace parsed {
 
-std::any Binary::Accept(ExpressionVisitor* visitor) {
+runtime::Value Binary::Accept(ExpressionVisitor* visitor) {
   return visitor->VisitBinaryExpression(this);
 }
 
-std::any Assign::Accept(ExpressionVisitor* visitor) {
+runtime::Value Assign::Accept(ExpressionVisitor* visitor) {
   return visitor->VisitAssignExpression(this);
 }
 
-std::any Call::Accept(ExpressionVisitor* visitor) {
+runtime::Value Call::Accept(ExpressionVisitor* visitor) {
   return visitor->VisitCallExpression(this);
 }
 
-std::any Get::Accept(ExpressionVisitor* visitor) {
+runtime::Value Get::Accept(ExpressionVisitor* visitor) {
   return visitor->VisitGetExpression(this);
 }
 
-std::any Grouping::Accept(ExpressionVisitor* visitor) {
+runtime::Value Grouping::Accept(ExpressionVisitor* visitor) {
   return visitor->VisitGroupingExpression(this);
 }
 
-std::any Literal::Accept(ExpressionVisitor* visitor) {
+runtime::Value Literal::Accept(ExpressionVisitor* visitor) {
   return visitor->VisitLiteralExpression(this);
 }
 
-std::any Logical::Accept(ExpressionVisitor* visitor) {
+runtime::Value Logical::Accept(ExpressionVisitor* visitor) {
   return visitor->VisitLogicalExpression(this);
 }
 
-std::any Set::Accept(ExpressionVisitor* visitor) {
+runtime::Value Set::Accept(ExpressionVisitor* visitor) {
   return visitor->VisitSetExpression(this);
 }
 
-std::any Super::Accept(ExpressionVisitor* visitor) {
+runtime::Value Super::Accept(ExpressionVisitor* visitor) {
   return visitor->VisitSuperExpression(this);
 }
 
-std::any This::Accept(ExpressionVisitor* visitor) {
+runtime::Value This::Accept(ExpressionVisitor* visitor) {
   return visitor->VisitThisExpression(this);
 }
 
-std::any Unary::Accept(ExpressionVisitor* visitor) {
+runtime::Value Unary::Accept(ExpressionVisitor* visitor) {
   return visitor->VisitUnaryExpression(this);
 }
 
-std::any Variable::Accept(ExpressionVisitor* visitor) {
+runtime::Value Variable::Accept(ExpressionVisitor* visitor) {
   return visitor->VisitVariableExpression(this);
 }
 
-std::any LambdaExpression::Accept(ExpressionVisitor* visitor) {
+runtime::Value LambdaExpression::Accept(ExpressionVisitor* visitor) {
   return visitor->VisitLambdaExpression(this);
 }
 
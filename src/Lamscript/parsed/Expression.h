@@ -1,11 +1,14 @@
 #ifndef SRC_LAMSCRIPT_PARSED_EXPRESSION_H_
 #define SRC_LAMSCRIPT_PARSED_EXPRESSION_H_
 
-#include <any>
 #include <memory>
+#include <string>
 #include <vector>
 
+#include <Lamscript/parsed/InlineCache.h>
+#include <Lamscript/parsed/TypeFeedback.h>
 #include <Lamscript/parsing/Token.h>
+#include <Lamscript/runtime/Value.h>
 
 namespace lamscript {
 
@@ -13,10 +16,47 @@ class ExpressionVisitor;
 
 namespace parsed {
 
+/// @brief Where a variable is stored at runtime.
+enum class VariableStorage {
+  /// @brief Variables that the resolver couldn't find in any local scope.
+  /// They're stored in the global environment and looked up by name.
+  Global,
+  /// @brief Locals stored directly in a slot of the current call frame on the
+  /// interpreters value stack.
+  Stack,
+  /// @brief Locals of the current call frame that are captured by a closure.
+  /// Their slot holds a heap allocated cell that's shared with the closures.
+  Cell,
+  /// @brief Variables captured from an enclosing function. Slot is the index
+  /// of the cell in the upvalues of the function that's currently running.
+  Upvalue
+};
+
+/// @brief Where a variable lives at runtime.
+struct VariableLocation {
+  VariableStorage Storage = VariableStorage::Global;
+  size_t Slot = 0;
+};
+
 class Expression {
  public:
-  virtual std::any Accept(ExpressionVisitor* visitor) = 0;
-//   virtual ~Expression();
+  virtual runtime::Value Accept(ExpressionVisitor* visitor) = 0;
+  virtual ~Expression() = default;
+};
+
+/// @brief Base class for expressions that refer to a variable. The resolver
+/// stores where the variable lives directly in the expression so that the
+/// interpreter doesn't have to look it up.
+class VariableReference : public Expression {
+ public:
+  const VariableLocation& GetLocation() const { return location_; }
+
+  /// @brief Allows the resolver to update the location after resolving the
+  /// expression (i.e. once it finds out that the variable is captured).
+  VariableLocation* GetMutableLocation() { return &location_; }
+
+ private:
+  VariableLocation location_;
 };
 
 /// @brief Binary expression handler.
@@ -28,29 +68,41 @@ class Binary : public Expression {
       std::unique_ptr<Expression> right)
           : left_(std::move(left)),
           operator_(expression_operator),
-          right_(std::move(right)) {}
+          right_(std::move(right)),
+          specialization_(BinarySpecialization::Uninitialized) {}
 
-  std::any Accept(ExpressionVisitor* visitor) override;
+  runtime::Value Accept(ExpressionVisitor* visitor) override;
 
   Expression* GetLeftSide() const { return left_.get(); }
   Expression* GetRightSide() const { return right_.get(); }
+  std::unique_ptr<Expression>* GetMutableLeftSide() { return &left_; }
+  std::unique_ptr<Expression>* GetMutableRightSide() { return &right_; }
   const parsing::Token& GetOperator() const { return operator_; }
 
+  /// @brief The operation the expression specialized itself into for the
+  /// operand types it has seen.
+  BinarySpecialization GetSpecialization() const { return specialization_; }
+  void Specialize(BinarySpecialization specialization) {
+    specialization_ = specialization;
+  }
+
  private:
   std::unique_ptr<Expression> left_;
   parsing::Token operator_;
   std::unique_ptr<Expression> right_;
+  BinarySpecialization specialization_;
 };
 
-class Assign : public Expression {
+class Assign : public VariableReference {
  public:
   Assign(
       parsing::Token name, std::unique_ptr<Expression> value)
           : name_(name), value_(std::move(value)) {}
 
-  std::any Accept(ExpressionVisitor* visitor) override;
+  runtime::Value Accept(ExpressionVisitor* visitor) override;
 
   Expression* GetValue() const { return value_.get(); }
+  std::unique_ptr<Expression>* GetMutableValue() { return &value_; }
   const parsing::Token& GetName() const { return name_; }
 
  private:
@@ -58,6 +110,26 @@ class Assign : public Expression {
   std::unique_ptr<Expression> value_;
 };
 
+class Get : public Expression {
+ public:
+  Get(
+      std::shared_ptr<Expression> object,
+      parsing::Token name)
+          : object_(std::move(object)), name_(name) {}
+
+  runtime::Value Accept(ExpressionVisitor* visitor) override;
+
+  std::shared_ptr<Expression> GetObject() const { return object_; }
+  std::shared_ptr<Expression>* GetMutableObject() { return &object_; }
+  const parsing::Token& GetName() const { return name_; }
+  InlineCache& GetCache() { return cache_; }
+
+ private:
+  std::shared_ptr<Expression> object_;
+  parsing::Token name_;
+  InlineCache cache_;
+};
+
 class Call : public Expression {
  public:
   Call(
@@ -65,49 +137,43 @@ class Call : public Expression {
       parsing::Token parentheses,
       std::vector<std::unique_ptr<Expression>>&& arguments)
           : callee_(std::move(callee)),
+          method_callee_(dynamic_cast<Get*>(callee_.get())),
           parentheses_(parentheses),
           arguments_(std::move(arguments)) {}
 
-  std::any Accept(ExpressionVisitor* visitor) override;
+  runtime::Value Accept(ExpressionVisitor* visitor) override;
 
   Expression* GetCallee() { return callee_.get(); }
+  std::unique_ptr<Expression>* GetMutableCallee() { return &callee_; }
+
+  /// @brief Gets the callee if it's a property access (e.g. `obj.method()`),
+  /// allowing methods to be invoked without binding them first.
+  Get* GetMethodCallee() { return method_callee_; }
+
   const parsing::Token& GetParentheses() { return parentheses_; }
   const std::vector<std::unique_ptr<Expression>>& GetArguments() {
       return arguments_; }
+  std::vector<std::unique_ptr<Expression>>* GetMutableArguments() {
+      return &arguments_; }
 
  private:
   std::unique_ptr<Expression> callee_;
+  Get* method_callee_;
   parsing::Token parentheses_;
   std::vector<std::unique_ptr<Expression>> arguments_;
 };
 
 
-class Get : public Expression {
- public:
-  Get(
-      std::shared_ptr<Expression> object,
-      parsing::Token name)
-          : object_(std::move(object)), name_(name) {}
-
-  std::any Accept(ExpressionVisitor* visitor) override;
-
-  std::shared_ptr<Expression> GetObject() const { return object_; }
-  const parsing::Token& GetName() const { return name_; }
-
- private:
-  std::shared_ptr<Expression> object_;
-  parsing::Token name_;
-};
-
 class Grouping : public Expression {
  public:
   explicit Grouping(
       std::unique_ptr<Expression> expression)
           : expression_(std::move(expression)) {}
 
-  std::any Accept(ExpressionVisitor* visitor) override;
+  runtime::Value Accept(ExpressionVisitor* visitor) override;
 
   Expression* GetExpression() const { return expression_.get(); }
+  std::unique_ptr<Expression>* GetMutableExpression() { return &expression_; }
  private:
   std::unique_ptr<Expression> expression_;
 };
@@ -115,14 +181,16 @@ class Grouping : public Expression {
 class Literal : public Expression {
  public:
   Literal() {}
-  explicit Literal(std::string literal) : value_(literal) {}
+  explicit Literal(const std::string& literal) : value_(literal) {}
+  explicit Literal(const runtime::Value& literal) : value_(literal) {}
   explicit Literal(double literal) : value_(literal) {}
+  explicit Literal(bool literal) : value_(literal) {}
 
-  std::any Accept(ExpressionVisitor* visitor) override;
+  runtime::Value Accept(ExpressionVisitor* visitor) override;
 
-  std::any GetValue() { return value_; }
+  const runtime::Value& GetValue() const { return value_; }
  private:
-  std::any value_;
+  runtime::Value value_;
 };
 
 class Logical : public Expression {
@@ -133,18 +201,29 @@ class Logical : public Expression {
       std::unique_ptr<Expression> right)
         : left_(std::move(left)),
         logical_operator_(logical_operator),
-        right_(std::move(right)) {}
+        right_(std::move(right)),
+        specialization_(LogicalSpecialization::Uninitialized) {}
 
-  std::any Accept(ExpressionVisitor* visitor) override;
+  runtime::Value Accept(ExpressionVisitor* visitor) override;
 
   Expression* GetLeftOperand() { return left_.get(); }
   const parsing::Token& GetLogicalOperator() { return logical_operator_; }
   Expression* GetRightOperand() { return right_.get(); }
+  std::unique_ptr<Expression>* GetMutableLeftOperand() { return &left_; }
+  std::unique_ptr<Expression>* GetMutableRightOperand() { return &right_; }
+
+  /// @brief The operation the expression specialized itself into for the
+  /// left operand types it has seen.
+  LogicalSpecialization GetSpecialization() const { return specialization_; }
+  void Specialize(LogicalSpecialization specialization) {
+    specialization_ = specialization;
+  }
 
  private:
   std::unique_ptr<Expression> left_;
   parsing::Token logical_operator_;
   std::unique_ptr<Expression> right_;
+  LogicalSpecialization specialization_;
 };
 
 class Set : public Expression {
@@ -155,42 +234,52 @@ class Set : public Expression {
       std::unique_ptr<Expression> value)
           : object_(object), name_(name), value_(std::move(value)) {}
 
-  std::any Accept(ExpressionVisitor* visitor) override;
+  runtime::Value Accept(ExpressionVisitor* visitor) override;
 
   std::shared_ptr<Expression> GetObject() { return object_; }
+  std::shared_ptr<Expression>* GetMutableObject() { return &object_; }
   Expression* GetValue() { return value_.get(); }
+  std::unique_ptr<Expression>* GetMutableValue() { return &value_; }
   const parsing::Token& GetName() const { return name_; }
+  InlineCache& GetCache() { return cache_; }
 
  private:
   std::shared_ptr<Expression> object_;
   parsing::Token name_;
   std::unique_ptr<Expression> value_;
+  InlineCache cache_;
 };
 
-class Super : public Expression {
+class This : public VariableReference {
  public:
-  Super(parsing::Token keyword, parsing::Token method)
-      : keyword_(keyword), method_(method) {}
-
-  std::any Accept(ExpressionVisitor* visitor) override;
+  explicit This(parsing::Token keyword) : keyword_(keyword) {}
 
+  runtime::Value Accept(ExpressionVisitor* visitor) override;
   const parsing::Token& GetKeyword() const { return keyword_; }
-  const parsing::Token& GetMethod() const { return method_; }
 
  private:
   parsing::Token keyword_;
-  parsing::Token method_;
 };
 
-class This : public Expression {
+/// @brief Super method accesses. The `this` expression is resolved alongside
+/// super so that the method can be bound to the current instance.
+class Super : public VariableReference {
  public:
-  explicit This(parsing::Token keyword) : keyword_(keyword) {}
+  Super(parsing::Token keyword, parsing::Token method)
+      : keyword_(keyword),
+      method_(method),
+      this_(parsing::Token{parsing::THIS, "this", nullptr, keyword.Line}) {}
+
+  runtime::Value Accept(ExpressionVisitor* visitor) override;
 
-  std::any Accept(ExpressionVisitor* visitor) override;
   const parsing::Token& GetKeyword() const { return keyword_; }
+  const parsing::Token& GetMethod() const { return method_; }
+  This* GetThis() { return &this_; }
 
  private:
   parsing::Token keyword_;
+  parsing::Token method_;
+  This this_;
 };
 
 class Unary : public Expression {
@@ -198,38 +287,60 @@ class Unary : public Expression {
   Unary(
       parsing::Token unary_operator,
       std::unique_ptr<Expression> right)
-          : unary_operator_(unary_operator), right_(std::move(right)) {}
+          : unary_operator_(unary_operator),
+          right_(std::move(right)),
+          specialization_(UnarySpecialization::Uninitialized) {}
 
-  std::any Accept(ExpressionVisitor* visitor) override;
+  runtime::Value Accept(ExpressionVisitor* visitor) override;
 
   Expression* GetRightExpression() const { return right_.get(); }
+  std::unique_ptr<Expression>* GetMutableRightExpression() { return &right_; }
   const parsing::Token& GetUnaryOperator() const { return unary_operator_; }
 
+  /// @brief The operation the expression specialized itself into for the
+  /// operand types it has seen.
+  UnarySpecialization GetSpecialization() const { return specialization_; }
+  void Specialize(UnarySpecialization specialization) {
+    specialization_ = specialization;
+  }
+
  private:
   parsing::Token unary_operator_;
   std::unique_ptr<Expression> right_;
+  UnarySpecialization specialization_;
 };
 
-class Variable : public Expression {
+class Statement;
+class VariableStatement;
+
+class Variable : public VariableReference {
  public:
-  explicit Variable(parsing::Token name) : name_(name) {}
+  explicit Variable(parsing::Token name)
+      : name_(name), declaration_(nullptr) {}
 
-  std::any Accept(ExpressionVisitor* visitor) override;
+  runtime::Value Accept(ExpressionVisitor* visitor) override;
 
   const parsing::Token& GetName() { return name_; }
 
+  /// @brief The var statement that declared the local variable being read,
+  /// or a nullptr for globals and any other kind of local (e.g. parameters).
+  /// Set by the resolver.
+  VariableStatement* GetDeclaration() const { return declaration_; }
+  void SetDeclaration(VariableStatement* declaration) {
+    declaration_ = declaration;
+  }
+
  private:
   parsing::Token name_;
+  VariableStatement* declaration_;
 };
 
-class Statement;
-
 class LambdaExpression : public Expression {
  public:
   explicit LambdaExpression(std::unique_ptr<Statement> lambda_function)
       : lambda_function_(std::move(lambda_function)) {}
 
-  std::any Accept(ExpressionVisitor* visitor) override;
+  runtime::Value Accept(ExpressionVisitor* visitor) override;
 
   Statement* GetFunctionStatement() { return lambda_function_.get(); }
  private:
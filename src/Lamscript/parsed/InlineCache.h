@@ -0,0 +1,61 @@
+#ifndef SRC_LAMSCRIPT_PARSED_INLINECACHE_H_
+#define SRC_LAMSCRIPT_PARSED_INLINECACHE_H_
+
+#include <array>
+#include <cstddef>
+#include <utility>
+
+#include <Lamscript/parsed/Shape.h>
+
+namespace lamscript {
+namespace parsed {
+
+/// @brief A cached property lookup for instances of a single shape. The
+/// entry holds onto its shapes, since the expression that caches it can
+/// outlive the class that they belong to.
+struct PropertyCacheEntry {
+  Ref<Shape> Receiver;
+  /// @brief The shape that a write moves the instance to when it adds the
+  /// property, or a nullptr if the instance already has it.
+  Ref<Shape> Transition;
+  size_t Slot;
+};
+
+/// @brief Caches the slots that a property expression resolved to, keyed by
+/// the shape of the instance it was accessed on.
+///
+/// The cache is monomorphic until the expression sees instances of a second
+/// shape and polymorphic up to kMaxEntries shapes. Once it's full (Also known
+/// as megamorphic) new shapes are looked up without being cached.
+class InlineCache {
+ public:
+  static constexpr size_t kMaxEntries = 4;
+
+  InlineCache() : size_(0) {}
+
+  /// @brief Finds the entry for the given shape, or a nullptr on a miss.
+  const PropertyCacheEntry* Lookup(const Shape* shape) const {
+    for (size_t i = 0; i < size_; i++) {
+      if (entries_[i].Receiver.get() == shape) {
+        return &entries_[i];
+      }
+    }
+
+    return nullptr;
+  }
+
+  void Update(PropertyCacheEntry entry) {
+    if (size_ < kMaxEntries) {
+      entries_[size_++] = std::move(entry);
+    }
+  }
+
+ private:
+  std::array<PropertyCacheEntry, kMaxEntries> entries_;
+  size_t size_;
+};
+
+}  // namespace parsed
+}  // namespace lamscript
+
+#endif  // SRC_LAMSCRIPT_PARSED_INLINECACHE_H_
@@ -1,20 +1,23 @@
 #ifndef SRC_LAMSCRIPT_PARSED_LAMSCRIPTCALLABLE_H_
 #define SRC_LAMSCRIPT_PARSED_LAMSCRIPTCALLABLE_H_
 
-#include <any>
-#include <vector>
 #include <string>
 
+#include <Lamscript/parsed/LamscriptObject.h>
 #include <Lamscript/runtime/Interpreter.h>
+#include <Lamscript/runtime/Value.h>
 
 namespace lamscript {
 namespace parsed {
 
-class LamscriptCallable {
+class LamscriptCallable : public LamscriptObject {
  public:
-  virtual int Arity() const = 0;
-  virtual std::any Call(
-      runtime::Interpreter* interpreter, std::vector<std::any> arguments) = 0;
+  static constexpr runtime::ValueType kValueType = runtime::ValueType::Callable;
+
+  virtual size_t Arity() const = 0;
+  virtual runtime::Value Call(
+      runtime::Interpreter* interpreter,
+      runtime::Arguments arguments) = 0;
   virtual std::string ToString() const = 0;
 };
 
@@ -2,104 +2,161 @@
 #define SRC_LAMSCRIPT_PARSED_LAMSCRIPTCLASS_H_
 
 #include <string>
+#include <vector>
 
 #include <Lamscript/parsed/LamscriptCallable.h>
 #include <Lamscript/parsed/LamscriptFunction.h>
+#include <Lamscript/parsed/LamscriptObject.h>
+#include <Lamscript/parsed/Shape.h>
+#include <Lamscript/parsing/Symbol.h>
+#include <Lamscript/runtime/Value.h>
 
 namespace lamscript {
 namespace parsed {
 
 class LamscriptInstance;
 
+/// @brief A lamscript class.
+///
+/// The method table of a class is flattened when the class is defined. It
+/// contains the methods of every super class that aren't overridden, so
+/// looking up a method never walks the inheritance chain.
 class LamscriptClass : public LamscriptCallable {
  public:
   LamscriptClass(
       const std::string& name,
-      std::shared_ptr<LamscriptClass> super_class,
-      std::unordered_map<std::string, LamscriptFunction>&& methods)
-              : name_(name), super_class_(super_class), methods_(methods) {}
-
-  int Arity() const override {
-    try {
-      const LamscriptFunction& initializer = LookupMethod("constructor");
-      return initializer.Arity();
-    } catch (const std::out_of_range& err) {
-      return 0;
+      Ref<LamscriptClass> super_class,
+      parsing::SymbolMap<Ref<LamscriptFunction>>&& methods)
+              : name_(name),
+              super_class_(super_class),
+              methods_(std::move(methods)),
+              constructor_(nullptr),
+              root_shape_(MakeRef<Shape>()) {
+    if (super_class_ != nullptr) {
+      // Doesn't replace methods that this class overrides.
+      methods_.insert(
+          super_class_->methods_.begin(), super_class_->methods_.end());
     }
-  }
-
-  std::any Call(
-      runtime::Interpreter* interpreter,
-      std::vector<std::any> arguments) override {
-    std::shared_ptr<LamscriptInstance> instance = std::make_shared<
-        LamscriptInstance>(this);
 
-    try {
-      const LamscriptFunction& initializer = LookupMethod("constructor");
-      initializer.Bind(instance)->Call(interpreter, arguments);
-    } catch (const std::out_of_range& err) {}
+    constructor_ = LookupMethod(parsing::Symbol::Intern("constructor"));
+  }
 
-    return instance;
+  size_t Arity() const override {
+    return constructor_ != nullptr ? constructor_->Arity() : 0;
   }
 
-  /// @brief Looks up a method inside of the current class definition. If it
-  /// doesn't exist, returns a nullptr.
-  const LamscriptFunction& LookupMethod(const std::string& method_name) const {
+  runtime::Value Call(
+      runtime::Interpreter* interpreter,
+      runtime::Arguments arguments) override;
+
+  /// @brief Looks up a method of the class or any of its super classes.
+  /// Returns a nullptr if the class doesn't have the method.
+  const LamscriptFunction* LookupMethod(parsing::Symbol method_name) const {
     auto lookup = methods_.find(method_name);
 
     if (lookup != methods_.end()) {
-      return lookup->second;
+      return lookup->second.get();
     }
 
-    if (super_class_ != nullptr) {
-      return super_class_->LookupMethod(method_name);
-    }
-
-    throw std::out_of_range("Lookup out of range.");
+    return nullptr;
   }
 
   std::string ToString() const override { return name_; }
 
+  /// @brief Gets the shape of instances that don't have any fields yet.
+  Shape* GetRootShape() const { return root_shape_.get(); }
+
  private:
   std::string name_;
-  std::shared_ptr<LamscriptClass> super_class_;
-  std::unordered_map<std::string, parsed::LamscriptFunction> methods_;
+  Ref<LamscriptClass> super_class_;
+  parsing::SymbolMap<Ref<LamscriptFunction>> methods_;
+  const LamscriptFunction* constructor_;
+  Ref<Shape> root_shape_;
 };
 
 
 /// @brief Instance of a lamscript class.
-class LamscriptInstance :
-    public std::enable_shared_from_this<LamscriptInstance> {
+///
+/// Fields are stored in a dense vector of slots, and the instance's shape maps
+/// field names to those slots.
+class LamscriptInstance : public LamscriptObject {
  public:
-  explicit LamscriptInstance(
-      LamscriptClass* class_def) : class_def_(class_def) {}
+  static constexpr runtime::ValueType kValueType = runtime::ValueType::Instance;
+
+  explicit LamscriptInstance(LamscriptClass* class_def)
+      : class_def_(class_def), shape_(class_def->GetRootShape()) {}
+
+  LamscriptClass* GetClass() const { return class_def_.get(); }
+  Shape* GetShape() const { return shape_.get(); }
+
+  /// @brief Finds a field without falling back to the methods of the class.
+  /// Returns a nullptr if the instance has no field with the given name.
+  const runtime::Value* FindField(parsing::Symbol name) const {
+    size_t slot = shape_->FindSlot(name);
+    if (slot != Shape::kNotFound) {
+      return &fields_[slot];
+    }
+
+    return nullptr;
+  }
+
+  const runtime::Value& GetSlot(size_t slot) const { return fields_[slot]; }
+  void SetSlot(size_t slot, const runtime::Value& value) {
+    fields_[slot] = value;
+  }
+
+  /// @brief Adds a new field, moving the instance to the shape that's reached
+  /// by adding it to the instance's current shape.
+  void AddSlot(Shape* shape, const runtime::Value& value) {
+    shape_ = Ref<Shape>(shape);
+    fields_.push_back(value);
+  }
 
-  std::any GetField(const parsing::Token& name) {
-    if (fields_.contains(name.Lexeme)) {
-      return fields_.at(name.Lexeme);
+  runtime::Value GetField(const parsing::Token& name) {
+    if (const runtime::Value* field = FindField(name.Identifier)) {
+      return *field;
     }
 
     // Binds the function to the current instance, allowing the use of `this`
     // to correctly be resolved.
-    try {
-      const LamscriptFunction& method = class_def_->LookupMethod(name.Lexeme);
-      return method.Bind(shared_from_this());
-    } catch (const std::out_of_range& err) {
+    const LamscriptFunction* method = class_def_->LookupMethod(name.Identifier);
+    if (method == nullptr) {
       throw RuntimeError(name, "Undefined property '" + name.Lexeme + "'.");
     }
+
+    return method->Bind(this);
   }
 
-  void SetField(const parsing::Token& name, std::any value) {
-    fields_[name.Lexeme] = value;
+  void SetField(const parsing::Token& name, const runtime::Value& value) {
+    size_t slot = shape_->FindSlot(name.Identifier);
+    if (slot != Shape::kNotFound) {
+      fields_[slot] = value;
+      return;
+    }
+
+    AddSlot(shape_->AddField(name.Identifier), value);
   }
 
   std::string ToString() const { return class_def_->ToString() + " Instance"; }
 
  private:
-  LamscriptClass* class_def_;
-  std::unordered_map<std::string, std::any> fields_;
+  Ref<LamscriptClass> class_def_;
+  Ref<Shape> shape_;
+  std::vector<runtime::Value> fields_;
 };
 
+inline runtime::Value LamscriptClass::Call(
+    runtime::Interpreter* interpreter,
+    runtime::Arguments arguments) {
+  runtime::Value instance = MakeRef<LamscriptInstance>(this);
+
+  if (constructor_ != nullptr) {
+    constructor_->Invoke(interpreter, instance, arguments);
+  }
+
+  return instance;
+}
+
 }  // namespace parsed
 }  // namespace lamscript
 
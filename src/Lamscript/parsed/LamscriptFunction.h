@@ -1,68 +1,68 @@
 #ifndef SRC_LAMSCRIPT_PARSED_LAMSCRIPTFUNCTION_H_
 #define SRC_LAMSCRIPT_PARSED_LAMSCRIPTFUNCTION_H_
 
-#include <any>
-#include <memory>
 #include <iostream>
+#include <utility>
+#include <vector>
 
 #include <Lamscript/parsed/LamscriptCallable.h>
-#include <Lamscript/parsed/LamscriptReturnValue.h>
+#include <Lamscript/parsed/LamscriptObject.h>
 #include <Lamscript/parsed/Statement.h>
-#include <Lamscript/runtime/Environment.h>
+#include <Lamscript/runtime/Cell.h>
+#include <Lamscript/runtime/Completion.h>
 #include <Lamscript/runtime/Interpreter.h>
+#include <Lamscript/runtime/Value.h>
 
 namespace lamscript {
 namespace parsed {
 
-class LamscriptInstance;
-
 class LamscriptFunction : public LamscriptCallable {
  public:
+  /// @brief Creates a function from its declaration. The declaration is owned
+  /// by the parsed program, which the function keeps alive.
   LamscriptFunction(
-      std::shared_ptr<Function> declaration,
-      std::shared_ptr<runtime::Environment> closure,
-      bool is_initializer)
+      Function* declaration,
+      SharedProgram program,
+      std::vector<Ref<runtime::Cell>> upvalues,
+      bool is_initializer,
+      runtime::Value receiver = nullptr)
           : declaration_(declaration),
-          closure_(closure),
-          is_initializer_(is_initializer) {}
+          program_(std::move(program)),
+          upvalues_(std::move(upvalues)),
+          is_initializer_(is_initializer),
+          receiver_(receiver) {}
 
   /// @brief Enables functions to bind to whatever instance they desire,
   /// allowing `this` expressions to be resolved to their correct scope.
-  std::shared_ptr<LamscriptCallable> Bind(
-      std::shared_ptr<LamscriptInstance> instance) const {
-    std::shared_ptr<runtime::Environment> function_env =
-        std::make_shared<runtime::Environment>(closure_);
-
-    function_env->SetVariable(
-        parsing::Token{parsing::THIS, "this", nullptr, 0}, instance);
-
-    std::shared_ptr<LamscriptCallable> callable;
-    callable.reset(
-        new LamscriptFunction(declaration_, function_env, is_initializer_));
-    return callable;
+  Ref<LamscriptFunction> Bind(const runtime::Value& instance) const {
+    return MakeRef<LamscriptFunction>(
+        declaration_, program_, upvalues_, is_initializer_, instance);
   }
 
-  int Arity() const override { return declaration_->GetParams().size(); }
+  size_t Arity() const override { return declaration_->GetParams().size(); }
 
-  std::any Call(
+  runtime::Value Call(
       runtime::Interpreter* interpreter,
-      std::vector<std::any> arguments) override {
-    std::shared_ptr<runtime::Environment> function_env =
-        std::make_shared<runtime::Environment>(closure_);
+      runtime::Arguments arguments) override {
+    return Invoke(interpreter, receiver_, arguments);
+  }
 
-    const std::vector<parsing::Token>& params = declaration_->GetParams();
-    for (size_t i = 0; i < params.size(); i++) {
-      function_env->SetVariable(params[i], arguments[i]);
-    }
+  /// @brief Calls the function as a method of the given receiver without
+  /// binding it to the receiver first.
+  runtime::Value Invoke(
+      runtime::Interpreter* interpreter,
+      const runtime::Value& receiver,
+      runtime::Arguments arguments) const {
+    runtime::Completion completion = interpreter->ExecuteFrame(
+        declaration_, program_, upvalues_, receiver, arguments);
+
+    if (completion == runtime::Completion::Return) {
+      runtime::Value returned_value = interpreter->TakeReturnValue();
 
-    try {
-      interpreter->ExecuteBlock(declaration_->GetBody(), function_env);
-    } catch (const LamscriptReturnValue& value_container) {
       if (is_initializer_) {
-        return closure_->GetVariableAtScope(
-            0, parsing::Token{parsing::THIS, "this", nullptr, 0});
+        return receiver;
       }
-      return value_container.GetReturnedValue();
+      return returned_value;
     }
 
     return nullptr;
@@ -76,9 +76,11 @@ class LamscriptFunction : public LamscriptCallable {
   const bool IsGetter() const { return declaration_->IsGetter(); }
 
  private:
+  Function* declaration_;
+  SharedProgram program_;
+  std::vector<Ref<runtime::Cell>> upvalues_;
   bool is_initializer_;
-  std::shared_ptr<Function> declaration_;
-  std::shared_ptr<runtime::Environment> closure_;
+  runtime::Value receiver_;
 };
 
 }  // namespace parsed
@@ -0,0 +1,90 @@
+#ifndef SRC_LAMSCRIPT_PARSED_LAMSCRIPTOBJECT_H_
+#define SRC_LAMSCRIPT_PARSED_LAMSCRIPTOBJECT_H_
+
+#include <cstddef>
+#include <utility>
+
+namespace lamscript {
+namespace parsed {
+
+/// @brief Base class for every heap allocated lamscript object (strings,
+/// callables, and instances).
+///
+/// Objects are reference counted intrusively so that a runtime::Value can
+/// refer to one with a single pointer instead of a std::shared_ptr and its
+/// control block. The interpreter is single threaded, so the count isn't
+/// atomic.
+class LamscriptObject {
+ public:
+  LamscriptObject() : reference_count_(0) {}
+  virtual ~LamscriptObject() = default;
+
+  LamscriptObject(const LamscriptObject&) = delete;
+  LamscriptObject& operator=(const LamscriptObject&) = delete;
+
+  void Retain() { reference_count_++; }
+
+  size_t GetReferenceCount() const { return reference_count_; }
+
+  /// @brief Drops a reference to the object and deletes it once nothing
+  /// references it anymore.
+  void Release() {
+    if (--reference_count_ == 0) {
+      delete this;
+    }
+  }
+
+ private:
+  size_t reference_count_;
+};
+
+/// @brief Owning reference to a heap allocated lamscript object. Used for
+/// holding onto objects with a known type outside of a runtime::Value.
+template<class ObjectType>
+class Ref {
+ public:
+  Ref() : object_(nullptr) {}
+  Ref(std::nullptr_t) : object_(nullptr) {}  // NOLINT(runtime/explicit)
+
+  explicit Ref(ObjectType* object) : object_(object) {
+    if (object_ != nullptr) {
+      object_->Retain();
+    }
+  }
+
+  Ref(const Ref& other) : Ref(other.object_) {}
+  Ref(Ref&& other) : object_(std::exchange(other.object_, nullptr)) {}
+
+  ~Ref() {
+    if (object_ != nullptr) {
+      object_->Release();
+    }
+  }
+
+  Ref& operator=(Ref other) {
+    std::swap(object_, other.object_);
+    return *this;
+  }
+
+  ObjectType* get() const { return object_; }
+  ObjectType* operator->() const { return object_; }
+  ObjectType& operator*() const { return *object_; }
+  explicit operator bool() const { return object_ != nullptr; }
+
+  bool operator==(std::nullptr_t) const { return object_ == nullptr; }
+
+ private:
+  ObjectType* object_;
+};
+
+/// @brief Allocates a new object of the given type and returns the first
+/// reference to it.
+template<class ObjectType, class... Args>
+Ref<ObjectType> MakeRef(Args&&... args) {
+  return Ref<ObjectType>(new ObjectType(std::forward<Args>(args)...));
+}
+
+}  // namespace parsed
+}  // namespace lamscript
+
+#endif  // SRC_LAMSCRIPT_PARSED_LAMSCRIPTOBJECT_H_
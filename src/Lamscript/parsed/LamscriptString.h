@@ -0,0 +1,122 @@
+#ifndef SRC_LAMSCRIPT_PARSED_LAMSCRIPTSTRING_H_
+#define SRC_LAMSCRIPT_PARSED_LAMSCRIPTSTRING_H_
+
+#include <cstddef>
+#include <string>
+#include <utility>
+#include <vector>
+
+#include <Lamscript/parsed/LamscriptObject.h>
+
+namespace lamscript {
+namespace parsed {
+
+/// @brief Immutable string object. Copying a string value only copies the
+/// reference to it.
+///
+/// Concatenating two strings creates a rope that references both of them
+/// instead of copying their characters. The rope is flattened into a single
+/// string the first time its characters are read, so building a string by
+/// repeatedly appending to it is linear in its final length.
+class LamscriptString : public LamscriptObject {
+ public:
+  explicit LamscriptString(std::string value)
+      : value_(std::move(value)), length_(value_.size()) {}
+
+  /// @brief Creates the lazy concatenation of two strings.
+  LamscriptString(Ref<LamscriptString> left, Ref<LamscriptString> right)
+      : length_(left->length_ + right->length_),
+      left_(std::move(left)),
+      right_(std::move(right)) {}
+
+  /// @brief Releases the strings of a rope without recursing through them, so
+  /// that destroying a rope built from many appends can't overflow the native
+  /// stack.
+  ~LamscriptString() override {
+    if (!left_) {
+      return;
+    }
+
+    std::vector<Ref<LamscriptString>> pending;
+    pending.push_back(std::move(left_));
+    pending.push_back(std::move(right_));
+
+    while (!pending.empty()) {
+      Ref<LamscriptString> string = std::move(pending.back());
+      pending.pop_back();
+
+      if (string->GetReferenceCount() == 1 && string->left_) {
+        pending.push_back(std::move(string->left_));
+        pending.push_back(std::move(string->right_));
+      }
+    }
+  }
+
+  /// @brief Concatenates two strings. Short results are copied into a new
+  /// string since they're cheaper to copy than to reference.
+  static Ref<LamscriptString> Concatenate(
+      LamscriptString* left, LamscriptString* right) {
+    if (left->length_ == 0) {
+      return Ref<LamscriptString>(right);
+    }
+
+    if (right->length_ == 0) {
+      return Ref<LamscriptString>(left);
+    }
+
+    if (left->length_ + right->length_ <= kMaxCopiedLength) {
+      return MakeRef<LamscriptString>(left->GetValue() + right->GetValue());
+    }
+
+    return MakeRef<LamscriptString>(
+        Ref<LamscriptString>(left), Ref<LamscriptString>(right));
+  }
+
+  /// @brief Gets the characters of the string, flattening it if it's a rope.
+  const std::string& GetValue() const {
+    if (left_) {
+      Flatten();
+    }
+
+    return value_;
+  }
+
+  /// @brief Gets the length of the string without flattening it.
+  size_t GetLength() const { return length_; }
+
+ private:
+  static constexpr size_t kMaxCopiedLength = 32;
+
+  mutable std::string value_;
+  size_t length_;
+  mutable Ref<LamscriptString> left_;
+  mutable Ref<LamscriptString> right_;
+
+  /// @brief Copies the characters of the rope into value_ and releases the
+  /// strings it was built from. Walks the rope with an explicit stack since
+  /// ropes can be arbitrarily deep.
+  void Flatten() const {
+    value_.reserve(length_);
+    std::vector<const LamscriptString*> pending = {right_.get(), left_.get()};
+
+    while (!pending.empty()) {
+      const LamscriptString* string = pending.back();
+      pending.pop_back();
+
+      if (string->left_) {
+        pending.push_back(string->right_.get());
+        pending.push_back(string->left_.get());
+      } else {
+        value_.append(string->value_);
+      }
+    }
+
+    left_ = nullptr;
+    right_ = nullptr;
+  }
+};
+
+}  // namespace parsed
+}  // namespace lamscript
+
+#endif  // SRC_LAMSCRIPT_PARSED_LAMSCRIPTSTRING_H_
@@ -0,0 +1,69 @@
+#ifndef SRC_LAMSCRIPT_PARSED_SHAPE_H_
+#define SRC_LAMSCRIPT_PARSED_SHAPE_H_
+
+#include <cstddef>
+
+#include <Lamscript/parsed/LamscriptObject.h>
+#include <Lamscript/parsing/Symbol.h>
+
+namespace lamscript {
+namespace parsed {
+
+/// @brief The layout of an instance's fields (Also known as a hidden class).
+///
+/// A shape maps field names to slots in an instance. Adding a field moves an
+/// instance to a child shape, and instances of a class that add the same
+/// fields in the same order end up sharing the same shape.
+///
+/// Shapes are reference counted. A class holds its root shape, shapes hold
+/// the shapes that adding a field leads to, and instances and inline caches
+/// hold the shapes that they refer to. A shape can't be freed (and its
+/// address reused by another class's shape) while a cache still compares
+/// against it.
+class Shape : public LamscriptObject {
+ public:
+  /// @brief Returned by FindSlot when the shape doesn't have the field.
+  static constexpr size_t kNotFound = static_cast<size_t>(-1);
+
+  Shape() = default;
+
+  /// @brief Finds the slot of a field, or kNotFound if the shape doesn't
+  /// have a field with the given name.
+  size_t FindSlot(parsing::Symbol name) const {
+    auto lookup = slots_.find(name);
+    if (lookup != slots_.end()) {
+      return lookup->second;
+    }
+
+    return kNotFound;
+  }
+
+  /// @brief Gets the shape of an instance after adding the field to it. The
+  /// new field is stored in the slot after the last field of this shape. The
+  /// returned shape is kept alive by this one.
+  Shape* AddField(parsing::Symbol name) {
+    auto lookup = transitions_.find(name);
+    if (lookup != transitions_.end()) {
+      return lookup->second.get();
+    }
+
+    Ref<Shape> child = MakeRef<Shape>();
+    child->slots_ = slots_;
+    child->slots_.emplace(name, slots_.size());
+
+    Shape* child_shape = child.get();
+    transitions_.emplace(name, std::move(child));
+    return child_shape;
+  }
+
+  size_t GetFieldCount() const { return slots_.size(); }
+
+ private:
+  parsing::SymbolMap<size_t> slots_;
+  parsing::SymbolMap<Ref<Shape>> transitions_;
+};
+
+}  // namespace parsed
+}  // namespace lamscript
+
+#endif  // SRC_LAMSCRIPT_PARSED_SHAPE_H_
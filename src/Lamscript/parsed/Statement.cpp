@@ -5,39 +5,39 @@
 namespace lamscript {
 namespace parsed {
 
-std::any Block::Accept(StatementVisitor* visitor) {
+runtime::Completion Block::Accept(StatementVisitor* visitor) {
   return visitor->VisitBlockStatement(this);
 }
 
-std::any ExpressionStatement::Accept(StatementVisitor* visitor) {
+runtime::Completion ExpressionStatement::Accept(StatementVisitor* visitor) {
   return visitor->VisitExpressionStatement(this);
 }
 
-std::any Function::Accept(StatementVisitor* visitor) {
+runtime::Completion Function::Accept(StatementVisitor* visitor) {
   return visitor->VisitFunctionStatement(this);
 }
 
-std::any Class::Accept(StatementVisitor* visitor) {
+runtime::Completion Class::Accept(StatementVisitor* visitor) {
   return visitor->VisitClassStatement(this);
 }
 
-std::any If::Accept(StatementVisitor* visitor) {
+runtime::Completion If::Accept(StatementVisitor* visitor) {
   return visitor->VisitIfStatement(this);
 }
 
-std::any Print::Accept(StatementVisitor* visitor) {
+runtime::Completion Print::Accept(StatementVisitor* visitor) {
   return visitor->VisitPrintStatement(this);
 }
 
-std::any Return::Accept(StatementVisitor* visitor) {
+runtime::Completion Return::Accept(StatementVisitor* visitor) {
   return visitor->VisitReturnStatement(this);
 }
 
-std::any VariableStatement::Accept(StatementVisitor* visitor) {
+runtime::Completion VariableStatement::Accept(StatementVisitor* visitor) {
   return visitor->VisitVariableStatement(this);
 }
 
-std::any While::Accept(StatementVisitor* visitor) {
+runtime::Completion While::Accept(StatementVisitor* visitor) {
   return visitor->VisitWhileStatement(this);
 }
 
@@ -1,11 +1,13 @@
 #ifndef SRC_LAMSCRIPT_PARSED_STATEMENT_H_
 #define SRC_LAMSCRIPT_PARSED_STATEMENT_H_
 
-#include <any>
 #include <memory>
+#include <utility>
 #include <vector>
 
 #include <Lamscript/parsed/Expression.h>
+#include <Lamscript/runtime/CompiledCode.h>
+#include <Lamscript/runtime/Completion.h>
 
 namespace lamscript {
 
@@ -22,10 +24,37 @@ struct FunctionMetadata{
   bool IsGetter;
 };
 
+/// @brief Describes where a closure captures one of its upvalues from when
+/// it's created. Upvalues are either a captured local of the enclosing
+/// function (stored in the slot at Index) or one of the enclosing functions
+/// own upvalues.
+struct UpvalueMetadata {
+  bool IsLocal;
+  size_t Index;
+};
+
 class Statement {
  public:
-  virtual std::any Accept(StatementVisitor* visitor) = 0;
-  // virtual ~Statement();
+  virtual runtime::Completion Accept(StatementVisitor* visitor) = 0;
+  virtual ~Statement() = default;
+};
+
+/// @brief Shared ownership of the statements of a parsed program. Functions
+/// created by a program hold onto it, so the declarations that they run stay
+/// alive for as long as the functions do.
+using SharedProgram =
+    std::shared_ptr<const std::vector<std::unique_ptr<Statement>>>;
+
+/// @brief Base class for statements that declare a variable. The resolver
+/// stores the slot that the variable is defined in, or leaves it marked as a
+/// global when it's declared outside of any local scope.
+class Declaration : public Statement {
+ public:
+  const VariableLocation& GetLocation() const { return location_; }
+  VariableLocation* GetMutableLocation() { return &location_; }
+
+ private:
+  VariableLocation location_;
 };
 
 /// @brief Curly brace block statements for defining a local scope.
@@ -34,11 +63,14 @@ class Block : public Statement {
   explicit Block(std::vector<std::unique_ptr<Statement>>&& statements)
       : statements_(std::move(statements)) {}
 
-  std::any Accept(StatementVisitor* visitor) override;
+  runtime::Completion Accept(StatementVisitor* visitor) override;
 
   const std::vector<std::unique_ptr<Statement>>& GetStatements() const {
     return statements_;
   }
+  std::vector<std::unique_ptr<Statement>>* GetMutableStatements() {
+    return &statements_;
+  }
 
  private:
   std::vector<std::unique_ptr<Statement>> statements_;
@@ -50,14 +82,15 @@ class ExpressionStatement : public Statement {
   explicit ExpressionStatement(std::unique_ptr<Expression> expression)
       : expression_(std::move(expression)) {}
 
-  std::any Accept(StatementVisitor* visitor) override;
+  runtime::Completion Accept(StatementVisitor* visitor) override;
 
   Expression* GetExpression() { return expression_.get(); }
+  std::unique_ptr<Expression>* GetMutableExpression() { return &expression_; }
  private:
   std::unique_ptr<Expression> expression_;
 };
 
-class Function : public Statement {
+class Function : public Declaration {
  public:
   Function(
       parsing::Token name,
@@ -67,28 +100,69 @@ class Function : public Statement {
           : name_(name),
           params_(params),
           body_(std::move(body)),
-          metadata_(metadata) {}
+          metadata_(metadata),
+          frame_size_(0) {}
 
-  std::any Accept(StatementVisitor* visitor) override;
+  runtime::Completion Accept(StatementVisitor* visitor) override;
 
   const parsing::Token& GetName() const { return name_; }
   const std::vector<parsing::Token>& GetParams() const { return params_; }
   const std::vector<std::unique_ptr<Statement>>& GetBody() const {
       return body_; }
+  std::vector<std::unique_ptr<Statement>>* GetMutableBody() { return &body_; }
 
   const bool IsStatic() const { return metadata_.IsStatic; }
   const bool IsMethod() const { return metadata_.IsMethod; }
   const bool IsGetter() const { return metadata_.IsGetter; }
 
+  /// @brief The number of slots needed on the value stack to store the
+  /// parameters and locals of a call to the function. Methods store the
+  /// instance they're bound to in the first slot, before their parameters.
+  size_t GetFrameSize() const { return frame_size_; }
+  void SetFrameSize(size_t size) { frame_size_ = size; }
+
+  /// @brief The variables captured by closures created from the function.
+  const std::vector<UpvalueMetadata>& GetUpvalues() const {
+    return upvalues_;
+  }
+
+  void SetUpvalues(std::vector<UpvalueMetadata>&& upvalues) {
+    upvalues_ = std::move(upvalues);
+  }
+
+  /// @brief The slots of parameters that are captured by closures, which need
+  /// to be moved into cells when the function is called.
+  const std::vector<size_t>& GetCapturedParameters() const {
+    return captured_parameters_;
+  }
+
+  void AddCapturedParameter(size_t slot) {
+    captured_parameters_.push_back(slot);
+  }
+
+  /// @brief The body of the function compiled by the closure compiler. Empty
+  /// if the function is only run by walking its statements.
+  const runtime::CompiledStatement& GetCompiledBody() const {
+    return compiled_body_;
+  }
+
+  void SetCompiledBody(runtime::CompiledStatement body) {
+    compiled_body_ = std::move(body);
+  }
+
  private:
   parsing::Token name_;
   std::vector<parsing::Token> params_;
   std::vector<std::unique_ptr<Statement>> body_;
   FunctionMetadata metadata_;
+  size_t frame_size_;
+  std::vector<UpvalueMetadata> upvalues_;
+  std::vector<size_t> captured_parameters_;
+  runtime::CompiledStatement compiled_body_;
 };
 
 /// @brief Class definition statements.
-class Class : public Statement {
+class Class : public Declaration {
  public:
   Class(
       parsing::Token name,
@@ -98,16 +172,27 @@ class Class : public Statement {
           super_class_(std::move(super_class)),
           methods_(methods) {}
 
-  std::any Accept(StatementVisitor* visitor) override;
+  runtime::Completion Accept(StatementVisitor* visitor) override;
   const parsing::Token& GetName() const { return name_; }
   const std::vector<std::shared_ptr<Function>>& GetMethods() {
     return methods_; }
   Expression* GetSuperClass() { return super_class_.get(); }
 
+  /// @brief Where the super class is stored for methods to access through
+  /// `super`.
+  const VariableLocation& GetSuperClassLocation() const {
+    return super_class_location_;
+  }
+
+  VariableLocation* GetMutableSuperClassLocation() {
+    return &super_class_location_;
+  }
+
  private:
   parsing::Token name_;
   std::unique_ptr<Variable> super_class_;
   std::vector<std::shared_ptr<Function>> methods_;
+  VariableLocation super_class_location_;
 };
 
 class If : public Statement {
@@ -120,11 +205,14 @@ class If : public Statement {
           then_branch_(std::move(then_branch)),
           else_branch_(std::move(else_branch)) {}
 
-  std::any Accept(StatementVisitor* visitor) override;
+  runtime::Completion Accept(StatementVisitor* visitor) override;
 
   Expression* GetCondition() { return condition_.get(); }
   Statement* GetThenBranch() { return then_branch_.get(); }
   Statement* GetElseBranch() { return else_branch_.get(); }
+  std::unique_ptr<Expression>* GetMutableCondition() { return &condition_; }
+  std::unique_ptr<Statement>* GetMutableThenBranch() { return &then_branch_; }
+  std::unique_ptr<Statement>* GetMutableElseBranch() { return &else_branch_; }
 
  private:
   std::unique_ptr<Expression> condition_;
@@ -138,9 +226,10 @@ class Print : public Statement {
   explicit Print(std::unique_ptr<Expression> expression)
     : expression_(std::move(expression)) {}
 
-  std::any Accept(StatementVisitor* visitor) override;
+  runtime::Completion Accept(StatementVisitor* visitor) override;
 
   Expression* GetExpression() { return expression_.get(); }
+  std::unique_ptr<Expression>* GetMutableExpression() { return &expression_; }
 
  private:
   std::unique_ptr<Expression> expression_;
@@ -151,9 +240,10 @@ class Return : public Statement {
   Return(parsing::Token keyword, std::unique_ptr<Expression> value)
     : keyword_(std::move(keyword)), value_(std::move(value)) {}
 
-  std::any Accept(StatementVisitor* visitor) override;
+  runtime::Completion Accept(StatementVisitor* visitor) override;
 
   Expression* GetValue() { return value_.get(); }
+  std::unique_ptr<Expression>* GetMutableValue() { return &value_; }
   const parsing::Token& GetKeyword() const { return keyword_; }
 
  private:
@@ -161,20 +251,32 @@ class Return : public Statement {
   std::unique_ptr<Expression> value_;
 };
 
-class VariableStatement : public Statement {
+class VariableStatement : public Declaration {
  public:
   VariableStatement(
       parsing::Token name, std::unique_ptr<Expression> initializer)
-          : name_(name), initializer_(std::move(initializer)) {}
+          : name_(name),
+          initializer_(std::move(initializer)),
+          is_reassigned_(false) {}
 
-  std::any Accept(StatementVisitor* visitor) override;
+  runtime::Completion Accept(StatementVisitor* visitor) override;
 
   const parsing::Token& GetName() const { return name_; }
   Expression* GetInitializer() const { return initializer_.get(); }
+  std::unique_ptr<Expression>* GetMutableInitializer() {
+    return &initializer_;
+  }
+
+  /// @brief Whether a local variable is ever assigned to after being
+  /// declared. Set by the resolver, and always false for globals since they
+  /// aren't resolved.
+  bool IsReassigned() const { return is_reassigned_; }
+  void MarkReassigned() { is_reassigned_ = true; }
 
  private:
   parsing::Token name_;
   std::unique_ptr<Expression> initializer_;
+  bool is_reassigned_;
 };
 
 class While : public Statement {
@@ -182,10 +284,12 @@ class While : public Statement {
   While(std::unique_ptr<Expression> condition, std::unique_ptr<Statement> body)
       : condition_(std::move(condition)), body_(std::move(body)) {}
 
-  std::any Accept(StatementVisitor* visitor) override;
+  runtime::Completion Accept(StatementVisitor* visitor) override;
 
   Expression* GetCondition() { return condition_.get(); }
   Statement* GetBody() { return body_.get(); }
+  std::unique_ptr<Expression>* GetMutableCondition() { return &condition_; }
+  std::unique_ptr<Statement>* GetMutableBody() { return &body_; }
 
  private:
   std::unique_ptr<Expression> condition_;
@@ -0,0 +1,117 @@
+#ifndef SRC_LAMSCRIPT_PARSED_TYPEFEEDBACK_H_
+#define SRC_LAMSCRIPT_PARSED_TYPEFEEDBACK_H_
+
+#include <cstdint>
+
+#include <Lamscript/parsing/TokenType.h>
+#include <Lamscript/runtime/Value.h>
+
+namespace lamscript {
+namespace parsed {
+
+/// @brief The operations that a binary expression specializes itself into
+/// based on the types of the operands it has seen.
+///
+/// Expressions start out Uninitialized and specialize themselves the first
+/// time they're evaluated. Specialized expressions guard that their operands
+/// still have the types they specialized for, and deoptimize to Generic for
+/// good the first time the guard fails so that expressions seeing mixed types
+/// don't keep respecializing.
+enum class BinarySpecialization : std::uint8_t {
+  Uninitialized,
+  NumberAdd,
+  NumberSubtract,
+  NumberMultiply,
+  NumberGreater,
+  NumberGreaterEqual,
+  NumberLess,
+  NumberLessEqual,
+  NumberEqual,
+  NumberNotEqual,
+  StringConcatenate,
+  Generic
+};
+
+/// @brief The operations that a unary expression specializes itself into
+/// based on the type of the operand it has seen.
+enum class UnarySpecialization : std::uint8_t {
+  Uninitialized,
+  NumberNegate,
+  BooleanNot,
+  Generic
+};
+
+/// @brief The operations that a logical expression specializes itself into
+/// based on the type of the left operand it has seen.
+enum class LogicalSpecialization : std::uint8_t {
+  Uninitialized,
+  BooleanAnd,
+  BooleanOr,
+  Generic
+};
+
+/// @brief Picks the specialization of a binary operator for the types of the
+/// operands that it was first evaluated with.
+inline BinarySpecialization SpecializeBinary(
+    parsing::TokenType operator_type,
+    const runtime::Value& left_side,
+    const runtime::Value& right_side) {
+  if (left_side.IsString() && right_side.IsString()) {
+    return operator_type == parsing::PLUS
+        ? BinarySpecialization::StringConcatenate
+        : BinarySpecialization::Generic;
+  }
+
+  if (!left_side.IsNumber() || !right_side.IsNumber()) {
+    return BinarySpecialization::Generic;
+  }
+
+  // Division and modulus aren't specialized since they're rare in hot loops
+  // and division still has to check for dividing by zero.
+  switch (operator_type) {
+    case parsing::PLUS: return BinarySpecialization::NumberAdd;
+    case parsing::MINUS: return BinarySpecialization::NumberSubtract;
+    case parsing::STAR: return BinarySpecialization::NumberMultiply;
+    case parsing::GREATER: return BinarySpecialization::NumberGreater;
+    case parsing::GREATER_EQUAL:
+      return BinarySpecialization::NumberGreaterEqual;
+    case parsing::LESS: return BinarySpecialization::NumberLess;
+    case parsing::LESS_EQUAL: return BinarySpecialization::NumberLessEqual;
+    case parsing::EQUAL_EQUAL: return BinarySpecialization::NumberEqual;
+    case parsing::BANG_EQUAL: return BinarySpecialization::NumberNotEqual;
+    default: return BinarySpecialization::Generic;
+  }
+}
+
+/// @brief Picks the specialization of a unary operator for the type of the
+/// operand that it was first evaluated with.
+inline UnarySpecialization SpecializeUnary(
+    parsing::TokenType operator_type, const runtime::Value& operand) {
+  if (operator_type == parsing::MINUS && operand.IsNumber()) {
+    return UnarySpecialization::NumberNegate;
+  }
+
+  if (operator_type == parsing::BANG && operand.IsBoolean()) {
+    return UnarySpecialization::BooleanNot;
+  }
+
+  return UnarySpecialization::Generic;
+}
+
+/// @brief Picks the specialization of a logical operator for the type of the
+/// left operand that it was first evaluated with.
+inline LogicalSpecialization SpecializeLogical(
+    parsing::TokenType operator_type, const runtime::Value& left_side) {
+  if (!left_side.IsBoolean()) {
+    return LogicalSpecialization::Generic;
+  }
+
+  return operator_type == parsing::OR
+      ? LogicalSpecialization::BooleanOr
+      : LogicalSpecialization::BooleanAnd;
+}
+
+}  // namespace parsed
+}  // namespace lamscript
+
+#endif  // SRC_LAMSCRIPT_PARSED_TYPEFEEDBACK_H_
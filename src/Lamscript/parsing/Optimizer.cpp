@@ -0,0 +1,351 @@
+#include <Lamscript/parsing/Optimizer.h>
+
+#include <math.h>
+
+#include <memory>
+#include <utility>
+#include <vector>
+
+#include <Lamscript/parsed/LamscriptString.h>
+#include <Lamscript/parsing/TokenType.h>
+#include <Lamscript/runtime/Interpreter.h>
+
+namespace lamscript {
+namespace parsing {
+
+namespace {
+
+/// @brief Computes the result of a binary operator applied to constant
+/// operands the same way the interpreter does. Returns false without setting
+/// result when the operation would fail at runtime.
+bool FoldBinary(
+    TokenType operator_type,
+    const runtime::Value& left_side,
+    const runtime::Value& right_side,
+    runtime::Value* result) {
+  if (operator_type == EQUAL_EQUAL) {
+    *result = runtime::Interpreter::IsEqual(left_side, right_side);
+    return true;
+  }
+
+  if (operator_type == BANG_EQUAL) {
+    *result = !runtime::Interpreter::IsEqual(left_side, right_side);
+    return true;
+  }
+
+  if (operator_type == PLUS && left_side.IsString() && right_side.IsString()) {
+    *result = parsed::LamscriptString::Concatenate(
+        left_side.AsObject<parsed::LamscriptString>(),
+        right_side.AsObject<parsed::LamscriptString>());
+    return true;
+  }
+
+  if (!left_side.IsNumber() || !right_side.IsNumber()) {
+    return false;
+  }
+
+  double left = left_side.AsNumber();
+  double right = right_side.AsNumber();
+
+  switch (operator_type) {
+    case PLUS: *result = left + right; return true;
+    case MINUS: *result = left - right; return true;
+    case STAR: *result = left * right; return true;
+    case SLASH:
+      if (right == 0) {
+        return false;
+      }
+
+      *result = left / right;
+      return true;
+    case MODULUS: *result = fmod(left, right); return true;
+    case GREATER: *result = left > right; return true;
+    case GREATER_EQUAL: *result = left >= right; return true;
+    case LESS: *result = left < right; return true;
+    case LESS_EQUAL: *result = left <= right; return true;
+    default: return false;
+  }
+}
+
+}  // namespace
+
+void Optimizer::Optimize(
+    std::vector<std::unique_ptr<parsed::Statement>>* statements) {
+  for (auto& statement : *statements) {
+    Optimize(&statement);
+  }
+}
+
+// ------------------------------- EXPRESSIONS ---------------------------------
+
+runtime::Value Optimizer::VisitAssignExpression(parsed::Assign* assignment) {
+  Optimize(assignment->GetMutableValue());
+  return nullptr;
+}
+
+runtime::Value Optimizer::VisitBinaryExpression(parsed::Binary* binary) {
+  Optimize(binary->GetMutableLeftSide());
+  Optimize(binary->GetMutableRightSide());
+
+  const runtime::Value* left_side = GetConstant(*binary->GetMutableLeftSide());
+  const runtime::Value* right_side = GetConstant(
+      *binary->GetMutableRightSide());
+
+  runtime::Value result;
+  if (left_side != nullptr
+      && right_side != nullptr
+      && FoldBinary(
+          binary->GetOperator().Type, *left_side, *right_side, &result)) {
+    ReplaceWithLiteral(result);
+  }
+
+  return nullptr;
+}
+
+/// Calls remember whether their callee is a property access when they're
+/// created. That still holds after optimizing the callee, since property
+/// accesses are never replaced.
+runtime::Value Optimizer::VisitCallExpression(parsed::Call* call) {
+  Optimize(call->GetMutableCallee());
+
+  for (auto& argument : *call->GetMutableArguments()) {
+    Optimize(&argument);
+  }
+
+  return nullptr;
+}
+
+runtime::Value Optimizer::VisitGetExpression(parsed::Get* getter) {
+  Optimize(getter->GetMutableObject());
+  return nullptr;
+}
+
+runtime::Value Optimizer::VisitGroupingExpression(parsed::Grouping* grouping) {
+  Optimize(grouping->GetMutableExpression());
+  replacement_ = std::move(*grouping->GetMutableExpression());
+  return nullptr;
+}
+
+runtime::Value Optimizer::VisitLiteralExpression(parsed::Literal*) {
+  return nullptr;
+}
+
+/// Logical expressions evaluate to one of their operands, so a constant left
+/// operand decides which operand the expression is replaced with.
+runtime::Value Optimizer::VisitLogicalExpression(parsed::Logical* logical) {
+  Optimize(logical->GetMutableLeftOperand());
+  Optimize(logical->GetMutableRightOperand());
+
+  const runtime::Value* left_side = GetConstant(
+      *logical->GetMutableLeftOperand());
+
+  if (left_side == nullptr) {
+    return nullptr;
+  }
+
+  bool left_is_truthy = runtime::Interpreter::IsTruthy(*left_side);
+  bool is_or = logical->GetLogicalOperator().Type == OR;
+
+  if (left_is_truthy == is_or) {
+    replacement_ = std::move(*logical->GetMutableLeftOperand());
+  } else {
+    replacement_ = std::move(*logical->GetMutableRightOperand());
+  }
+
+  return nullptr;
+}
+
+runtime::Value Optimizer::VisitSetExpression(parsed::Set* setter) {
+  Optimize(setter->GetMutableObject());
+  Optimize(setter->GetMutableValue());
+  return nullptr;
+}
+
+runtime::Value Optimizer::VisitSuperExpression(parsed::Super*) {
+  return nullptr;
+}
+
+runtime::Value Optimizer::VisitThisExpression(parsed::This*) {
+  return nullptr;
+}
+
+runtime::Value Optimizer::VisitUnaryExpression(parsed::Unary* unary) {
+  Optimize(unary->GetMutableRightExpression());
+
+  const runtime::Value* right_side = GetConstant(
+      *unary->GetMutableRightExpression());
+
+  if (right_side == nullptr) {
+    return nullptr;
+  }
+
+  switch (unary->GetUnaryOperator().Type) {
+    case BANG:
+      ReplaceWithLiteral(!runtime::Interpreter::IsTruthy(*right_side));
+      break;
+    case MINUS:
+      if (right_side->IsNumber()) {
+        ReplaceWithLiteral(-right_side->AsNumber());
+      }
+      break;
+    default:
+      break;
+  }
+
+  return nullptr;
+}
+
+/// Locals declared with a constant initializer that are never assigned to
+/// always hold that constant, so reading them is replaced with it. Globals
+/// aren't propagated since they can be redeclared, and can be read by a
+/// function before they're declared.
+runtime::Value Optimizer::VisitVariableExpression(parsed::Variable* variable) {
+  parsed::VariableStatement* declaration = variable->GetDeclaration();
+
+  if (declaration == nullptr || declaration->IsReassigned()) {
+    return nullptr;
+  }
+
+  const runtime::Value* value = GetConstant(
+      *declaration->GetMutableInitializer());
+
+  if (value != nullptr) {
+    ReplaceWithLiteral(*value);
+  }
+
+  return nullptr;
+}
+
+runtime::Value Optimizer::VisitLambdaExpression(
+    parsed::LambdaExpression* expression) {
+  expression->GetFunctionStatement()->Accept(this);
+  return nullptr;
+}
+
+// -------------------------------- STATEMENTS ---------------------------------
+
+runtime::Completion Optimizer::VisitBlockStatement(parsed::Block* block) {
+  Optimize(block->GetMutableStatements());
+  return runtime::Completion::Normal;
+}
+
+runtime::Completion Optimizer::VisitClassStatement(parsed::Class* class_def) {
+  for (auto& method : class_def->GetMethods()) {
+    method->Accept(this);
+  }
+
+  return runtime::Completion::Normal;
+}
+
+runtime::Completion Optimizer::VisitExpressionStatement(
+    parsed::ExpressionStatement* statement) {
+  Optimize(statement->GetMutableExpression());
+  return runtime::Completion::Normal;
+}
+
+runtime::Completion Optimizer::VisitFunctionStatement(parsed::Function* func) {
+  Optimize(func->GetMutableBody());
+  return runtime::Completion::Normal;
+}
+
+/// If statements without an else branch that are never taken are replaced
+/// with an empty block.
+runtime::Completion Optimizer::VisitIfStatement(parsed::If* if_statement) {
+  Optimize(if_statement->GetMutableCondition());
+  Optimize(if_statement->GetMutableThenBranch());
+  Optimize(if_statement->GetMutableElseBranch());
+
+  const runtime::Value* condition = GetConstant(
+      *if_statement->GetMutableCondition());
+
+  if (condition == nullptr) {
+    return runtime::Completion::Normal;
+  }
+
+  if (runtime::Interpreter::IsTruthy(*condition)) {
+    statement_replacement_ = std::move(*if_statement->GetMutableThenBranch());
+  } else if (if_statement->GetElseBranch() != nullptr) {
+    statement_replacement_ = std::move(*if_statement->GetMutableElseBranch());
+  } else {
+    statement_replacement_ = std::make_unique<parsed::Block>(
+        std::vector<std::unique_ptr<parsed::Statement>>());
+  }
+
+  return runtime::Completion::Normal;
+}
+
+runtime::Completion Optimizer::VisitPrintStatement(parsed::Print* print) {
+  Optimize(print->GetMutableExpression());
+  return runtime::Completion::Normal;
+}
+
+runtime::Completion Optimizer::VisitReturnStatement(
+    parsed::Return* return_statement) {
+  Optimize(return_statement->GetMutableValue());
+  return runtime::Completion::Normal;
+}
+
+runtime::Completion Optimizer::VisitVariableStatement(
+    parsed::VariableStatement* variable) {
+  Optimize(variable->GetMutableInitializer());
+  return runtime::Completion::Normal;
+}
+
+runtime::Completion Optimizer::VisitWhileStatement(
+    parsed::While* while_statement) {
+  Optimize(while_statement->GetMutableCondition());
+  Optimize(while_statement->GetMutableBody());
+  return runtime::Completion::Normal;
+}
+
+// ---------------------------------- PRIVATE ----------------------------------
+
+void Optimizer::Optimize(std::unique_ptr<parsed::Expression>* expression) {
+  if (*expression == nullptr) {
+    return;
+  }
+
+  (*expression)->Accept(this);
+
+  if (replacement_ != nullptr) {
+    *expression = std::move(replacement_);
+  }
+}
+
+void Optimizer::Optimize(std::unique_ptr<parsed::Statement>* statement) {
+  if (*statement == nullptr) {
+    return;
+  }
+
+  (*statement)->Accept(this);
+
+  if (statement_replacement_ != nullptr) {
+    *statement = std::move(statement_replacement_);
+  }
+}
+
+void Optimizer::Optimize(std::shared_ptr<parsed::Expression>* expression) {
+  (*expression)->Accept(this);
+
+  if (replacement_ != nullptr) {
+    *expression = std::move(replacement_);
+  }
+}
+
+void Optimizer::ReplaceWithLiteral(const runtime::Value& value) {
+  replacement_ = std::make_unique<parsed::Literal>(value);
+}
+
+const runtime::Value* Optimizer::GetConstant(
+    const std::unique_ptr<parsed::Expression>& expression) {
+  auto literal = dynamic_cast<const parsed::Literal*>(expression.get());
+
+  if (literal == nullptr) {
+    return nullptr;
+  }
+
+  return &literal->GetValue();
+}
+
+}  // namespace parsing
+}  // namespace lamscript
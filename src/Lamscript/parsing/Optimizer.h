@@ -0,0 +1,135 @@
+#ifndef SRC_LAMSCRIPT_PARSING_OPTIMIZER_H_
+#define SRC_LAMSCRIPT_PARSING_OPTIMIZER_H_
+
+#include <memory>
+#include <vector>
+
+#include <Lamscript/Visitor.h>
+#include <Lamscript/parsed/Expression.h>
+#include <Lamscript/parsed/Statement.h>
+#include <Lamscript/runtime/Value.h>
+
+namespace lamscript {
+namespace parsing {
+
+/// @brief Simplifies resolved programs before they're interpreted.
+///
+/// The optimizer folds expressions with constant operands into literals,
+/// propagates the constants that locals are declared with when they're never
+/// reassigned, short circuits logical expressions with constant left operands,
+/// and removes the branches of if statements with constant conditions that
+/// can never run.
+/// Expressions that would fail at runtime (e.g. dividing by zero) are left as
+/// they are so that the error is still reported when they're evaluated.
+///
+/// It runs after the resolver, since the variable locations that the resolver
+/// stores in nodes stay valid when nodes are moved around.
+class Optimizer : public ExpressionVisitor, StatementVisitor {
+ public:
+  Optimizer() : replacement_(), statement_replacement_() {}
+
+  /// @brief Optimizes every statement of a program in place.
+  void Optimize(std::vector<std::unique_ptr<parsed::Statement>>* statements);
+
+  /// @brief Optimizes the value being assigned.
+  runtime::Value VisitAssignExpression(parsed::Assign* assignment) override;
+
+  /// @brief Folds arithmetic and comparisons of constant operands.
+  runtime::Value VisitBinaryExpression(parsed::Binary* binary) override;
+
+  /// @brief Optimizes the callee and every argument.
+  runtime::Value VisitCallExpression(parsed::Call* call) override;
+
+  /// @brief Optimizes the object that the property is read from.
+  runtime::Value VisitGetExpression(parsed::Get* getter) override;
+
+  /// @brief Replaces the grouping with the expression inside of it.
+  runtime::Value VisitGroupingExpression(parsed::Grouping* grouping) override;
+
+  /// @brief no-op since literals are already constant.
+  runtime::Value VisitLiteralExpression(parsed::Literal* literal) override;
+
+  /// @brief Short circuits logical expressions with a constant left operand.
+  runtime::Value VisitLogicalExpression(parsed::Logical* logical) override;
+
+  /// @brief Optimizes both the object and the value being set.
+  runtime::Value VisitSetExpression(parsed::Set* setter) override;
+
+  /// @brief no-op since super can't be optimized.
+  runtime::Value VisitSuperExpression(parsed::Super* expression) override;
+
+  /// @brief no-op since this can't be optimized.
+  runtime::Value VisitThisExpression(parsed::This* expression) override;
+
+  /// @brief Folds unary operators applied to a constant.
+  runtime::Value VisitUnaryExpression(parsed::Unary* unary) override;
+
+  /// @brief Replaces locals that always hold the same constant with it.
+  runtime::Value VisitVariableExpression(parsed::Variable* variable) override;
+
+  /// @brief Optimizes the body of the lambda.
+  runtime::Value VisitLambdaExpression(
+      parsed::LambdaExpression* expression) override;
+
+  /// @brief Optimizes every statement within the block.
+  runtime::Completion VisitBlockStatement(parsed::Block* block) override;
+
+  /// @brief Optimizes the body of every method.
+  runtime::Completion VisitClassStatement(parsed::Class* class_def) override;
+
+  /// @brief Optimizes the expression of the statement.
+  runtime::Completion VisitExpressionStatement(
+      parsed::ExpressionStatement* statement) override;
+
+  /// @brief Optimizes every statement of the function body.
+  runtime::Completion VisitFunctionStatement(parsed::Function* func) override;
+
+  /// @brief Replaces the if statement with the branch that a constant
+  /// condition always takes.
+  runtime::Completion VisitIfStatement(parsed::If* if_statement) override;
+
+  /// @brief Optimizes the printed expression.
+  runtime::Completion VisitPrintStatement(parsed::Print* print) override;
+
+  /// @brief Optimizes the returned value if there is one.
+  runtime::Completion VisitReturnStatement(
+      parsed::Return* return_statement) override;
+
+  /// @brief Optimizes the initializer of the variable if there is one.
+  runtime::Completion VisitVariableStatement(
+      parsed::VariableStatement* variable) override;
+
+  /// @brief Optimizes the condition and body of the loop.
+  runtime::Completion VisitWhileStatement(
+      parsed::While* while_statement) override;
+
+ private:
+  /// @brief Set by an expression visitor to replace the expression it visited.
+  std::unique_ptr<parsed::Expression> replacement_;
+
+  /// @brief Set by a statement visitor to replace the statement it visited.
+  std::unique_ptr<parsed::Statement> statement_replacement_;
+
+  /// @brief Optimizes an expression, replacing it if it can be simplified.
+  void Optimize(std::unique_ptr<parsed::Expression>* expression);
+
+  /// @brief Optimizes a statement, replacing it if it can be simplified.
+  void Optimize(std::unique_ptr<parsed::Statement>* statement);
+
+  /// @brief Optimizes an expression held by a shared pointer, replacing it if
+  /// it can be simplified.
+  void Optimize(std::shared_ptr<parsed::Expression>* expression);
+
+  /// @brief Replaces the expression being visited with a literal.
+  void ReplaceWithLiteral(const runtime::Value& value);
+
+  /// @brief Gets the value of an expression if it's a literal, or a nullptr
+  /// otherwise.
+  static const runtime::Value* GetConstant(
+      const std::unique_ptr<parsed::Expression>& expression);
+};
+
+}  // namespace parsing
+}  // namespace lamscript
+
+#endif  // SRC_LAMSCRIPT_PARSING_OPTIMIZER_H_
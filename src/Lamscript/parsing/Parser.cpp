@@ -1,5 +1,6 @@
 #include <Lamscript/parsing/Parser.h>
 
+#include <algorithm>
 #include <initializer_list>
 #include <memory>
 #include <random>
@@ -56,6 +57,17 @@ std::vector<UniqueStatement> Parser::Parse() {
 
 // ---------------------------------- PRIVATE ----------------------------------
 
+runtime::Value Parser::InternString(const std::string& literal) {
+  auto lookup = string_literals_.find(literal);
+  if (lookup != string_literals_.end()) {
+    return lookup->second;
+  }
+
+  runtime::Value value(literal);
+  string_literals_.emplace(literal, value);
+  return value;
+}
+
 Token Parser::Peek() {
   return tokens_.at(current_token_);
 }
@@ -509,7 +521,7 @@ UniqueExpression Parser::ParsePrimary() {
     }
 
     expression.reset(new parsed::Literal(
-          std::any_cast<std::string&>(token.Literal)));
+          InternString(std::any_cast<std::string&>(token.Literal))));
     return expression;
   }
 
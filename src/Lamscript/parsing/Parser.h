@@ -3,7 +3,9 @@
 
 #include <initializer_list>
 #include <memory>
+#include <string>
 #include <typeinfo>
+#include <unordered_map>
 #include <vector>
 
 #include <Lamscript/errors/ParseError.h>
@@ -11,6 +13,7 @@
 #include <Lamscript/parsed/Statement.h>
 #include <Lamscript/parsing/Token.h>
 #include <Lamscript/parsing/TokenType.h>
+#include <Lamscript/runtime/Value.h>
 
 namespace lamscript {
 namespace parsing {
@@ -29,6 +32,11 @@ class Parser {
  private:
   std::vector<Token> tokens_;
   int current_token_;
+  std::unordered_map<std::string, runtime::Value> string_literals_;
+
+  /// @brief Gets the string object for a string literal. Every literal with
+  /// the same contents shares one string object.
+  runtime::Value InternString(const std::string& literal);
 
   /// @brief Peek at the next token that we're going to parse.
   Token Peek();
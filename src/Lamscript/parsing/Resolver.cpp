@@ -1,6 +1,6 @@
 #include <Lamscript/parsing/Resolver.h>
 
-#include <any>
+#include <algorithm>
 #include <memory>
 #include <string>
 #include <unordered_map>
@@ -13,12 +13,6 @@
 namespace lamscript {
 namespace parsing {
 
-namespace {
-
-typedef std::unordered_map<std::string, VariableMetadata> Scope;
-
-}  // namespace
-
 // ---------------------------------- PUBLIC -----------------------------------
 
 void Resolver::Resolve(
@@ -30,40 +24,51 @@ void Resolver::Resolve(
 
 // ------------------------------- EXPRESSIONS ---------------------------------
 
-std::any Resolver::VisitVariableExpression(parsed::Variable* variable) {
+runtime::Value Resolver::VisitVariableExpression(parsed::Variable* variable) {
   if (!scope_stack_.empty()) {
     Scope& scope = scope_stack_.back();
-    const std::string& variable_name = variable->GetName().Lexeme;
-    auto lookup = scope.find(variable_name);
+    auto lookup = scope.Variables.find(variable->GetName().Lexeme);
 
-    if (lookup != scope.end()) {
+    if (lookup != scope.Variables.end()) {
       if (lookup->second.Defined == false) {
           runtime::Lamscript::Error(
               variable->GetName(),
               "Can't read local variable in it's own initializer.");
       }
-      scope[variable_name].Used = true;
+      lookup->second.Used = true;
     }
   }
 
-  ResolveLocalVariable(variable, variable->GetName());
+  VariableMetadata* metadata = ResolveLocalVariable(
+      variable->GetMutableLocation(), variable->GetName());
+
+  if (metadata != nullptr) {
+    variable->SetDeclaration(metadata->Declaration);
+  }
+
   return nullptr;
 }
 
-std::any Resolver::VisitAssignExpression(parsed::Assign* assignment) {
+runtime::Value Resolver::VisitAssignExpression(parsed::Assign* assignment) {
   Resolve(assignment->GetValue());
-  ResolveLocalVariable(assignment, assignment->GetName());
+  VariableMetadata* metadata = ResolveLocalVariable(
+      assignment->GetMutableLocation(), assignment->GetName());
+
+  if (metadata != nullptr && metadata->Declaration != nullptr) {
+    metadata->Declaration->MarkReassigned();
+  }
+
   return nullptr;
 }
 
-std::any Resolver::VisitBinaryExpression(parsed::Binary* binary) {
+runtime::Value Resolver::VisitBinaryExpression(parsed::Binary* binary) {
   Resolve(binary->GetLeftSide());
   Resolve(binary->GetRightSide());
   return nullptr;
 }
 
 
-std::any Resolver::VisitCallExpression(parsed::Call* call) {
+runtime::Value Resolver::VisitCallExpression(parsed::Call* call) {
   Resolve(call->GetCallee());
 
   for (auto&& argument : call->GetArguments()) {
@@ -73,39 +78,39 @@ std::any Resolver::VisitCallExpression(parsed::Call* call) {
   return nullptr;
 }
 
-std::any Resolver::VisitGroupingExpression(parsed::Grouping* grouping) {
+runtime::Value Resolver::VisitGroupingExpression(parsed::Grouping* grouping) {
   Resolve(grouping->GetExpression());
   return nullptr;
 }
 
-std::any Resolver::VisitLiteralExpression(parsed::Literal* literal) {
+runtime::Value Resolver::VisitLiteralExpression(parsed::Literal* literal) {
   return nullptr;
 }
 
-std::any Resolver::VisitLogicalExpression(parsed::Logical* logical) {
+runtime::Value Resolver::VisitLogicalExpression(parsed::Logical* logical) {
   Resolve(logical->GetLeftOperand());
   Resolve(logical->GetRightOperand());
   return nullptr;
 }
 
-std::any Resolver::VisitUnaryExpression(parsed::Unary* unary) {
+runtime::Value Resolver::VisitUnaryExpression(parsed::Unary* unary) {
   Resolve(unary->GetRightExpression());
   return nullptr;
 }
 
 
-std::any Resolver::VisitGetExpression(parsed::Get* getter) {
+runtime::Value Resolver::VisitGetExpression(parsed::Get* getter) {
   Resolve(getter->GetObject().get());
   return nullptr;
 }
 
-std::any Resolver::VisitSetExpression(parsed::Set* setter) {
+runtime::Value Resolver::VisitSetExpression(parsed::Set* setter) {
   Resolve(setter->GetValue());
   Resolve(setter->GetObject().get());
   return nullptr;
 }
 
-std::any Resolver::VisitSuperExpression(parsed::Super* super) {
+runtime::Value Resolver::VisitSuperExpression(parsed::Super* super) {
   if (current_class_ == ClassType::None) {
     runtime::Lamscript::Error(
         super->GetKeyword(), "Can't use 'super' outside of a class.");
@@ -117,16 +122,22 @@ std::any Resolver::VisitSuperExpression(parsed::Super* super) {
         "Can't use 'super' in a class with no super class.");
   }
 
-  ResolveLocalVariable(super, super->GetKeyword());
+  ResolveLocalVariable(super->GetMutableLocation(), super->GetKeyword());
+  ResolveLocalVariable(
+      super->GetThis()->GetMutableLocation(), super->GetThis()->GetKeyword());
   return nullptr;
 }
 
-std::any Resolver::VisitLambdaExpression(parsed::LambdaExpression* lambda) {
-  Resolve(lambda->GetFunctionStatement());
+/// Lambdas aren't bound to a name, so only their function body is resolved.
+runtime::Value Resolver::VisitLambdaExpression(
+    parsed::LambdaExpression* lambda) {
+  ResolveFunction(
+      static_cast<parsed::Function*>(lambda->GetFunctionStatement()),
+      FunctionType::Function);
   return nullptr;
 }
 
-std::any Resolver::VisitThisExpression(parsed::This* this_expr) {
+runtime::Value Resolver::VisitThisExpression(parsed::This* this_expr) {
   if (current_class_ == ClassType::None) {
     runtime::Lamscript::Error(
         this_expr->GetKeyword(), "Cannot use this outside of a class.");
@@ -138,48 +149,55 @@ std::any Resolver::VisitThisExpression(parsed::This* this_expr) {
         "Cannot use this inside of a static function ");
   }
 
-  ResolveLocalVariable(this_expr, this_expr->GetKeyword());
+  ResolveLocalVariable(
+      this_expr->GetMutableLocation(), this_expr->GetKeyword());
   return nullptr;
 }
 
 // -------------------------------- STATEMENTS ---------------------------------
 
-std::any Resolver::VisitBlockStatement(parsed::Block* block) {
+runtime::Completion Resolver::VisitBlockStatement(parsed::Block* block) {
   BeginScope();
   Resolve(block->GetStatements());
   EndScope();
 
-  return nullptr;
+  return runtime::Completion::Normal;
 }
 
-std::any Resolver::VisitVariableStatement(parsed::VariableStatement* variable) {
-  Declare(variable->GetName());
+runtime::Completion Resolver::VisitVariableStatement(
+    parsed::VariableStatement* variable) {
+  VariableMetadata* metadata = Declare(
+      variable->GetName(), variable->GetMutableLocation());
+
+  if (metadata != nullptr) {
+    metadata->Declaration = variable;
+  }
 
   if (variable->GetInitializer() != nullptr) {
     Resolve(variable->GetInitializer());
   }
 
   Define(variable->GetName());
-  return nullptr;
+  return runtime::Completion::Normal;
 }
 
-std::any Resolver::VisitFunctionStatement(parsed::Function* func) {
-  Declare(func->GetName());
+runtime::Completion Resolver::VisitFunctionStatement(parsed::Function* func) {
+  Declare(func->GetName(), func->GetMutableLocation());
   Define(func->GetName());
 
   ResolveFunction(func, FunctionType::Function);
-  return nullptr;
+  return runtime::Completion::Normal;
 }
 
-std::any Resolver::VisitExpressionStatement(
+runtime::Completion Resolver::VisitExpressionStatement(
     parsed::ExpressionStatement* expression) {
   Resolve(expression->GetExpression());
-  return nullptr;
+  return runtime::Completion::Normal;
 }
 
 /// This will resolve all parts of the if statement, regardless of what gets
 /// executed or not
-std::any Resolver::VisitIfStatement(parsed::If* if_statement) {
+runtime::Completion Resolver::VisitIfStatement(parsed::If* if_statement) {
   Resolve(if_statement->GetCondition());
   Resolve(if_statement->GetThenBranch());
 
@@ -187,15 +205,16 @@ std::any Resolver::VisitIfStatement(parsed::If* if_statement) {
     Resolve(if_statement->GetElseBranch());
   }
 
-  return nullptr;
+  return runtime::Completion::Normal;
 }
 
-std::any Resolver::VisitPrintStatement(parsed::Print* print) {
+runtime::Completion Resolver::VisitPrintStatement(parsed::Print* print) {
   Resolve(print->GetExpression());
-  return nullptr;
+  return runtime::Completion::Normal;
 }
 
-std::any Resolver::VisitReturnStatement(parsed::Return* return_statement) {
+runtime::Completion Resolver::VisitReturnStatement(
+    parsed::Return* return_statement) {
   if (current_function_ == FunctionType::None) {
     runtime::Lamscript::Error(
         return_statement->GetKeyword(), "Can't return from top-level code.");
@@ -210,21 +229,22 @@ std::any Resolver::VisitReturnStatement(parsed::Return* return_statement) {
     Resolve(return_statement->GetValue());
   }
 
-  return nullptr;
+  return runtime::Completion::Normal;
 }
 
-std::any Resolver::VisitWhileStatement(parsed::While* while_statement) {
+runtime::Completion Resolver::VisitWhileStatement(
+    parsed::While* while_statement) {
   Resolve(while_statement->GetCondition());
   Resolve(while_statement->GetBody());
-  return nullptr;
+  return runtime::Completion::Normal;
 }
 
 
-std::any Resolver::VisitClassStatement(parsed::Class* class_def) {
+runtime::Completion Resolver::VisitClassStatement(parsed::Class* class_def) {
   ClassType enclosing_class = current_class_;
   current_class_ = ClassType::Class;
 
-  Declare(class_def->GetName());
+  Declare(class_def->GetName(), class_def->GetMutableLocation());
   Define(class_def->GetName());
 
   // Validate super class first.
@@ -241,14 +261,12 @@ std::any Resolver::VisitClassStatement(parsed::Class* class_def) {
     Resolve(class_def->GetSuperClass());
 
     BeginScope();
-    Scope& scope = scope_stack_.back();
-    scope["super"] = VariableMetadata{true, true, class_def->GetName().Line};
+    DeclareImplicit(
+        "super",
+        class_def->GetName().Line,
+        class_def->GetMutableSuperClassLocation());
   }
 
-  BeginScope();
-  Scope& scope = scope_stack_.back();
-  scope["this"] = VariableMetadata{true, true, class_def->GetName().Line};
-
   for (auto& method : class_def->GetMethods()) {
     FunctionType method_type = FunctionType::Method;
 
@@ -269,25 +287,32 @@ std::any Resolver::VisitClassStatement(parsed::Class* class_def) {
     ResolveFunction(method.get(), method_type);
   }
 
-  EndScope();
-
   if (class_def->GetSuperClass() != nullptr) {
     EndScope();
   }
 
   current_class_ = enclosing_class;
-  return nullptr;
+  return runtime::Completion::Normal;
 }
 
 // --------------------------------- PRIVATE -----------------------------------
 
+/// Scopes continue from the next free slot of the enclosing scope when both
+/// belong to the same function, which lets sibling scopes reuse slots.
 void Resolver::BeginScope() {
-  scope_stack_.push_back(Scope());
+  size_t function = function_stack_.size() - 1;
+  size_t first_slot = 0;
+
+  if (!scope_stack_.empty() && scope_stack_.back().Function == function) {
+    first_slot = scope_stack_.back().NextSlot;
+  }
+
+  scope_stack_.push_back(Scope{{}, function, first_slot});
 }
 
 /// Ensures that variables have to be used inside of their local scopes.
 void Resolver::EndScope() {
-  for (auto it : scope_stack_.back()) {
+  for (auto& it : scope_stack_.back().Variables) {
     if (it.second.Used == false) {
       runtime::Lamscript::Error(
           parsing::Token{IDENTIFIER, it.first, nullptr, it.second.Line},
@@ -306,19 +331,44 @@ void Resolver::Resolve(parsed::Expression* expression) {
   expression->Accept(this);
 }
 
-void Resolver::Declare(Token name) {
+/// Variables declared outside of any scope are globals, which the resolver
+/// doesn't keep track of.
+VariableMetadata* Resolver::Declare(
+    Token name, parsed::VariableLocation* location) {
   if (scope_stack_.empty()) {
-    return;
+    return nullptr;
   }
 
   Scope& scope = scope_stack_.back();
 
-  if (scope.contains(name.Lexeme)) {
+  if (scope.Variables.contains(name.Lexeme)) {
     runtime::Lamscript::Error(
         name, "There is already a variable that exists within this scope.");
   }
 
-  scope[name.Lexeme] = VariableMetadata{false, false, name.Line};
+  size_t slot = scope.NextSlot++;
+  FunctionScope& function = function_stack_[scope.Function];
+  function.FrameSize = std::max(function.FrameSize, scope.NextSlot);
+
+  VariableMetadata& metadata = scope.Variables[name.Lexeme];
+  metadata = VariableMetadata{
+      false, false, name.Line, slot, false, false, {}, nullptr};
+
+  if (location != nullptr) {
+    *location = parsed::VariableLocation{parsed::VariableStorage::Stack, slot};
+    metadata.Locations.push_back(location);
+  }
+
+  return &metadata;
+}
+
+VariableMetadata* Resolver::DeclareImplicit(
+    const std::string& name, int line, parsed::VariableLocation* location) {
+  VariableMetadata* metadata = Declare(
+      Token{IDENTIFIER, name, nullptr, line}, location);
+  metadata->Defined = true;
+  metadata->Used = true;
+  return metadata;
 }
 
 void Resolver::Define(Token name) {
@@ -327,34 +377,113 @@ void Resolver::Define(Token name) {
   }
 
   Scope& scope = scope_stack_.back();
-  scope[name.Lexeme].Defined = true;
+  scope.Variables[name.Lexeme].Defined = true;
 }
 
-void Resolver::ResolveLocalVariable(
-    parsed::Expression* expression, const Token& variable_name) {
+/// Locals of the function being resolved are accessed directly from its
+/// frame. Locals of enclosing functions are captured, and every function in
+/// between gets an upvalue that forwards the captured cell to the next.
+VariableMetadata* Resolver::ResolveLocalVariable(
+    parsed::VariableLocation* location, const Token& variable_name) {
+  size_t current_function = function_stack_.size() - 1;
+
   for (int pos = scope_stack_.size() - 1; pos >= 0; pos--) {
-    if (scope_stack_[pos].contains(variable_name.Lexeme)) {
-      interpreter_->Resolve(expression, scope_stack_.size() - 1 - pos);
-      scope_stack_[pos][variable_name.Lexeme].Used = true;
-      return;
+    Scope& scope = scope_stack_[pos];
+    auto lookup = scope.Variables.find(variable_name.Lexeme);
+
+    if (lookup == scope.Variables.end()) {
+      continue;
+    }
+
+    VariableMetadata& variable = lookup->second;
+    variable.Used = true;
+
+    if (scope.Function == current_function) {
+      *location = parsed::VariableLocation{
+          variable.Captured
+              ? parsed::VariableStorage::Cell
+              : parsed::VariableStorage::Stack,
+          variable.Slot};
+      variable.Locations.push_back(location);
+      return &variable;
+    }
+
+    Capture(variable, scope.Function);
+
+    size_t index = AddUpvalue(scope.Function + 1, true, variable.Slot);
+    for (size_t function = scope.Function + 2;
+        function <= current_function;
+        function++) {
+      index = AddUpvalue(function, false, index);
+    }
+
+    *location = parsed::VariableLocation{
+        parsed::VariableStorage::Upvalue, index};
+    return &variable;
+  }
+
+  *location = parsed::VariableLocation();
+  return nullptr;
+}
+
+void Resolver::Capture(VariableMetadata& variable, size_t function_index) {
+  if (variable.Captured) {
+    return;
+  }
+
+  variable.Captured = true;
+
+  for (parsed::VariableLocation* location : variable.Locations) {
+    location->Storage = parsed::VariableStorage::Cell;
+  }
+
+  if (variable.IsParameter) {
+    function_stack_[function_index].Function->AddCapturedParameter(
+        variable.Slot);
+  }
+}
+
+size_t Resolver::AddUpvalue(
+    size_t function_index, bool is_local, size_t index) {
+  std::vector<parsed::UpvalueMetadata>& upvalues =
+      function_stack_[function_index].Upvalues;
+
+  for (size_t i = 0; i < upvalues.size(); i++) {
+    if (upvalues[i].IsLocal == is_local && upvalues[i].Index == index) {
+      return i;
     }
   }
+
+  upvalues.push_back(parsed::UpvalueMetadata{is_local, index});
+  return upvalues.size() - 1;
 }
 
 void Resolver::ResolveFunction(parsed::Function* func, FunctionType type) {
   FunctionType enclosing_function = current_function_;
   current_function_ = type;
 
+  function_stack_.push_back(FunctionScope{func, 0, {}});
   BeginScope();
 
+  // Methods store the instance they're bound to in the first slot of their
+  // frame, followed by their parameters.
+  if (type != FunctionType::Function) {
+    DeclareImplicit("this", func->GetName().Line, nullptr)->IsParameter = true;
+  }
+
   for (const Token& param : func->GetParams()) {
-    Declare(param);
+    Declare(param, nullptr)->IsParameter = true;
     Define(param);
   }
 
   Resolve(func->GetBody());
   EndScope();
 
+  FunctionScope& function = function_stack_.back();
+  func->SetFrameSize(function.FrameSize);
+  func->SetUpvalues(std::move(function.Upvalues));
+  function_stack_.pop_back();
+
   current_function_ = enclosing_function;
 }
 
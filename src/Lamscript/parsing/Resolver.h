@@ -1,7 +1,6 @@
 #ifndef SRC_LAMSCRIPT_PARSING_RESOLVER_H_
 #define SRC_LAMSCRIPT_PARSING_RESOLVER_H_
 
-#include <any>
 #include <memory>
 #include <stack>
 #include <string>
@@ -12,7 +11,7 @@
 #include <Lamscript/parsed/Expression.h>
 #include <Lamscript/parsed/Statement.h>
 #include <Lamscript/parsing/Token.h>
-#include <Lamscript/runtime/Interpreter.h>
+#include <Lamscript/runtime/Value.h>
 
 namespace lamscript {
 namespace parsing {
@@ -36,81 +35,117 @@ struct VariableMetadata{
   bool Defined;
   bool Used;
   int Line;
+  size_t Slot;
+
+  /// @brief Set once a closure captures the variable.
+  bool Captured;
+
+  /// @brief Whether the variable is a parameter (or the bound instance) of
+  /// the function that declared it.
+  bool IsParameter;
+
+  /// @brief Every location that refers to the variable from within the
+  /// function that declared it, so that they can be updated to use a cell
+  /// once the variable is captured.
+  std::vector<parsed::VariableLocation*> Locations;
+  /// @brief The var statement that declared the variable, or a nullptr for
+  /// parameters, functions, classes and implicit variables.
+  parsed::VariableStatement* Declaration;
+};
+
+/// @brief A local scope and the variables declared within it. Scopes store
+/// their variables in the call frame of the function they belong to, starting
+/// at the slot that was free when the scope began.
+struct Scope {
+  std::unordered_map<std::string, VariableMetadata> Variables;
+  size_t Function;
+  size_t NextSlot;
+};
+
+/// @brief Keeps track of the call frame and captured variables of a function
+/// being resolved. Top level code that isn't within any function uses a frame
+/// for the variables declared within its blocks as well.
+struct FunctionScope {
+  parsed::Function* Function;
+  size_t FrameSize;
+  std::vector<parsed::UpvalueMetadata> Upvalues;
 };
 
 /// @brief Resolves variables and expressions prior to interpreting them.
 class Resolver : public ExpressionVisitor, StatementVisitor {
  public:
-  explicit Resolver(std::shared_ptr<runtime::Interpreter> interpreter)
-      : interpreter_(interpreter),
-      scope_stack_(),
+  Resolver()
+      : scope_stack_(),
+      function_stack_({FunctionScope{nullptr, 0, {}}}),
       current_function_(FunctionType::None),
       current_class_(ClassType::None) {}
 
-  std::any VisitVariableExpression(parsed::Variable* variable) override;
+  runtime::Value VisitVariableExpression(parsed::Variable* variable) override;
 
   /// @brief Resolves the expression for the assigned value and then resolves
   /// the variable that's being assigned to.
-  std::any VisitAssignExpression(parsed::Assign* assignment) override;
+  runtime::Value VisitAssignExpression(parsed::Assign* assignment) override;
 
   /// @brief Resolves both of the expressions.
-  std::any VisitBinaryExpression(parsed::Binary* binary) override;
+  runtime::Value VisitBinaryExpression(parsed::Binary* binary) override;
 
   /// @brief Resolves the callee and all of the arguments passed into it.
-  std::any VisitCallExpression(parsed::Call* call) override;
+  runtime::Value VisitCallExpression(parsed::Call* call) override;
 
   /// @brief Resolves the expression contained within the grouping.
-  std::any VisitGroupingExpression(parsed::Grouping* grouping) override;
+  runtime::Value VisitGroupingExpression(parsed::Grouping* grouping) override;
 
   /// @brief no-op considering that literals don't resolve into variables.
-  std::any VisitLiteralExpression(parsed::Literal* literal) override;
+  runtime::Value VisitLiteralExpression(parsed::Literal* literal) override;
 
   /// @brief Visits both the left and the right operands.
-  std::any VisitLogicalExpression(parsed::Logical* logical) override;
+  runtime::Value VisitLogicalExpression(parsed::Logical* logical) override;
 
   /// @brief Visit the right side of the unary expression.
-  std::any VisitUnaryExpression(parsed::Unary* unary) override;
+  runtime::Value VisitUnaryExpression(parsed::Unary* unary) override;
 
   /// @brief Resolves Getting data from an instance.
-  std::any VisitGetExpression(parsed::Get* getter) override;
+  runtime::Value VisitGetExpression(parsed::Get* getter) override;
 
   /// @brief Resolves both the object and value being set to the class field.
-  std::any VisitSetExpression(parsed::Set* setter) override;
+  runtime::Value VisitSetExpression(parsed::Set* setter) override;
 
   /// @brief Resolves the `this` keyword as a local variable.
-  std::any VisitThisExpression(parsed::This* expression) override;
+  runtime::Value VisitThisExpression(parsed::This* expression) override;
 
   /// @brief Resolves all variables declared within block statements.
-  std::any VisitBlockStatement(parsed::Block* block) override;
+  runtime::Completion VisitBlockStatement(parsed::Block* block) override;
 
   /// @brief Declares, initializes (if possible), and defines the variable in
   /// the current scope.
-  std::any VisitVariableStatement(parsed::VariableStatement* variable)
-      override;
+  runtime::Completion VisitVariableStatement(
+      parsed::VariableStatement* variable) override;
 
   /// @brief Resolves the function eagerly, allowing it to recursively call
   /// itself.
-  std::any VisitFunctionStatement(parsed::Function* func) override;
+  runtime::Completion VisitFunctionStatement(parsed::Function* func) override;
 
   /// @brief Resolves the expression associated with the expression statement.
-  std::any VisitExpressionStatement(parsed::ExpressionStatement* expression)
-      override;
+  runtime::Completion VisitExpressionStatement(
+      parsed::ExpressionStatement* expression) override;
 
   /// @brief Resolves the condition, then branch, and then else branch if
   /// applicable.
-  std::any VisitIfStatement(parsed::If* if_statement) override;
+  runtime::Completion VisitIfStatement(parsed::If* if_statement) override;
 
   /// @brief Resolves the expression being used inside of the print statement.
-  std::any VisitPrintStatement(parsed::Print* print) override;
+  runtime::Completion VisitPrintStatement(parsed::Print* print) override;
 
   /// @brief Resolves the expression returned by the return statement if it
   /// isn't null (explicitly or implicitly void/nil).
-  std::any VisitReturnStatement(parsed::Return* return_statement) override;
+  runtime::Completion VisitReturnStatement(
+      parsed::Return* return_statement) override;
 
   /// @brief Resolves both the condition and the body.
-  std::any VisitWhileStatement(parsed::While* while_statement) override;
+  runtime::Completion VisitWhileStatement(
+      parsed::While* while_statement) override;
 
-  std::any VisitClassStatement(parsed::Class* statement) override;
+  runtime::Completion VisitClassStatement(parsed::Class* statement) override;
 
   /// @brief Forwards references to each statement into the visitor interface
   /// to ensure that variables are being binded and resolved properly.
@@ -118,14 +153,19 @@ class Resolver : public ExpressionVisitor, StatementVisitor {
       const std::vector<std::unique_ptr<parsed::Statement>> &statements);
 
   /// @brief Resolves super to the parent class.
-  std::any VisitSuperExpression(parsed::Super* expression) override;
+  runtime::Value VisitSuperExpression(parsed::Super* expression) override;
 
   /// brief Resolves the functions stored by lambda functions.
-  std::any VisitLambdaExpression(parsed::LambdaExpression* expression) override;
+  runtime::Value VisitLambdaExpression(
+      parsed::LambdaExpression* expression) override;
+
+  /// @brief The number of slots needed to store the variables declared in
+  /// blocks of the top level code.
+  size_t GetFrameSize() const { return function_stack_.front().FrameSize; }
 
  private:
-  std::shared_ptr<runtime::Interpreter> interpreter_;
-  std::vector<std::unordered_map<std::string, VariableMetadata>> scope_stack_;
+  std::vector<Scope> scope_stack_;
+  std::vector<FunctionScope> function_stack_;
   FunctionType current_function_;
   ClassType current_class_;
 
@@ -141,16 +181,32 @@ class Resolver : public ExpressionVisitor, StatementVisitor {
   /// @brief Resolves the current expression utilizing the visitor interface.
   void Resolve(parsed::Expression* expression);
 
-  /// @brief Declares a variable and marks it as unitialized.
-  void Declare(Token name);
+  /// @brief Declares a variable and marks it as unitialized. The location
+  /// that the variable will be defined at is stored in location if given.
+  VariableMetadata* Declare(Token name, parsed::VariableLocation* location);
+
+  /// @brief Declares a variable that the interpreter defines on its own (i.e.
+  /// `this` and `super`) as both defined and used.
+  VariableMetadata* DeclareImplicit(
+      const std::string& name, int line, parsed::VariableLocation* location);
 
   /// @brief Define a variables a variable and marks it initialized.
   void Define(Token name);
 
   /// @brief Resolves local variables in the scope that they're being defined
-  /// in.
-  void ResolveLocalVariable(
-      parsed::Expression* expression, const Token& variable_name);
+  /// in and stores where they live in location. Variables that aren't found
+  /// in any scope are left marked as globals and return a nullptr.
+  VariableMetadata* ResolveLocalVariable(
+      parsed::VariableLocation* location, const Token& variable_name);
+
+  /// @brief Marks a local variable of the function at function_index as
+  /// captured, moving it into a cell.
+  void Capture(VariableMetadata& variable, size_t function_index);
+
+  /// @brief Finds or adds the upvalue that the function at function_index
+  /// uses to capture a variable stored in slot of the enclosing function (when
+  /// is_local is true) or in one of the enclosing functions upvalues.
+  size_t AddUpvalue(size_t function_index, bool is_local, size_t index);
 
   /// @brief Creates the function scope and binds the function parameters and
   /// body to the proper variables.
@@ -0,0 +1,45 @@
+#include <Lamscript/parsing/Symbol.h>
+
+#include <deque>
+#include <string>
+#include <unordered_map>
+
+namespace lamscript {
+namespace parsing {
+
+namespace {
+
+/// @brief Maps interned names to their ids and back. Names are stored in a
+/// deque so that references to them stay valid as the table grows.
+struct SymbolTable {
+  std::unordered_map<std::string, uint32_t> ids;
+  std::deque<std::string> names;
+};
+
+SymbolTable& GetSymbolTable() {
+  static SymbolTable* table = new SymbolTable();
+  return *table;
+}
+
+}  // namespace
+
+Symbol Symbol::Intern(const std::string& name) {
+  SymbolTable& table = GetSymbolTable();
+  auto lookup = table.ids.find(name);
+
+  if (lookup != table.ids.end()) {
+    return Symbol(lookup->second);
+  }
+
+  uint32_t id = static_cast<uint32_t>(table.names.size());
+  table.names.push_back(name);
+  table.ids.emplace(name, id);
+  return Symbol(id);
+}
+
+const std::string& Symbol::GetName() const {
+  return GetSymbolTable().names[id_];
+}
+
+}  // namespace parsing
+}  // namespace lamscript
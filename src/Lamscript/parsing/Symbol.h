@@ -0,0 +1,57 @@
+#ifndef SRC_LAMSCRIPT_PARSING_SYMBOL_H_
+#define SRC_LAMSCRIPT_PARSING_SYMBOL_H_
+
+#include <cstddef>
+#include <cstdint>
+#include <string>
+#include <unordered_map>
+
+namespace lamscript {
+namespace parsing {
+
+/// @brief An interned identifier.
+///
+/// Every identifier with the same name is interned to the same symbol, so
+/// symbols are compared and hashed by their id instead of their name. Tokens
+/// intern their lexeme when they're constructed if they name something,
+/// whether the scanner or the interpreter made them, which lets the runtime
+/// look names up without hashing or comparing strings.
+class Symbol {
+ public:
+  /// @brief Creates an invalid symbol that doesn't refer to any name.
+  Symbol() : id_(kInvalidId) {}
+
+  /// @brief Gets the symbol for a name, adding it to the global symbol table
+  /// the first time the name is seen.
+  static Symbol Intern(const std::string& name);
+
+  /// @brief Gets the name the symbol was interned from.
+  const std::string& GetName() const;
+
+  uint32_t GetId() const { return id_; }
+  bool IsValid() const { return id_ != kInvalidId; }
+
+  bool operator==(Symbol other) const { return id_ == other.id_; }
+  bool operator!=(Symbol other) const { return id_ != other.id_; }
+
+ private:
+  static constexpr uint32_t kInvalidId = UINT32_MAX;
+
+  explicit Symbol(uint32_t id) : id_(id) {}
+
+  uint32_t id_;
+};
+
+/// @brief Hashes symbols by their id, which is unique to their name.
+struct SymbolHash {
+  size_t operator()(Symbol symbol) const { return symbol.GetId(); }
+};
+
+/// @brief A hash map keyed by interned symbols.
+template<class ValueType>
+using SymbolMap = std::unordered_map<Symbol, ValueType, SymbolHash>;
+
+}  // namespace parsing
+}  // namespace lamscript
+
+#endif  // SRC_LAMSCRIPT_PARSING_SYMBOL_H_
@@ -3,23 +3,43 @@
 
 #include <any>
 #include <string>
+#include <utility>
 
+#include <Lamscript/parsing/Symbol.h>
 #include <Lamscript/parsing/TokenType.h>
 
 namespace lamscript {
 namespace parsing {
 
 struct Token {
+  /// @brief Creates a token, interning the lexeme of tokens that name
+  /// something so that tokens synthesized outside of the scanner can be looked
+  /// up by name just like scanned ones.
+  Token(TokenType type, std::string lexeme, std::any literal, int line)
+      : Type(type),
+        Lexeme(std::move(lexeme)),
+        Literal(std::move(literal)),
+        Line(line),
+        Identifier(IsName(type) ? Symbol::Intern(Lexeme) : Symbol()) {}
+
   TokenType Type;
   std::string Lexeme;
   std::any Literal;
   int Line;
+  /// @brief The interned name of identifiers, `this`, `super` and the names
+  /// given to functions. Invalid for every other type of token.
+  Symbol Identifier;
 
   /// @todo Fix this so that TokenTypes can easily be converted into strings
   /// later down the line.
   std::string ToString() {
     return ConvertTokenTypeToString(Type) + " " + Lexeme + " ";
   }
+
+ private:
+  static bool IsName(TokenType type) {
+    return type == IDENTIFIER || type == THIS || type == SUPER || type == FUN;
+  }
 };
 
 }  // namespace parsing
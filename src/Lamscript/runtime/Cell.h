@@ -0,0 +1,31 @@
+#ifndef SRC_LAMSCRIPT_RUNTIME_CELL_H_
+#define SRC_LAMSCRIPT_RUNTIME_CELL_H_
+
+#include <Lamscript/parsed/LamscriptObject.h>
+#include <Lamscript/runtime/Value.h>
+
+namespace lamscript {
+namespace runtime {
+
+/// @brief Heap allocated storage for a local variable that's captured by a
+/// closure.
+///
+/// The function that declares the variable and every closure that captures it
+/// share the same cell, so the variable outlives the call frame that it was
+/// declared in.
+class Cell : public parsed::LamscriptObject {
+ public:
+  Cell() = default;
+  explicit Cell(const Value& value) : value_(value) {}
+
+  const Value& Get() const { return value_; }
+  void Set(const Value& value) { value_ = value; }
+
+ private:
+  Value value_;
+};
+
+}  // namespace runtime
+}  // namespace lamscript
+
+#endif  // SRC_LAMSCRIPT_RUNTIME_CELL_H_
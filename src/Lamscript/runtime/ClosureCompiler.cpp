@@ -0,0 +1,721 @@
+#include <Lamscript/runtime/ClosureCompiler.h>
+
+#include <math.h>
+
+#include <functional>
+#include <iostream>
+#include <memory>
+#include <utility>
+#include <vector>
+
+#include <Lamscript/errors/RuntimeError.h>
+#include <Lamscript/errors/StackOverflowError.h>
+#include <Lamscript/parsed/LamscriptClass.h>
+#include <Lamscript/parsed/LamscriptFunction.h>
+#include <Lamscript/parsed/LamscriptString.h>
+#include <Lamscript/runtime/Interpreter.h>
+#include <Lamscript/runtime/Lamscript.h>
+
+namespace lamscript {
+namespace runtime {
+
+// ---------------------------------- INTERNAL ---------------------------------
+
+namespace {
+
+/// @brief Compiles an expression that evaluates to nil.
+CompiledExpression CompileNil() {
+  return [](Interpreter*) -> Value { return nullptr; };
+}
+
+/// @brief Compiles a binary operator that only accepts numbers, applying
+/// operation to the numbers once both operands are evaluated.
+template<class Operation>
+CompiledExpression CompileNumberOperation(
+    const parsing::Token* operator_used,
+    CompiledExpression left,
+    CompiledExpression right,
+    Operation operation) {
+  return [operator_used, left, right, operation](
+      Interpreter* interpreter) -> Value {
+    Value left_side = left(interpreter);
+    Value right_side = right(interpreter);
+
+    if (!left_side.IsNumber() || !right_side.IsNumber()) {
+      throw RuntimeError(*operator_used, "Operands must both be numbers.");
+    }
+
+    return operation(left_side.AsNumber(), right_side.AsNumber());
+  };
+}
+
+}  // namespace
+
+/// Defined before the visitors since they deduce its return type.
+template<class MakeClosure>
+auto ClosureCompiler::WithStore(
+    const parsing::Token& name,
+    const parsed::VariableLocation& location,
+    bool is_definition,
+    MakeClosure make_closure) {
+  size_t slot = location.Slot;
+
+  switch (location.Storage) {
+    case parsed::VariableStorage::Stack:
+      return make_closure([slot](Interpreter* interpreter, const Value& value) {
+        interpreter->stack_[interpreter->frame_base_ + slot] = value;
+      });
+    case parsed::VariableStorage::Cell:
+      return make_closure([slot](Interpreter* interpreter, const Value& value) {
+        interpreter->cells_[interpreter->frame_base_ + slot]->Set(value);
+      });
+    case parsed::VariableStorage::Upvalue:
+      return make_closure([slot](Interpreter* interpreter, const Value& value) {
+        (*interpreter->upvalues_)[slot]->Set(value);
+      });
+    case parsed::VariableStorage::Global:
+      break;
+  }
+
+  const parsing::Token* global = &name;
+
+  if (is_definition) {
+    return make_closure([global](Interpreter* interpreter, const Value& value) {
+      interpreter->globals_->SetVariable(*global, value);
+    });
+  }
+
+  return make_closure([global](Interpreter* interpreter, const Value& value) {
+    interpreter->globals_->AssignVariable(*global, value);
+  });
+}
+
+// ---------------------------------- PUBLIC -----------------------------------
+
+CompiledStatement ClosureCompiler::CompileProgram(
+    const std::vector<std::unique_ptr<parsed::Statement>>& statements) {
+  std::vector<CompiledStatement> compiled_statements;
+  compiled_statements.reserve(statements.size());
+
+  for (auto&& statement : statements) {
+    compiled_statements.push_back(Compile(statement.get()));
+  }
+
+  // Errors in top level statements stop the program, so they're left for the
+  // interpreter to catch.
+  return [compiled_statements](Interpreter* interpreter) {
+    for (const CompiledStatement& statement : compiled_statements) {
+      statement(interpreter);
+    }
+
+    return Completion::Normal;
+  };
+}
+
+// --------------------------------- EXPRESSIONS -------------------------------
+
+runtime::Value ClosureCompiler::VisitAssignExpression(
+    parsed::Assign* assignment) {
+  CompiledExpression value = Compile(assignment->GetValue());
+
+  compiled_expression_ = WithStore(
+      assignment->GetName(),
+      assignment->GetLocation(),
+      false,
+      [&value](auto store) -> CompiledExpression {
+        return [value, store](Interpreter* interpreter) {
+          Value result = value(interpreter);
+          store(interpreter, result);
+          return result;
+        };
+      });
+  return nullptr;
+}
+
+runtime::Value ClosureCompiler::VisitBinaryExpression(parsed::Binary* binary) {
+  CompiledExpression left = Compile(binary->GetLeftSide());
+  CompiledExpression right = Compile(binary->GetRightSide());
+  const parsing::Token* operator_used = &binary->GetOperator();
+
+  switch (operator_used->Type) {
+    case parsing::MINUS:
+      compiled_expression_ = CompileNumberOperation(
+          operator_used, left, right, std::minus<double>());
+      break;
+    case parsing::STAR:
+      compiled_expression_ = CompileNumberOperation(
+          operator_used, left, right, std::multiplies<double>());
+      break;
+    case parsing::MODULUS:
+      compiled_expression_ = CompileNumberOperation(
+          operator_used, left, right, [](double left_side, double right_side) {
+            return fmod(left_side, right_side);
+          });
+      break;
+    case parsing::GREATER:
+      compiled_expression_ = CompileNumberOperation(
+          operator_used, left, right, std::greater<double>());
+      break;
+    case parsing::GREATER_EQUAL:
+      compiled_expression_ = CompileNumberOperation(
+          operator_used, left, right, std::greater_equal<double>());
+      break;
+    case parsing::LESS:
+      compiled_expression_ = CompileNumberOperation(
+          operator_used, left, right, std::less<double>());
+      break;
+    case parsing::LESS_EQUAL:
+      compiled_expression_ = CompileNumberOperation(
+          operator_used, left, right, std::less_equal<double>());
+      break;
+    case parsing::SLASH:
+      compiled_expression_ = [operator_used, left, right](
+          Interpreter* interpreter) -> Value {
+        Value left_side = left(interpreter);
+        Value right_side = right(interpreter);
+
+        if (!left_side.IsNumber() || !right_side.IsNumber()) {
+          throw RuntimeError(*operator_used, "Operands must both be numbers.");
+        }
+
+        double divisor = right_side.AsNumber();
+        if (divisor == 0) {
+          throw RuntimeError(*operator_used, "Divide by 0 error.");
+        }
+
+        return left_side.AsNumber() / divisor;
+      };
+      break;
+    case parsing::PLUS:
+      compiled_expression_ = [operator_used, left, right](
+          Interpreter* interpreter) -> Value {
+        Value left_side = left(interpreter);
+        Value right_side = right(interpreter);
+
+        if (left_side.IsNumber() && right_side.IsNumber()) {
+          return left_side.AsNumber() + right_side.AsNumber();
+        }
+
+        if (left_side.IsString() && right_side.IsString()) {
+          return parsed::LamscriptString::Concatenate(
+              left_side.AsObject<parsed::LamscriptString>(),
+              right_side.AsObject<parsed::LamscriptString>());
+        }
+
+        throw RuntimeError(
+            *operator_used, "Operands must be two numbers or strings.");
+      };
+      break;
+    case parsing::EQUAL_EQUAL:
+      compiled_expression_ = [left, right](Interpreter* interpreter) -> Value {
+        Value left_side = left(interpreter);
+        return Interpreter::IsEqual(left_side, right(interpreter));
+      };
+      break;
+    case parsing::BANG_EQUAL:
+      compiled_expression_ = [left, right](Interpreter* interpreter) -> Value {
+        Value left_side = left(interpreter);
+        return !Interpreter::IsEqual(left_side, right(interpreter));
+      };
+      break;
+    default:
+      compiled_expression_ = [left, right](Interpreter* interpreter) -> Value {
+        left(interpreter);
+        right(interpreter);
+        return nullptr;
+      };
+      break;
+  }
+
+  return nullptr;
+}
+
+/// The decision between calling a method of the receiver directly and calling
+/// the value of the callee is made when the call is compiled, since it only
+/// depends on the shape of the callee expression.
+runtime::Value ClosureCompiler::VisitCallExpression(parsed::Call* call) {
+  std::vector<CompiledExpression> arguments;
+  arguments.reserve(call->GetArguments().size());
+
+  for (auto&& argument : call->GetArguments()) {
+    arguments.push_back(Compile(argument.get()));
+  }
+
+  const parsing::Token* parentheses = &call->GetParentheses();
+
+  if (parsed::Get* getter = call->GetMethodCallee()) {
+    CompiledExpression object = Compile(getter->GetObject().get());
+
+    compiled_expression_ = [object, getter, parentheses, arguments](
+        Interpreter* interpreter) {
+      Value receiver = object(interpreter);
+      const parsed::LamscriptFunction* method = Interpreter::FindMethod(
+          receiver, getter->GetName());
+
+      if (method == nullptr) {
+        Value callee = interpreter->GetProperty(receiver, getter);
+        return Call(
+            interpreter, *parentheses, callee, nullptr, nullptr, arguments);
+      }
+
+      // Static methods aren't bound to the class they're called on, but the
+      // class is held as the callee so that its methods outlive the call.
+      if (!receiver.IsInstance()) {
+        return Call(
+            interpreter, *parentheses, receiver, method, nullptr, arguments);
+      }
+
+      return Call(
+          interpreter, *parentheses, nullptr, method, receiver, arguments);
+    };
+    return nullptr;
+  }
+
+  CompiledExpression callee = Compile(call->GetCallee());
+
+  compiled_expression_ = [callee, parentheses, arguments](
+      Interpreter* interpreter) {
+    return Call(
+        interpreter,
+        *parentheses,
+        callee(interpreter),
+        nullptr,
+        nullptr,
+        arguments);
+  };
+  return nullptr;
+}
+
+runtime::Value ClosureCompiler::VisitGetExpression(parsed::Get* getter) {
+  CompiledExpression object = Compile(getter->GetObject().get());
+
+  compiled_expression_ = [object, getter](Interpreter* interpreter) {
+    return interpreter->GetProperty(object(interpreter), getter);
+  };
+  return nullptr;
+}
+
+/// Groupings only affect parsing, so they compile to the expression inside of
+/// them.
+runtime::Value ClosureCompiler::VisitGroupingExpression(
+    parsed::Grouping* grouping) {
+  compiled_expression_ = Compile(grouping->GetExpression());
+  return nullptr;
+}
+
+runtime::Value ClosureCompiler::VisitLiteralExpression(
+    parsed::Literal* literal) {
+  Value value = literal->GetValue();
+
+  compiled_expression_ = [value](Interpreter*) { return value; };
+  return nullptr;
+}
+
+runtime::Value ClosureCompiler::VisitLogicalExpression(
+    parsed::Logical* logical) {
+  CompiledExpression left = Compile(logical->GetLeftOperand());
+  CompiledExpression right = Compile(logical->GetRightOperand());
+
+  if (logical->GetLogicalOperator().Type == parsing::OR) {
+    compiled_expression_ = [left, right](Interpreter* interpreter) {
+      Value left_side = left(interpreter);
+
+      if (Interpreter::IsTruthy(left_side)) {
+        return left_side;
+      }
+
+      return right(interpreter);
+    };
+  } else {
+    compiled_expression_ = [left, right](Interpreter* interpreter) {
+      Value left_side = left(interpreter);
+
+      if (!Interpreter::IsTruthy(left_side)) {
+        return left_side;
+      }
+
+      return right(interpreter);
+    };
+  }
+
+  return nullptr;
+}
+
+runtime::Value ClosureCompiler::VisitSetExpression(parsed::Set* setter) {
+  CompiledExpression object = Compile(setter->GetObject().get());
+  CompiledExpression value = Compile(setter->GetValue());
+
+  compiled_expression_ = [object, value, setter](Interpreter* interpreter) {
+    Value instance = object(interpreter);
+
+    if (!instance.IsInstance()) {
+      throw RuntimeError(setter->GetName(), "Only instances have fields.");
+    }
+
+    Value result = value(interpreter);
+    interpreter->WriteField(
+        instance.AsObject<parsed::LamscriptInstance>(), setter, result);
+    return result;
+  };
+  return nullptr;
+}
+
+runtime::Value ClosureCompiler::VisitSuperExpression(parsed::Super* super) {
+  CompiledExpression super_class = CompileLoad(
+      super->GetKeyword(), super->GetLocation());
+  CompiledExpression instance = Compile(super->GetThis());
+  const parsing::Token* method_name = &super->GetMethod();
+
+  compiled_expression_ = [super_class, instance, method_name](
+      Interpreter* interpreter) -> Value {
+    const parsed::LamscriptFunction* method = Interpreter::AsClass(
+        super_class(interpreter))->LookupMethod(method_name->Identifier);
+
+    if (method == nullptr) {
+      throw RuntimeError(
+          *method_name, "Undefined property '" + method_name->Lexeme + "'.");
+    }
+
+    return method->Bind(instance(interpreter));
+  };
+  return nullptr;
+}
+
+runtime::Value ClosureCompiler::VisitThisExpression(parsed::This* this_expr) {
+  compiled_expression_ = CompileLoad(
+      this_expr->GetKeyword(), this_expr->GetLocation());
+  return nullptr;
+}
+
+runtime::Value ClosureCompiler::VisitUnaryExpression(parsed::Unary* unary) {
+  CompiledExpression right = Compile(unary->GetRightExpression());
+  const parsing::Token* operator_used = &unary->GetUnaryOperator();
+
+  switch (operator_used->Type) {
+    case parsing::BANG:
+      compiled_expression_ = [right](Interpreter* interpreter) -> Value {
+        return !Interpreter::IsTruthy(right(interpreter));
+      };
+      break;
+    case parsing::MINUS:
+      compiled_expression_ = [right, operator_used](
+          Interpreter* interpreter) -> Value {
+        Value right_side = right(interpreter);
+
+        if (!right_side.IsNumber()) {
+          throw RuntimeError(*operator_used, "Operand must be a number.");
+        }
+
+        return -right_side.AsNumber();
+      };
+      break;
+    default:
+      compiled_expression_ = [right](Interpreter* interpreter) -> Value {
+        right(interpreter);
+        return nullptr;
+      };
+      break;
+  }
+
+  return nullptr;
+}
+
+runtime::Value ClosureCompiler::VisitVariableExpression(
+    parsed::Variable* variable) {
+  compiled_expression_ = CompileLoad(
+      variable->GetName(), variable->GetLocation());
+  return nullptr;
+}
+
+runtime::Value ClosureCompiler::VisitLambdaExpression(
+    parsed::LambdaExpression* expression) {
+  parsed::Function* function = static_cast<parsed::Function*>(
+      expression->GetFunctionStatement());
+  CompileFunction(function);
+
+  compiled_expression_ = [function](Interpreter* interpreter) -> Value {
+    return interpreter->MakeFunction(function, false);
+  };
+  return nullptr;
+}
+
+// --------------------------------- STATEMENTS --------------------------------
+
+runtime::Completion ClosureCompiler::VisitBlockStatement(parsed::Block* block) {
+  compiled_statement_ = CompileStatements(block->GetStatements());
+  return Completion::Normal;
+}
+
+/// Methods are compiled along with the class, while creating the class is left
+/// to the interpreter since it only happens once per class definition.
+runtime::Completion ClosureCompiler::VisitClassStatement(
+    parsed::Class* class_def) {
+  for (auto& method : class_def->GetMethods()) {
+    CompileFunction(method.get());
+  }
+
+  CompiledExpression super_class = class_def->GetSuperClass() != nullptr
+      ? Compile(class_def->GetSuperClass()) : CompileNil();
+
+  compiled_statement_ = [class_def, super_class](Interpreter* interpreter) {
+    interpreter->DefineClass(class_def, super_class(interpreter));
+    return Completion::Normal;
+  };
+  return Completion::Normal;
+}
+
+runtime::Completion ClosureCompiler::VisitExpressionStatement(
+    parsed::ExpressionStatement* statement) {
+  CompiledExpression expression = Compile(statement->GetExpression());
+
+  compiled_statement_ = [expression](Interpreter* interpreter) {
+    expression(interpreter);
+    return Completion::Normal;
+  };
+  return Completion::Normal;
+}
+
+/// The variable is declared before the function is created so that recursive
+/// functions can capture themselves.
+runtime::Completion ClosureCompiler::VisitFunctionStatement(
+    parsed::Function* func) {
+  CompileFunction(func);
+  bool needs_cell = func->GetLocation().Storage
+      == parsed::VariableStorage::Cell;
+  size_t slot = func->GetLocation().Slot;
+
+  compiled_statement_ = WithStore(
+      func->GetName(),
+      func->GetLocation(),
+      true,
+      [func, needs_cell, slot](auto store) -> CompiledStatement {
+        return [func, needs_cell, slot, store](Interpreter* interpreter) {
+          if (needs_cell) {
+            interpreter->cells_[interpreter->frame_base_ + slot] =
+                parsed::MakeRef<Cell>();
+          }
+
+          store(
+              interpreter,
+              interpreter->MakeFunction(func, false));
+          return Completion::Normal;
+        };
+      });
+  return Completion::Normal;
+}
+
+runtime::Completion ClosureCompiler::VisitIfStatement(
+    parsed::If* if_statement) {
+  CompiledExpression condition = Compile(if_statement->GetCondition());
+  CompiledStatement then_branch = Compile(if_statement->GetThenBranch());
+
+  if (if_statement->GetElseBranch() == nullptr) {
+    compiled_statement_ = [condition, then_branch](Interpreter* interpreter) {
+      if (Interpreter::IsTruthy(condition(interpreter))) {
+        return then_branch(interpreter);
+      }
+
+      return Completion::Normal;
+    };
+    return Completion::Normal;
+  }
+
+  CompiledStatement else_branch = Compile(if_statement->GetElseBranch());
+
+  compiled_statement_ = [condition, then_branch, else_branch](
+      Interpreter* interpreter) {
+    if (Interpreter::IsTruthy(condition(interpreter))) {
+      return then_branch(interpreter);
+    }
+
+    return else_branch(interpreter);
+  };
+  return Completion::Normal;
+}
+
+runtime::Completion ClosureCompiler::VisitPrintStatement(parsed::Print* print) {
+  CompiledExpression expression = Compile(print->GetExpression());
+
+  compiled_statement_ = [expression](Interpreter* interpreter) {
+    Value value = expression(interpreter);
+    std::cout << interpreter->Stringify(value) << std::endl;
+    return Completion::Normal;
+  };
+  return Completion::Normal;
+}
+
+runtime::Completion ClosureCompiler::VisitReturnStatement(
+    parsed::Return* return_statement) {
+  CompiledExpression value = return_statement->GetValue() != nullptr
+      ? Compile(return_statement->GetValue()) : CompileNil();
+
+  compiled_statement_ = [value](Interpreter* interpreter) {
+    interpreter->return_value_ = value(interpreter);
+    return Completion::Return;
+  };
+  return Completion::Normal;
+}
+
+/// Captured variables get a fresh cell every time their declaration runs, so
+/// the cell is created before the initializer is evaluated.
+runtime::Completion ClosureCompiler::VisitVariableStatement(
+    parsed::VariableStatement* variable) {
+  CompiledExpression initializer = variable->GetInitializer() != nullptr
+      ? Compile(variable->GetInitializer()) : CompileNil();
+  bool needs_cell = variable->GetLocation().Storage
+      == parsed::VariableStorage::Cell;
+  size_t slot = variable->GetLocation().Slot;
+
+  compiled_statement_ = WithStore(
+      variable->GetName(),
+      variable->GetLocation(),
+      true,
+      [&initializer, needs_cell, slot](auto store) -> CompiledStatement {
+        return [initializer, needs_cell, slot, store](
+            Interpreter* interpreter) {
+          if (needs_cell) {
+            interpreter->cells_[interpreter->frame_base_ + slot] =
+                parsed::MakeRef<Cell>();
+          }
+
+          store(interpreter, initializer(interpreter));
+          return Completion::Normal;
+        };
+      });
+  return Completion::Normal;
+}
+
+runtime::Completion ClosureCompiler::VisitWhileStatement(
+    parsed::While* while_statement) {
+  CompiledExpression condition = Compile(while_statement->GetCondition());
+  CompiledStatement body = Compile(while_statement->GetBody());
+
+  compiled_statement_ = [condition, body](Interpreter* interpreter) {
+    while (Interpreter::IsTruthy(condition(interpreter))) {
+      Completion completion = body(interpreter);
+
+      if (completion == Completion::Break) {
+        break;
+      }
+
+      if (completion == Completion::Return) {
+        return completion;
+      }
+    }
+
+    return Completion::Normal;
+  };
+  return Completion::Normal;
+}
+
+// ---------------------------------- PRIVATE ----------------------------------
+
+CompiledExpression ClosureCompiler::Compile(parsed::Expression* expression) {
+  expression->Accept(this);
+  return std::move(compiled_expression_);
+}
+
+CompiledStatement ClosureCompiler::Compile(parsed::Statement* statement) {
+  statement->Accept(this);
+  return std::move(compiled_statement_);
+}
+
+/// Runtime errors stop the statements and are reported without unwinding any
+/// further, except for stack overflows, the same way the interpreter executes
+/// them.
+CompiledStatement ClosureCompiler::CompileStatements(
+    const std::vector<std::unique_ptr<parsed::Statement>>& statements) {
+  std::vector<CompiledStatement> compiled_statements;
+  compiled_statements.reserve(statements.size());
+
+  for (auto&& statement : statements) {
+    compiled_statements.push_back(Compile(statement.get()));
+  }
+
+  return [compiled_statements](Interpreter* interpreter) {
+    Completion completion = Completion::Normal;
+
+    try {
+      for (const CompiledStatement& statement : compiled_statements) {
+        completion = statement(interpreter);
+
+        if (completion != Completion::Normal) {
+          break;
+        }
+      }
+    } catch (const StackOverflowError&) {
+      throw;
+    } catch (const RuntimeError& error) {
+      Lamscript::RuntimeError(error);
+    }
+
+    return completion;
+  };
+}
+
+void ClosureCompiler::CompileFunction(parsed::Function* function) {
+  function->SetCompiledBody(CompileStatements(function->GetBody()));
+}
+
+Value ClosureCompiler::Call(
+    Interpreter* interpreter,
+    const parsing::Token& parentheses,
+    const Value& callee,
+    const parsed::LamscriptFunction* method,
+    const Value& receiver,
+    const std::vector<CompiledExpression>& arguments) {
+  size_t argument_count = arguments.size();
+  size_t call_base = interpreter->stack_top_;
+
+  if (argument_count + 1 > interpreter->stack_.size() - call_base) {
+    throw StackOverflowError(parentheses);
+  }
+
+  interpreter->stack_top_ += argument_count + 1;
+  Value result;
+
+  try {
+    for (size_t i = 0; i < argument_count; i++) {
+      interpreter->stack_[call_base + 1 + i] = arguments[i](interpreter);
+    }
+
+    result = interpreter->CallWithArguments(
+        parentheses, callee, method, receiver, call_base, argument_count);
+  } catch (const RuntimeError&) {
+    interpreter->TruncateStack(call_base);
+    throw;
+  }
+
+  interpreter->TruncateStack(call_base);
+  return result;
+}
+
+CompiledExpression ClosureCompiler::CompileLoad(
+    const parsing::Token& name, const parsed::VariableLocation& location) {
+  size_t slot = location.Slot;
+
+  switch (location.Storage) {
+    case parsed::VariableStorage::Stack:
+      return [slot](Interpreter* interpreter) {
+        return interpreter->stack_[interpreter->frame_base_ + slot];
+      };
+    case parsed::VariableStorage::Cell:
+      return [slot](Interpreter* interpreter) {
+        return interpreter->cells_[interpreter->frame_base_ + slot]->Get();
+      };
+    case parsed::VariableStorage::Upvalue:
+      return [slot](Interpreter* interpreter) {
+        return (*interpreter->upvalues_)[slot]->Get();
+      };
+    case parsed::VariableStorage::Global:
+      break;
+  }
+
+  const parsing::Token* global = &name;
+  return [global](Interpreter* interpreter) {
+    return interpreter->globals_->GetVariable(*global);
+  };
+}
+
+}  // namespace runtime
+}  // namespace lamscript
@@ -0,0 +1,117 @@
+#ifndef SRC_LAMSCRIPT_RUNTIME_CLOSURECOMPILER_H_
+#define SRC_LAMSCRIPT_RUNTIME_CLOSURECOMPILER_H_
+
+#include <memory>
+#include <vector>
+
+#include <Lamscript/Visitor.h>
+#include <Lamscript/parsed/Expression.h>
+#include <Lamscript/parsed/Statement.h>
+#include <Lamscript/runtime/CompiledCode.h>
+#include <Lamscript/runtime/Completion.h>
+#include <Lamscript/runtime/Value.h>
+
+namespace lamscript {
+
+namespace parsed {
+class LamscriptFunction;
+}  // namespace parsed
+
+namespace runtime {
+
+/// @brief Compiles resolved programs into trees of closures that the
+/// Interpreter can run instead of walking the parsed program.
+///
+/// Every node is compiled once into a closure that's specialized for it, so
+/// decisions that the tree walker makes each time it visits a node (which
+/// operator to apply, where a variable is stored, how many arguments a call
+/// has) are made while compiling. Running a compiled node is a single
+/// indirect call instead of a visit through Accept.
+///
+/// The bodies of functions are stored in their declarations, so functions
+/// created by compiled code run their compiled body when they're called.
+class ClosureCompiler : ExpressionVisitor, StatementVisitor {
+ public:
+  ClosureCompiler() : compiled_expression_(), compiled_statement_() {}
+
+  /// @brief Compiles the top level statements of a program.
+  CompiledStatement CompileProgram(
+      const std::vector<std::unique_ptr<parsed::Statement>>& statements);
+
+  runtime::Value VisitAssignExpression(parsed::Assign* assignment) override;
+  runtime::Value VisitBinaryExpression(parsed::Binary* binary) override;
+  runtime::Value VisitCallExpression(parsed::Call* call) override;
+  runtime::Value VisitGetExpression(parsed::Get* getter) override;
+  runtime::Value VisitGroupingExpression(parsed::Grouping* grouping) override;
+  runtime::Value VisitLiteralExpression(parsed::Literal* literal) override;
+  runtime::Value VisitLogicalExpression(parsed::Logical* logical) override;
+  runtime::Value VisitSetExpression(parsed::Set* setter) override;
+  runtime::Value VisitSuperExpression(parsed::Super* super) override;
+  runtime::Value VisitThisExpression(parsed::This* this_expr) override;
+  runtime::Value VisitUnaryExpression(parsed::Unary* unary) override;
+  runtime::Value VisitVariableExpression(parsed::Variable* variable) override;
+  runtime::Value VisitLambdaExpression(
+      parsed::LambdaExpression* expression) override;
+
+  runtime::Completion VisitBlockStatement(parsed::Block* block) override;
+  runtime::Completion VisitClassStatement(parsed::Class* class_def) override;
+  runtime::Completion VisitExpressionStatement(
+      parsed::ExpressionStatement* statement) override;
+  runtime::Completion VisitFunctionStatement(parsed::Function* func) override;
+  runtime::Completion VisitIfStatement(parsed::If* if_statement) override;
+  runtime::Completion VisitPrintStatement(parsed::Print* print) override;
+  runtime::Completion VisitReturnStatement(
+      parsed::Return* return_statement) override;
+  runtime::Completion VisitVariableStatement(
+      parsed::VariableStatement* variable) override;
+  runtime::Completion VisitWhileStatement(
+      parsed::While* while_statement) override;
+
+ private:
+  /// @brief Set by the expression visitors to the closure they compiled.
+  CompiledExpression compiled_expression_;
+
+  /// @brief Set by the statement visitors to the closure they compiled.
+  CompiledStatement compiled_statement_;
+
+  CompiledExpression Compile(parsed::Expression* expression);
+  CompiledStatement Compile(parsed::Statement* statement);
+
+  /// @brief Compiles statements that run one after another, stopping as soon
+  /// as one of them transfers control.
+  CompiledStatement CompileStatements(
+      const std::vector<std::unique_ptr<parsed::Statement>>& statements);
+
+  /// @brief Compiles the body of a function and stores it in the function.
+  void CompileFunction(parsed::Function* function);
+
+  /// @brief Evaluates the arguments of a call onto the top of the value stack
+  /// and calls the callee (or the method of the receiver) with them.
+  static Value Call(
+      Interpreter* interpreter,
+      const parsing::Token& parentheses,
+      const Value& callee,
+      const parsed::LamscriptFunction* method,
+      const Value& receiver,
+      const std::vector<CompiledExpression>& arguments);
+
+  /// @brief Compiles reading the variable at the location the resolver found
+  /// it at.
+  CompiledExpression CompileLoad(
+      const parsing::Token& name, const parsed::VariableLocation& location);
+
+  /// @brief Calls make_closure with a function that stores a value into the
+  /// variable at the location, specialized by where the variable is stored.
+  /// Defining a global creates it while assigning one requires it to exist.
+  template<class MakeClosure>
+  auto WithStore(
+      const parsing::Token& name,
+      const parsed::VariableLocation& location,
+      bool is_definition,
+      MakeClosure make_closure);
+};
+
+}  // namespace runtime
+}  // namespace lamscript
+
+#endif  // SRC_LAMSCRIPT_RUNTIME_CLOSURECOMPILER_H_
@@ -0,0 +1,33 @@
+#ifndef SRC_LAMSCRIPT_RUNTIME_COMPILEDCODE_H_
+#define SRC_LAMSCRIPT_RUNTIME_COMPILEDCODE_H_
+
+#include <functional>
+
+#include <Lamscript/runtime/Completion.h>
+#include <Lamscript/runtime/Value.h>
+
+namespace lamscript {
+namespace runtime {
+
+class Interpreter;
+
+/// @brief An expression compiled by the ClosureCompiler. Evaluates the
+/// expression within the interpreter's current call frame.
+using CompiledExpression = std::function<Value(Interpreter*)>;
+
+/// @brief A statement compiled by the ClosureCompiler. Executes the statement
+/// within the interpreter's current call frame.
+using CompiledStatement = std::function<Completion(Interpreter*)>;
+
+/// @brief The engines that can execute resolved programs.
+enum class ExecutionEngine {
+  /// @brief Walks the parsed program with the Interpreter's visitors.
+  TreeWalker,
+  /// @brief Compiles the parsed program into closures before running it.
+  ClosureCompiler
+};
+
+}  // namespace runtime
+}  // namespace lamscript
+
+#endif  // SRC_LAMSCRIPT_RUNTIME_COMPILEDCODE_H_
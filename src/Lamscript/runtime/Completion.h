@@ -0,0 +1,25 @@
+#ifndef SRC_LAMSCRIPT_RUNTIME_COMPLETION_H_
+#define SRC_LAMSCRIPT_RUNTIME_COMPLETION_H_
+
+#include <cstdint>
+
+namespace lamscript {
+namespace runtime {
+
+/// @brief How the execution of a statement finished.
+///
+/// Statements that transfer control (return, break, continue) report it to
+/// the statement executing them instead of unwinding the C++ stack. Returned
+/// values are held by the interpreter until the function call that's
+/// returning picks them up.
+enum class Completion : std::uint8_t {
+  Normal,
+  Return,
+  Break,
+  Continue
+};
+
+}  // namespace runtime
+}  // namespace lamscript
+
+#endif  // SRC_LAMSCRIPT_RUNTIME_COMPLETION_H_
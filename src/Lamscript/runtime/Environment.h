@@ -1,50 +1,38 @@
 #ifndef SRC_LAMSCRIPT_RUNTIME_ENVIRONMENT_H_
 #define SRC_LAMSCRIPT_RUNTIME_ENVIRONMENT_H_
 
-#include <any>
 #include <iostream>
 #include <memory>
 #include <string>
 #include <unordered_map>
 
+#include <Lamscript/parsing/Symbol.h>
 #include <Lamscript/parsing/Token.h>
+#include <Lamscript/runtime/Value.h>
 
 namespace lamscript {
 namespace runtime {
 
-/// @brief Allows for the storage of variables in memory.
+/// @brief Allows for the storage of global variables in memory.
+///
+/// Locals are stored on the interpreters value stack (or in cells when they're
+/// captured by a closure), so environments only store the variables that are
+/// declared at the top level by their interned name.
 class Environment {
  public:
-  /// @brief Create a new environment with no parent (Usually the global
-  /// environment).
-  Environment() : parent_(nullptr) {}
+  Environment() = default;
 
-  /// @brief Create an environment within a parent environment.
-  explicit Environment(std::shared_ptr<Environment> parent) : parent_(parent) {}
+  /// @brief Defines a global variable within the current environment.
+  void SetVariable(const parsing::Token& name, const Value& value);
 
-  /// @brief Defines a variable within the current environment.
-  void SetVariable(const parsing::Token& name, std::any value);
+  /// @brief Assigns a global variable within the current environment.
+  void AssignVariable(const parsing::Token& name, const Value& value);
 
-  /// @brief Assigns a variable within the current environment.
-  void AssignVariable(const parsing::Token& name, std::any value);
-
-  /// @brief Assigns a variable at a further up scope.
-  void AssignVariableAtScope(
-      size_t distance, const parsing::Token& name, std::any value);
-
-  /// @brief Gets a variable within the current environment.
-  std::any GetVariable(const parsing::Token& token);
-
-  /// brief Gets a variable at scope.
-  std::any GetVariableAtScope(size_t distance, const parsing::Token& name);
-
-  std::shared_ptr<Environment> GetParentEnvironment() { return parent_; }
+  /// @brief Gets a global variable within the current environment.
+  Value GetVariable(const parsing::Token& token);
 
  private:
-  std::shared_ptr<Environment> parent_;
-  std::unordered_map<std::string, std::any> values_;
-
-  Environment* ScopeAt(const size_t& distance);
+  parsing::SymbolMap<Value> values_;
 };
 
 }  // namespace runtime
@@ -1,10 +1,17 @@
 #include <Lamscript/runtime/Interpreter.h>
 
-#include <any>
 #include <math.h>
+
+#ifndef _WIN32
+#include <sys/resource.h>
+#endif
+
+#include <algorithm>
+#include <cstdint>
+#include <limits>
 #include <string>
-#include <typeinfo>
 
+#include <Lamscript/errors/StackOverflowError.h>
 #include <Lamscript/lib/Globals.h>
 #include <Lamscript/parsed/LamscriptCallable.h>
 #include <Lamscript/parsed/LamscriptClass.h>
@@ -19,580 +26,1109 @@ namespace runtime {
 
 namespace {
 
-template<class ReturnType>
-ReturnType AnyAs(std::any any_object) {
-  return std::any_cast<ReturnType>(any_object);
-}
+/// @brief The number of values that can be stored on the value stack.
+const size_t kMaxStackSize = 1 << 16;
+
+/// @brief The number of frames that can be pushed at once, the same as
+/// lamscripten allows.
+const size_t kMaxCallDepth = 1 << 14;
+
+/// @brief The native stack left over for the code that runs between pushing
+/// frames and for whatever called into the interpreter.
+const size_t kNativeStackReserve = 1 << 17;
+
+/// @brief The number of bytes of native stack that calls can use, based on
+/// the size of the main thread's stack.
+size_t GetNativeStackLimit() {
+#ifdef _WIN32
+  // Windows reserves a megabyte for the main thread unless the executable
+  // asks for more.
+  size_t stack_size = 1 << 20;
+#else
+  rlimit limit;
+
+  if (getrlimit(RLIMIT_STACK, &limit) != 0
+      || limit.rlim_cur == RLIM_INFINITY) {
+    return std::numeric_limits<size_t>::max();
+  }
+
+  size_t stack_size = limit.rlim_cur;
+#endif
 
-typedef std::shared_ptr<parsed::LamscriptInstance> SharedLamscriptInstance;
-typedef std::shared_ptr<parsed::LamscriptCallable> SharedLamscriptCallable;
-typedef std::shared_ptr<parsed::LamscriptClass> SharedLamscriptClass;
+  return stack_size > kNativeStackReserve
+      ? stack_size - kNativeStackReserve : 0;
+}
 
-const std::type_info& LS_TYPE_BOOLEAN = typeid(bool);
-const std::type_info& LS_TYPE_NUMBER = typeid(double);
-const std::type_info& LS_TYPE_STRING = typeid(std::string);
-const std::type_info& LS_TYPE_INSTANCE = typeid(SharedLamscriptInstance);
-const std::type_info& LS_TYPE_CALLABLE = typeid(SharedLamscriptCallable);
-const std::type_info& LS_TYPE_CLASS = typeid(SharedLamscriptClass);
+/// @brief The address of the running function's frame on the native stack.
+uintptr_t GetNativeStackPointer() {
+  volatile char marker = 0;
+  return reinterpret_cast<uintptr_t>(&marker);
+}
 
 }  // namespace
 
 // ---------------------------------- PUBLIC -----------------------------------
 
 Interpreter::Interpreter()
-    : globals_(new Environment()), environment_(globals_) {
+    : globals_(new Environment()),
+    stack_(kMaxStackSize),
+    cells_(kMaxStackSize),
+    stack_top_(0),
+    frame_base_(0),
+    call_depth_(0),
+    native_stack_base_(GetNativeStackPointer()),
+    native_stack_limit_(GetNativeStackLimit()),
+    upvalues_(nullptr),
+    program_(nullptr) {
   globals_->SetVariable(
       parsing::Token{parsing::FUN, "clock", nullptr, 0},
-      SharedLamscriptCallable(new lib::Clock()));
+      parsed::MakeRef<lib::Clock>());
 }
 
 // --------------------------------- EXPRESSIONS -------------------------------
 
-std::any Interpreter::VisitAssignExpression(parsed::Assign* expression) {
-  std::any value = Evaluate(expression->GetValue());
-
-  try {
-    size_t& distance = locals_.at(expression);
-    environment_->AssignVariableAtScope(distance, expression->GetName(), value);
-  } catch (const std::out_of_range& error) {
-    globals_->AssignVariable(expression->GetName(), value);
-  }
-
+Value Interpreter::VisitAssignExpression(parsed::Assign* expression) {
+  Value value = Evaluate(expression->GetValue());
+  AssignVariable(expression->GetName(), expression->GetLocation(), value);
   return value;
 }
 
-std::any Interpreter::VisitLiteralExpression(parsed::Literal* expression) {
+Value Interpreter::VisitLiteralExpression(parsed::Literal* expression) {
   return expression->GetValue();
 }
 
-std::any Interpreter::VisitGroupingExpression(parsed::Grouping* expression) {
+Value Interpreter::VisitGroupingExpression(parsed::Grouping* expression) {
   return Evaluate(expression->GetExpression());
 }
 
-std::any Interpreter::VisitVariableExpression(parsed::Variable* variable) {
-  return LookupVariable(variable->GetName(), variable);
+Value Interpreter::VisitVariableExpression(parsed::Variable* variable) {
+  return LookupVariable(variable->GetName(), variable->GetLocation());
 }
 
-std::any Interpreter::VisitUnaryExpression(parsed::Unary* expression) {
-  std::any right_side = Evaluate(expression);
-
-  switch (expression->GetUnaryOperator().Type) {
-    case parsing::BANG:
-      return !IsTruthy(right_side);
-    case parsing::MINUS:
-      CheckNumberOperand(expression->GetUnaryOperator(), right_side);
-      return -(AnyAs<double>(right_side));
-    default:
-      return nullptr;
+/// Unary, binary, and logical expressions specialize themselves for the types
+/// of the operands they're first evaluated with. A specialized expression
+/// applies its operation directly while its operands keep those types and
+/// deoptimizes back to the generic operator the first time they don't.
+Value Interpreter::VisitUnaryExpression(parsed::Unary* expression) {
+  Value right_side = Evaluate(expression->GetRightExpression());
+
+  switch (expression->GetSpecialization()) {
+    case parsed::UnarySpecialization::NumberNegate:
+      if (right_side.IsNumber()) {
+        return -right_side.AsNumber();
+      }
+      break;
+    case parsed::UnarySpecialization::BooleanNot:
+      if (right_side.IsBoolean()) {
+        return !right_side.AsBoolean();
+      }
+      break;
+    case parsed::UnarySpecialization::Uninitialized:
+      expression->Specialize(
+          parsed::SpecializeUnary(
+              expression->GetUnaryOperator().Type, right_side));
+      return ApplyUnaryOperator(expression->GetUnaryOperator(), right_side);
+    case parsed::UnarySpecialization::Generic:
+      return ApplyUnaryOperator(expression->GetUnaryOperator(), right_side);
   }
+
+  expression->Specialize(parsed::UnarySpecialization::Generic);
+  return ApplyUnaryOperator(expression->GetUnaryOperator(), right_side);
 }
 
-std::any Interpreter::VisitBinaryExpression(parsed::Binary* expression) {
-  std::any left_side = Evaluate(expression->GetLeftSide());
-  std::any right_side = Evaluate(expression->GetRightSide());
+Value Interpreter::VisitBinaryExpression(parsed::Binary* expression) {
+  Value left_side = Evaluate(expression->GetLeftSide());
+  Value right_side = Evaluate(expression->GetRightSide());
+  bool numbers = left_side.IsNumber() && right_side.IsNumber();
 
-  if (left_side.type() == LS_TYPE_NUMBER
-      || right_side.type() == LS_TYPE_NUMBER) {
-    CheckNumberOperands(expression->GetOperator(), left_side, right_side);
+  switch (expression->GetSpecialization()) {
+    case parsed::BinarySpecialization::NumberAdd:
+      if (numbers) {
+        return left_side.AsNumber() + right_side.AsNumber();
+      }
+      break;
+    case parsed::BinarySpecialization::NumberSubtract:
+      if (numbers) {
+        return left_side.AsNumber() - right_side.AsNumber();
+      }
+      break;
+    case parsed::BinarySpecialization::NumberMultiply:
+      if (numbers) {
+        return left_side.AsNumber() * right_side.AsNumber();
+      }
+      break;
+    case parsed::BinarySpecialization::NumberGreater:
+      if (numbers) {
+        return left_side.AsNumber() > right_side.AsNumber();
+      }
+      break;
+    case parsed::BinarySpecialization::NumberGreaterEqual:
+      if (numbers) {
+        return left_side.AsNumber() >= right_side.AsNumber();
+      }
+      break;
+    case parsed::BinarySpecialization::NumberLess:
+      if (numbers) {
+        return left_side.AsNumber() < right_side.AsNumber();
+      }
+      break;
+    case parsed::BinarySpecialization::NumberLessEqual:
+      if (numbers) {
+        return left_side.AsNumber() <= right_side.AsNumber();
+      }
+      break;
+    case parsed::BinarySpecialization::NumberEqual:
+      if (numbers) {
+        return left_side.AsNumber() == right_side.AsNumber();
+      }
+      break;
+    case parsed::BinarySpecialization::NumberNotEqual:
+      if (numbers) {
+        return left_side.AsNumber() != right_side.AsNumber();
+      }
+      break;
+    case parsed::BinarySpecialization::StringConcatenate:
+      if (left_side.IsString() && right_side.IsString()) {
+        return parsed::LamscriptString::Concatenate(
+            left_side.AsObject<parsed::LamscriptString>(),
+            right_side.AsObject<parsed::LamscriptString>());
+      }
+      break;
+    case parsed::BinarySpecialization::Uninitialized:
+      expression->Specialize(
+          parsed::SpecializeBinary(
+              expression->GetOperator().Type, left_side, right_side));
+      return ApplyBinaryOperator(
+          expression->GetOperator(), left_side, right_side);
+    case parsed::BinarySpecialization::Generic:
+      return ApplyBinaryOperator(
+          expression->GetOperator(), left_side, right_side);
   }
 
-  const std::type_info& left_type = left_side.type();
-  const std::type_info& right_type = right_side.type();
+  expression->Specialize(parsed::BinarySpecialization::Generic);
+  return ApplyBinaryOperator(expression->GetOperator(), left_side, right_side);
+}
 
-  switch (expression->GetOperator().Type) {
-    case parsing::MINUS:
-    {
-      return AnyAs<double>(left_side) - AnyAs<double>(right_side);
-    }
-    case parsing::PLUS:
-    {
-      if (left_type == LS_TYPE_NUMBER && right_type == LS_TYPE_NUMBER) {
-        return AnyAs<double>(left_side) + AnyAs<double>(right_side);
-      }
+Value Interpreter::VisitLogicalExpression(parsed::Logical* expression) {
+  Value left_side = Evaluate(expression->GetLeftOperand());
 
-      if (left_type == LS_TYPE_STRING && right_type == LS_TYPE_STRING) {
-        return AnyAs<std::string>(left_side) + AnyAs<std::string>(right_side);
+  switch (expression->GetSpecialization()) {
+    case parsed::LogicalSpecialization::BooleanAnd:
+      if (left_side.IsBoolean()) {
+        return left_side.AsBoolean()
+            ? Evaluate(expression->GetRightOperand()) : left_side;
       }
-
-      throw RuntimeError(
-          expression->GetOperator(),
-          "Operands must be two numbers or strings.");
-    }
-    case parsing::SLASH:
-    {
-      double divisor = AnyAs<double>(right_side);
-      if (divisor == 0) {
-        throw RuntimeError(
-            expression->GetOperator(), "Divide by 0 error.");
+      break;
+    case parsed::LogicalSpecialization::BooleanOr:
+      if (left_side.IsBoolean()) {
+        return left_side.AsBoolean()
+            ? left_side : Evaluate(expression->GetRightOperand());
       }
-
-      return AnyAs<double>(left_side) / divisor;
-    }
-    case parsing::STAR:
-    {
-      return AnyAs<double>(left_side) * AnyAs<double>(right_side);
-    }
-    case parsing::MODULUS:
-    {
-      return fmod(AnyAs<double>(left_side), AnyAs<double>(right_side));
-    }
-    case parsing::GREATER:
-    {
-      return AnyAs<double>(left_side) > AnyAs<double>(right_side);
-    }
-    case parsing::GREATER_EQUAL:
-    {
-      return AnyAs<double>(left_side) >= AnyAs<double>(right_side);
-    }
-    case parsing::LESS:
-    {
-      return AnyAs<double>(left_side) < AnyAs<double>(right_side);
-    }
-    case parsing::LESS_EQUAL:
-    {
-      return AnyAs<double>(left_side) <= AnyAs<double>(right_side);
-    }
-    case parsing::BANG_EQUAL:
-    {
-      return !IsEqual(left_side, right_side);
-    }
-    case parsing::EQUAL_EQUAL:
-    {
-      return IsEqual(left_side, right_side);
-    }
-    default:
-    {
-      return nullptr;
-    }
+      break;
+    case parsed::LogicalSpecialization::Uninitialized:
+      expression->Specialize(
+          parsed::SpecializeLogical(
+              expression->GetLogicalOperator().Type, left_side));
+      return ApplyLogicalOperator(expression, left_side);
+    case parsed::LogicalSpecialization::Generic:
+      return ApplyLogicalOperator(expression, left_side);
   }
-}
 
-std::any Interpreter::VisitLogicalExpression(parsed::Logical* expression) {
-  std::any left_side = Evaluate(expression->GetLeftOperand());
-  bool left_is_truthy = IsTruthy(left_side);
+  expression->Specialize(parsed::LogicalSpecialization::Generic);
+  return ApplyLogicalOperator(expression, left_side);
+}
 
-  if (expression->GetLogicalOperator().Type == parsing::OR) {
-    if (left_is_truthy) {
-      return left_side;
+/// Arguments are evaluated straight onto the top of the value stack, above a
+/// slot that's reserved for the receiver of a method. Functions then use them
+/// in place as the start of their frame.
+///
+/// Calling a method (e.g. `obj.method()`) passes the object straight to the
+/// method as its receiver instead of creating a bound method first.
+Value Interpreter::VisitCallExpression(parsed::Call* expression) {
+  Value callee;
+  Value receiver;
+  const parsed::LamscriptFunction* method = nullptr;
+
+  if (parsed::Get* getter = expression->GetMethodCallee()) {
+    Value object = Evaluate(getter->GetObject().get());
+    method = FindMethod(object, getter->GetName());
+
+    if (method != nullptr) {
+      // Static methods aren't bound to the class they're called on, but the
+      // class is held as the callee so that its methods outlive the call.
+      if (object.IsInstance()) {
+        receiver = std::move(object);
+      } else {
+        callee = std::move(object);
+      }
+    } else {
+      callee = GetProperty(object, getter);
     }
   } else {
-    if (!left_is_truthy) {
-      return left_side;
-    }
+    callee = Evaluate(expression->GetCallee());
   }
+  const auto& argument_expressions = expression->GetArguments();
+  size_t argument_count = argument_expressions.size();
+  size_t call_base = stack_top_;
 
-  return Evaluate(expression->GetRightOperand());
-}
-
-std::any Interpreter::VisitCallExpression(parsed::Call* expression) {
-  std::any callee = Evaluate(expression->GetCallee());
-  std::vector<std::any> arguments;
-
-  for (auto&& argument : expression->GetArguments()) {
-    arguments.push_back(Evaluate(argument.get()));
+  if (argument_count + 1 > kMaxStackSize - stack_top_) {
+    throw StackOverflowError(expression->GetParentheses());
   }
 
-  try {
-    SharedLamscriptCallable callable = AnyAs<SharedLamscriptCallable>(callee);
+  stack_top_ += argument_count + 1;
+  Value result;
 
-    if (callable->Arity() != arguments.size()) {
-      throw RuntimeError(
-          expression->GetParentheses(),
-          "Expected " + std::to_string(callable->Arity())
-              + " arguments but got " + std::to_string(arguments.size()) + ".");
+  try {
+    for (size_t i = 0; i < argument_count; i++) {
+      stack_[call_base + 1 + i] = Evaluate(argument_expressions[i].get());
     }
 
-    return callable->Call(this, arguments);
-  } catch (std::bad_any_cast error) {
-    throw RuntimeError(
+    result = CallWithArguments(
         expression->GetParentheses(),
-        "Can only call functions and classes;");
+        callee,
+        method,
+        receiver,
+        call_base,
+        argument_count);
+  } catch (const RuntimeError&) {
+    TruncateStack(call_base);
+    throw;
   }
+
+  TruncateStack(call_base);
+  return result;
 }
 
-std::any Interpreter::VisitLambdaExpression(
+Value Interpreter::VisitLambdaExpression(
     parsed::LambdaExpression* expression) {
 
   parsed::Function* func(
       static_cast<parsed::Function*>(expression->GetFunctionStatement()));
 
-  Execute(func);
-
-  return environment_->GetVariable(func->GetName());
+  return MakeFunction(func, false);
 }
 
-std::any Interpreter::VisitGetExpression(parsed::Get* getter) {
-  std::any object = Evaluate(getter->GetObject().get());
-
-  if (object.type() == LS_TYPE_CALLABLE) {
-    auto class_def = static_cast<parsed::LamscriptClass*>(
-        AnyAs<SharedLamscriptCallable>(object).get());
-
-    try {
-      auto func = class_def->LookupMethod(getter->GetName().Lexeme);
-
-      if (!func.IsStatic()) {
-        throw RuntimeError(
-            getter->GetName(),
-            "Only instances can access non-static class methods.");
-      }
+Value Interpreter::VisitGetExpression(parsed::Get* getter) {
+  return GetProperty(Evaluate(getter->GetObject().get()), getter);
+}
 
-      if (func.IsGetter()) {
-        return func.Call(this, {{}});
-      }
+Value Interpreter::GetProperty(const Value& object, parsed::Get* getter) {
+  if (parsed::LamscriptClass* class_def = AsClass(object)) {
+    const parsed::LamscriptFunction* func = class_def->LookupMethod(
+        getter->GetName().Identifier);
 
-      return func.Bind(nullptr);
-    } catch (std::out_of_range& err) {
+    if (func == nullptr) {
       throw RuntimeError(
           getter->GetName(), "No static function found on class.");
     }
+
+    if (!func->IsStatic()) {
+      throw RuntimeError(
+          getter->GetName(),
+          "Only instances can access non-static class methods.");
+    }
+
+    if (func->IsGetter()) {
+      return func->Invoke(this, nullptr, {});
+    }
+
+    return func->Bind(nullptr);
   }
 
-  if (object.type() != LS_TYPE_INSTANCE) {
+  if (!object.IsInstance()) {
     throw RuntimeError(
         getter->GetName(), "Only instances have properties.");
   }
 
-  std::any instance_field = AnyAs<SharedLamscriptInstance>(
-      object)->GetField(getter->GetName());
+  parsed::LamscriptInstance* instance =
+      object.AsObject<parsed::LamscriptInstance>();
+  Value instance_field = ReadField(instance, getter);
 
-  if (instance_field.type() == LS_TYPE_CALLABLE) {
-    auto func = static_cast<parsed::LamscriptFunction*>(
-        AnyAs<SharedLamscriptCallable>(instance_field).get());
+  if (instance_field.IsCallable()) {
+    auto func = dynamic_cast<parsed::LamscriptFunction*>(
+        instance_field.AsObject<parsed::LamscriptCallable>());
 
-    if (func->IsGetter()) {
-      return func->Call(this, {{}});
+    if (func != nullptr && func->IsGetter()) {
+      return func->Call(this, {});
     }
   }
 
   return instance_field;
 }
 
-std::any Interpreter::VisitSetExpression(parsed::Set* setter) {
-  std::any object = Evaluate(setter->GetObject().get());
+Value Interpreter::VisitSetExpression(parsed::Set* setter) {
+  Value object = Evaluate(setter->GetObject().get());
 
-  if (object.type() != LS_TYPE_INSTANCE) {
+  if (!object.IsInstance()) {
     throw RuntimeError(setter->GetName(), "Only instances have fields.");
   }
 
-  std::any value = Evaluate(setter->GetValue());
-  AnyAs<SharedLamscriptInstance>(object)->SetField(setter->GetName(), value);
-
+  Value value = Evaluate(setter->GetValue());
+  WriteField(object.AsObject<parsed::LamscriptInstance>(), setter, value);
   return value;
 }
 
-std::any Interpreter::VisitThisExpression(parsed::This* this_expr) {
-  return LookupVariable(this_expr->GetKeyword(), this_expr);
+Value Interpreter::VisitThisExpression(parsed::This* this_expr) {
+  return LookupVariable(this_expr->GetKeyword(), this_expr->GetLocation());
 }
 
-std::any Interpreter::VisitSuperExpression(parsed::Super* super) {
-  size_t distance = locals_.at(super);
-  std::any super_class = environment_->GetVariableAtScope(
-      distance, parsing::Token{parsing::SUPER, "super", nullptr, 0});
-
-  SharedLamscriptClass super_class_def = AnyAs<SharedLamscriptClass>(
-      super_class);
+Value Interpreter::VisitSuperExpression(parsed::Super* super) {
+  Value super_class = LookupVariable(
+      super->GetKeyword(), super->GetLocation());
+  Value instance = Evaluate(super->GetThis());
 
-  std::any instance = environment_->GetVariableAtScope(
-      distance - 1, parsing::Token{parsing::THIS, "this", nullptr, 0});
+  const parsed::LamscriptFunction* method = AsClass(super_class)
+      ->LookupMethod(super->GetMethod().Identifier);
 
-  SharedLamscriptInstance instance_ref = AnyAs<SharedLamscriptInstance>(
-      instance);
-
-  try {
-    parsed::LamscriptFunction method = super_class_def->LookupMethod(
-        super->GetMethod().Lexeme);
-    return method.Bind(instance_ref);
-  } catch (const std::out_of_range& err) {
+  if (method == nullptr) {
     throw RuntimeError(
         super->GetMethod(),
         "Undefined property '" + super->GetMethod().Lexeme + "'.");
   }
+
+  return method->Bind(instance);
 }
 
 // --------------------------------- STATEMENTS --------------------------------
 
-std::any Interpreter::VisitBlockStatement(parsed::Block* statement) {
-  ExecuteBlock(
-      statement->GetStatements(), std::make_shared<Environment>(environment_));
-  return nullptr;
+Completion Interpreter::VisitBlockStatement(parsed::Block* statement) {
+  return ExecuteStatements(statement->GetStatements());
 }
 
-std::any Interpreter::VisitPrintStatement(parsed::Print* statement) {
-  std::any value = Evaluate(statement->GetExpression());
+Completion Interpreter::VisitPrintStatement(parsed::Print* statement) {
+  Value value = Evaluate(statement->GetExpression());
   std::cout << Stringify(value) << std::endl;
-  return nullptr;
+  return Completion::Normal;
 }
 
-std::any Interpreter::VisitExpressionStatement(
+Completion Interpreter::VisitExpressionStatement(
     parsed::ExpressionStatement* statement) {
   Evaluate(statement->GetExpression());
-  return nullptr;
+  return Completion::Normal;
 }
 
-std::any Interpreter::VisitVariableStatement(
+Completion Interpreter::VisitVariableStatement(
     parsed::VariableStatement* statement) {
-  std::any value;
+  Value value;
+  DeclareVariable(statement->GetLocation());
 
   if (statement->GetInitializer() != nullptr) {
     value = Evaluate(statement->GetInitializer());
   }
 
-  environment_->SetVariable(statement->GetName(), value);
-  return nullptr;
+  DefineVariable(statement->GetName(), statement->GetLocation(), value);
+  return Completion::Normal;
 }
 
-std::any Interpreter::VisitIfStatement(parsed::If* statement) {
+Completion Interpreter::VisitIfStatement(parsed::If* statement) {
   if (IsTruthy(Evaluate(statement->GetCondition()))) {
-    Execute(statement->GetThenBranch());
+    return Execute(statement->GetThenBranch());
   } else if (statement->GetElseBranch() != nullptr) {
-    Execute(statement->GetElseBranch());
+    return Execute(statement->GetElseBranch());
   }
 
-  return nullptr;
+  return Completion::Normal;
 }
 
-std::any Interpreter::VisitWhileStatement(parsed::While* statement) {
+Completion Interpreter::VisitWhileStatement(parsed::While* statement) {
   while (IsTruthy(Evaluate(statement->GetCondition()))) {
-    Execute(statement->GetBody());
+    Completion completion = Execute(statement->GetBody());
+
+    if (completion == Completion::Break) {
+      break;
+    }
+
+    if (completion == Completion::Return) {
+      return completion;
+    }
   }
 
-  return nullptr;
+  return Completion::Normal;
 }
 
-std::any Interpreter::VisitFunctionStatement(parsed::Function* statement) {
-  std::shared_ptr<parsed::LamscriptCallable> func(
-      new parsed::LamscriptFunction(
-          std::shared_ptr<parsed::Function>(statement), environment_, false));
-  environment_->SetVariable(statement->GetName(), func);
-  return nullptr;
+Completion Interpreter::VisitFunctionStatement(parsed::Function* statement) {
+  // The variable is declared first so that recursive functions can capture
+  // themselves.
+  DeclareVariable(statement->GetLocation());
+  Value func = MakeFunction(statement, false);
+  DefineVariable(statement->GetName(), statement->GetLocation(), func);
+  return Completion::Normal;
 }
 
-std::any Interpreter::VisitReturnStatement(parsed::Return* statement) {
-  std::any value = nullptr;
+Completion Interpreter::VisitReturnStatement(parsed::Return* statement) {
+  return_value_ = nullptr;
   if (statement->GetValue() != nullptr) {
-    value = Evaluate(statement->GetValue());
+    return_value_ = Evaluate(statement->GetValue());
   }
 
-  throw parsed::LamscriptReturnValue(value);
+  return Completion::Return;
 }
 
 
-std::any Interpreter::VisitClassStatement(parsed::Class* class_def) {
-  std::unordered_map<
-      std::string, parsed::LamscriptFunction> methods;
-
-  std::any super_class;
-  SharedLamscriptClass super_class_def = nullptr;
+Completion Interpreter::VisitClassStatement(parsed::Class* class_def) {
+  Value super_class;
 
   if (class_def->GetSuperClass() != nullptr) {
     super_class = Evaluate(class_def->GetSuperClass());
+  }
 
-    if (super_class.type() == LS_TYPE_CALLABLE) {
-      SharedLamscriptCallable callable = AnyAs<
-          SharedLamscriptCallable>(super_class);
+  DefineClass(class_def, super_class);
+  return Completion::Normal;
+}
 
-      if (auto x = dynamic_cast<parsed::LamscriptClass*>(callable.get())) {
-        super_class_def.reset(x);
-      }
-    } else {
-      throw RuntimeError(
-          class_def->GetName(), "Superclass must be a class.");
-    }
-  }
+void Interpreter::Interpret(
+    const parsed::SharedProgram& program, size_t frame_size) {
+  const parsed::SharedProgram* previous_program = program_;
+  program_ = &program;
 
-  environment_->SetVariable(class_def->GetName(), nullptr);
-  if (super_class_def != nullptr) {
-    environment_ = std::make_shared<Environment>(environment_);
-    environment_->SetVariable(
-        parsing::Token{parsing::SUPER, "super", nullptr, 0}, super_class_def);
-  }
+  size_t previous_base = frame_base_;
+  size_t previous_top = stack_top_;
+  size_t previous_depth = call_depth_;
+  const std::vector<parsed::Ref<Cell>>* previous_upvalues = upvalues_;
 
-  for (auto& method : class_def->GetMethods()) {
-    parsed::LamscriptFunction func(
-        method,
-        environment_,
-        method->GetName().Lexeme.compare("constructor") == 0);
-    methods.insert(std::make_pair(method->GetName().Lexeme, func));
+  if (call_depth_ == 0) {
+    native_stack_base_ = GetNativeStackPointer();
   }
 
-  SharedLamscriptCallable lam_class(
-      new parsed::LamscriptClass(
-          class_def->GetName().Lexeme,
-          super_class_def,
-          std::move(methods)));
+  try {
+    PushFrame(
+        parsing::Token{parsing::IDENTIFIER, "script", nullptr, 0},
+        stack_top_,
+        frame_size);
+
+    for (auto&& statement : *program) {
+      Execute(statement.get());
+    }
 
-  if (super_class_def != nullptr) {
-    environment_ = environment_->GetParentEnvironment();
+    PopFrame(previous_base, previous_top);
+  } catch (const RuntimeError& error) {
+    Lamscript::RuntimeError(error);
+
+    // Errors at the top level skip popping the script's frame, and stack
+    // overflows skip popping every frame above it.
+    TruncateStack(previous_top);
+    frame_base_ = previous_base;
+    call_depth_ = previous_depth;
+    upvalues_ = previous_upvalues;
   }
 
-  environment_->SetVariable(class_def->GetName(), lam_class);
-  return nullptr;
+  program_ = previous_program;
 }
 
 void Interpreter::Interpret(
-    const std::vector<std::unique_ptr<parsed::Statement>>& statements) {
+    const CompiledStatement& compiled_program,
+    const parsed::SharedProgram& program,
+    size_t frame_size) {
+  const parsed::SharedProgram* previous_program = program_;
+  program_ = &program;
+
+  size_t previous_base = frame_base_;
+  size_t previous_top = stack_top_;
+  size_t previous_depth = call_depth_;
+  const std::vector<parsed::Ref<Cell>>* previous_upvalues = upvalues_;
+
+  if (call_depth_ == 0) {
+    native_stack_base_ = GetNativeStackPointer();
+  }
+
   try {
-    for (auto&& statement : statements) {
-      Execute(statement.get());
-    }
+    PushFrame(
+        parsing::Token{parsing::IDENTIFIER, "script", nullptr, 0},
+        stack_top_,
+        frame_size);
+
+    compiled_program(this);
+
+    PopFrame(previous_base, previous_top);
   } catch (const RuntimeError& error) {
     Lamscript::RuntimeError(error);
+
+    TruncateStack(previous_top);
+    frame_base_ = previous_base;
+    call_depth_ = previous_depth;
+    upvalues_ = previous_upvalues;
   }
+
+  program_ = previous_program;
 }
 
-void Interpreter::Execute(parsed::Statement* statement) {
-  statement->Accept(this);
+Completion Interpreter::Execute(parsed::Statement* statement) {
+  return statement->Accept(this);
 }
 
-void Interpreter::ExecuteBlock(
-    const std::vector<std::unique_ptr<parsed::Statement>>& statements,
-    std::shared_ptr<Environment> current_env) {
-  std::shared_ptr<Environment> previous = environment_;
+/// Stops executing the statements as soon as one transfers control (e.g.
+/// returns) and forwards the completion to the enclosing statement. Runtime
+/// errors are reported here, except for stack overflows, which stop the whole
+/// program instead of being reported again by every frame that they unwind.
+Completion Interpreter::ExecuteStatements(
+    const std::vector<std::unique_ptr<parsed::Statement>>& statements) {
+  Completion completion = Completion::Normal;
 
-  // Forwards return value statements up the chain so that function calls that
-  // recurse get their environment reset once the recursion starts unwinding.
   try {
-    environment_ = current_env;
-
     for (auto&& statement : statements) {
-      Execute(statement.get());
+      completion = Execute(statement.get());
+
+      if (completion != Completion::Normal) {
+        break;
+      }
     }
+  } catch (const StackOverflowError&) {
+    throw;
   } catch(const RuntimeError& error) {
     Lamscript::RuntimeError(error);
-  } catch (const parsed::LamscriptReturnValue& returned_value) {
-    environment_ = previous;
-    throw returned_value;
   }
 
-  // Needed to ensure that if no error or return value happens, function calls
-  environment_ = previous;
+  return completion;
+}
+
+Completion Interpreter::ExecuteFrame(
+    parsed::Function* function,
+    const parsed::SharedProgram& program,
+    const std::vector<parsed::Ref<Cell>>& upvalues,
+    const Value& receiver,
+    Arguments arguments) {
+  size_t previous_base = frame_base_;
+  size_t previous_top = stack_top_;
+  size_t first_argument = function->IsMethod() ? 1 : 0;
+
+  // Arguments that end at the top of the stack were pushed by a call
+  // expression, which always leaves a free slot below them for the receiver.
+  const Value* arguments_end = arguments.data() + arguments.size();
+  bool arguments_in_place = !arguments.empty()
+      && arguments_end == stack_.data() + stack_top_;
+
+  if (arguments_in_place) {
+    size_t arguments_base = arguments.data() - stack_.data();
+    PushFrame(
+        function->GetName(),
+        arguments_base - first_argument,
+        function->GetFrameSize());
+  } else {
+    PushFrame(function->GetName(), stack_top_, function->GetFrameSize());
+
+    for (size_t i = 0; i < arguments.size(); i++) {
+      stack_[frame_base_ + first_argument + i] = arguments[i];
+    }
+  }
+
+  if (function->IsMethod()) {
+    stack_[frame_base_] = receiver;
+  }
+
+  const std::vector<parsed::Ref<Cell>>* previous_upvalues = upvalues_;
+  const parsed::SharedProgram* previous_program = program_;
+  upvalues_ = &upvalues;
+  program_ = &program;
+
+  for (size_t slot : function->GetCapturedParameters()) {
+    cells_[frame_base_ + slot] = parsed::MakeRef<Cell>(
+        stack_[frame_base_ + slot]);
+  }
+
+  Completion completion = function->GetCompiledBody()
+      ? function->GetCompiledBody()(this)
+      : ExecuteStatements(function->GetBody());
+
+  upvalues_ = previous_upvalues;
+  program_ = previous_program;
+  PopFrame(previous_base, previous_top);
+  return completion;
 }
 
-void Interpreter::Resolve(parsed::Expression* expression, size_t distance) {
-  locals_[expression] = distance;
+Value Interpreter::TakeReturnValue() {
+  return std::move(return_value_);
 }
 
 // ---------------------------------- PRIVATE ----------------------------------
 
 void Interpreter::CheckNumberOperand(
-    parsing::Token operator_used, std::any operand) {
-  if (operand.type() != LS_TYPE_NUMBER) {
+    const parsing::Token& operator_used, const Value& operand) {
+  if (!operand.IsNumber()) {
     throw RuntimeError(operator_used, "Operand must be a number.");
   }
 }
 
 void Interpreter::CheckNumberOperands(
-    parsing::Token operator_used, std::any left_side, std::any right_side) {
-  if (left_side.type() != LS_TYPE_NUMBER
-      || right_side.type() != LS_TYPE_NUMBER) {
+    const parsing::Token& operator_used,
+    const Value& left_side,
+    const Value& right_side) {
+  if (!left_side.IsNumber() || !right_side.IsNumber()) {
     throw RuntimeError(operator_used, "Operands must both be numbers.");
   }
 }
 
-bool Interpreter::IsTruthy(std::any object) {
-  if (!object.has_value()) {
-    return false;
+bool Interpreter::IsTruthy(const Value& object) {
+  switch (object.GetType()) {
+    case ValueType::Nil:
+      return false;
+    case ValueType::Boolean:
+      return object.AsBoolean();
+    case ValueType::Number:
+      return object.AsNumber() != 0;
+    case ValueType::String:
+      return object.AsObject<parsed::LamscriptString>()->GetLength() != 0;
+    default:
+      return true;
+  }
+}
+
+parsed::LamscriptClass* Interpreter::AsClass(const Value& value) {
+  if (!value.IsCallable()) {
+    return nullptr;
   }
 
-  const std::type_info& type = object.type();
+  return dynamic_cast<parsed::LamscriptClass*>(
+      value.AsObject<parsed::LamscriptCallable>());
+}
+
+const parsed::LamscriptFunction* Interpreter::FindMethod(
+    const Value& object, const parsing::Token& name) {
+  const parsed::LamscriptClass* class_def = AsClass(object);
+  bool is_instance = object.IsInstance();
+
+  if (is_instance) {
+    const parsed::LamscriptInstance* instance =
+        object.AsObject<parsed::LamscriptInstance>();
+
+    if (instance->FindField(name.Identifier) != nullptr) {
+      return nullptr;
+    }
 
-  if (type == LS_TYPE_BOOLEAN) {
-    return AnyAs<bool&>(object);
+    class_def = instance->GetClass();
   }
 
-  if (type == LS_TYPE_NUMBER) {
-    return AnyAs<double&>(object) != 0;
+  if (class_def == nullptr) {
+    return nullptr;
   }
 
-  if (type == LS_TYPE_STRING) {
-    return !AnyAs<std::string&>(object).empty();
+  const parsed::LamscriptFunction* method = class_def->LookupMethod(
+      name.Identifier);
+
+  if (method == nullptr
+      || method->IsGetter()
+      || (!is_instance && !method->IsStatic())) {
+    return nullptr;
   }
 
-  return true;
+  return method;
 }
 
-std::any Interpreter::Evaluate(parsed::Expression* expression) {
-  return expression->Accept(this);
+Value Interpreter::CallWithArguments(
+    const parsing::Token& parentheses,
+    const Value& callee,
+    const parsed::LamscriptFunction* method,
+    const Value& receiver,
+    size_t call_base,
+    size_t argument_count) {
+  if (method == nullptr && !callee.IsCallable()) {
+    throw RuntimeError(parentheses, "Can only call functions and classes;");
+  }
+
+  parsed::LamscriptCallable* callable = method != nullptr
+      ? nullptr : callee.AsObject<parsed::LamscriptCallable>();
+  size_t arity = method != nullptr ? method->Arity() : callable->Arity();
+
+  if (arity != argument_count) {
+    throw RuntimeError(
+        parentheses,
+        "Expected " + std::to_string(arity)
+            + " arguments but got " + std::to_string(argument_count) + ".");
+  }
+
+  Arguments arguments(stack_.data() + call_base + 1, argument_count);
+
+  if (method != nullptr) {
+    return method->Invoke(this, receiver, arguments);
+  }
+
+  return callable->Call(this, arguments);
 }
 
-/// Order of checks follow as:
-/// 1. Are both values null?
-/// 2. Is only the left side null?
-/// 3. Are both values of the same type?
-/// 4. Boolean comparison.
-/// 5. Number comparison.
-/// 6. String comparison.
-bool Interpreter::IsEqual(std::any left_side, std::any right_side) {
-  if (!left_side.has_value() && !right_side.has_value()) {
-    return true;
+void Interpreter::DefineClass(
+    parsed::Class* class_def, const Value& super_class) {
+  parsing::SymbolMap<parsed::Ref<parsed::LamscriptFunction>> methods;
+
+  parsed::Ref<parsed::LamscriptClass> super_class_def = nullptr;
+
+  if (class_def->GetSuperClass() != nullptr) {
+    super_class_def = parsed::Ref<parsed::LamscriptClass>(
+        AsClass(super_class));
+
+    if (super_class_def == nullptr) {
+      throw RuntimeError(
+          class_def->GetName(), "Superclass must be a class.");
+    }
   }
 
-  if (!left_side.has_value()) {
-    return false;
+  // Methods capture the class and super class before they're defined.
+  DeclareVariable(class_def->GetLocation());
+
+  if (super_class_def != nullptr) {
+    DeclareVariable(class_def->GetSuperClassLocation());
+    DefineVariable(
+        parsing::Token{parsing::SUPER, "super", nullptr, 0},
+        class_def->GetSuperClassLocation(),
+        super_class_def);
+  }
+
+  for (auto& method : class_def->GetMethods()) {
+    methods.insert(
+        std::make_pair(
+            method->GetName().Identifier,
+            MakeFunction(
+                method.get(),
+                method->GetName().Lexeme.compare("constructor") == 0)));
+  }
+
+  Value lam_class = parsed::MakeRef<parsed::LamscriptClass>(
+      class_def->GetName().Lexeme,
+      super_class_def,
+      std::move(methods));
+
+  DefineVariable(class_def->GetName(), class_def->GetLocation(), lam_class);
+}
+
+Value Interpreter::ApplyUnaryOperator(
+    const parsing::Token& operator_used, const Value& right_side) {
+  switch (operator_used.Type) {
+    case parsing::BANG:
+      return !IsTruthy(right_side);
+    case parsing::MINUS:
+      CheckNumberOperand(operator_used, right_side);
+      return -right_side.AsNumber();
+    default:
+      return nullptr;
+  }
+}
+
+Value Interpreter::ApplyBinaryOperator(
+    const parsing::Token& expression_operator,
+    const Value& left_side,
+    const Value& right_side) {
+  switch (expression_operator.Type) {
+    case parsing::MINUS:
+    {
+      CheckNumberOperands(expression_operator, left_side, right_side);
+      return left_side.AsNumber() - right_side.AsNumber();
+    }
+    case parsing::PLUS:
+    {
+      if (left_side.IsNumber() && right_side.IsNumber()) {
+        return left_side.AsNumber() + right_side.AsNumber();
+      }
+
+      if (left_side.IsString() && right_side.IsString()) {
+        return parsed::LamscriptString::Concatenate(
+            left_side.AsObject<parsed::LamscriptString>(),
+            right_side.AsObject<parsed::LamscriptString>());
+      }
+
+      throw RuntimeError(
+          expression_operator, "Operands must be two numbers or strings.");
+    }
+    case parsing::SLASH:
+    {
+      CheckNumberOperands(expression_operator, left_side, right_side);
+      double divisor = right_side.AsNumber();
+      if (divisor == 0) {
+        throw RuntimeError(expression_operator, "Divide by 0 error.");
+      }
+
+      return left_side.AsNumber() / divisor;
+    }
+    case parsing::STAR:
+    {
+      CheckNumberOperands(expression_operator, left_side, right_side);
+      return left_side.AsNumber() * right_side.AsNumber();
+    }
+    case parsing::MODULUS:
+    {
+      CheckNumberOperands(expression_operator, left_side, right_side);
+      return fmod(left_side.AsNumber(), right_side.AsNumber());
+    }
+    case parsing::GREATER:
+    {
+      CheckNumberOperands(expression_operator, left_side, right_side);
+      return left_side.AsNumber() > right_side.AsNumber();
+    }
+    case parsing::GREATER_EQUAL:
+    {
+      CheckNumberOperands(expression_operator, left_side, right_side);
+      return left_side.AsNumber() >= right_side.AsNumber();
+    }
+    case parsing::LESS:
+    {
+      CheckNumberOperands(expression_operator, left_side, right_side);
+      return left_side.AsNumber() < right_side.AsNumber();
+    }
+    case parsing::LESS_EQUAL:
+    {
+      CheckNumberOperands(expression_operator, left_side, right_side);
+      return left_side.AsNumber() <= right_side.AsNumber();
+    }
+    case parsing::BANG_EQUAL:
+    {
+      return !IsEqual(left_side, right_side);
+    }
+    case parsing::EQUAL_EQUAL:
+    {
+      return IsEqual(left_side, right_side);
+    }
+    default:
+    {
+      return nullptr;
+    }
+  }
+}
+
+Value Interpreter::ApplyLogicalOperator(
+    parsed::Logical* expression, const Value& left_side) {
+  bool left_is_truthy = IsTruthy(left_side);
+
+  if (expression->GetLogicalOperator().Type == parsing::OR) {
+    if (left_is_truthy) {
+      return left_side;
+    }
+  } else {
+    if (!left_is_truthy) {
+      return left_side;
+    }
   }
 
-  const std::type_info& left_type = left_side.type();
-  const std::type_info& right_type = right_side.type();
+  return Evaluate(expression->GetRightOperand());
+}
 
+Value Interpreter::Evaluate(parsed::Expression* expression) {
+  return expression->Accept(this);
+}
 
-  if (left_type != right_type) {
+/// Values of different types are never equal. Booleans, numbers, and strings
+/// are compared by value while callables and instances are compared by
+/// identity.
+bool Interpreter::IsEqual(const Value& left_side, const Value& right_side) {
+  if (left_side.GetType() != right_side.GetType()) {
     return false;
   }
 
-  if (left_type == LS_TYPE_BOOLEAN) {
-    return AnyAs<bool>(left_side) == AnyAs<bool>(right_side);
+  switch (left_side.GetType()) {
+    case ValueType::Nil:
+      return true;
+    case ValueType::Boolean:
+      return left_side.AsBoolean() == right_side.AsBoolean();
+    case ValueType::Number:
+      return left_side.AsNumber() == right_side.AsNumber();
+    case ValueType::String:
+    {
+      auto left_string = left_side.AsObject<parsed::LamscriptString>();
+      auto right_string = right_side.AsObject<parsed::LamscriptString>();
+
+      if (left_string == right_string) {
+        return true;
+      }
+
+      if (left_string->GetLength() != right_string->GetLength()) {
+        return false;
+      }
+
+      return left_string->GetValue() == right_string->GetValue();
+    }
+    default:
+      return left_side.AsObject<parsed::LamscriptObject>()
+          == right_side.AsObject<parsed::LamscriptObject>();
+  }
+}
+
+std::string Interpreter::Stringify(const Value& object) {
+  switch (object.GetType()) {
+    case ValueType::Nil:
+      return "nil";
+    case ValueType::Boolean:
+      return object.AsBoolean() ? "true" : "false";
+    case ValueType::Number:
+      return std::to_string(object.AsNumber());
+    case ValueType::String:
+      return object.AsString();
+    case ValueType::Callable:
+      return object.AsObject<parsed::LamscriptCallable>()->ToString();
+    case ValueType::Instance:
+      return object.AsObject<parsed::LamscriptInstance>()->ToString();
+  }
+
+  return "nil";
+}
+
+/// Fields that are found are cached by the shape of the instance, so reading
+/// the same field of instances with that shape again is a single comparison.
+Value Interpreter::ReadField(
+    parsed::LamscriptInstance* instance, parsed::Get* getter) {
+  parsed::InlineCache& cache = getter->GetCache();
+  parsed::Shape* shape = instance->GetShape();
+
+  if (const parsed::PropertyCacheEntry* entry = cache.Lookup(shape)) {
+    return instance->GetSlot(entry->Slot);
+  }
+
+  size_t slot = shape->FindSlot(getter->GetName().Identifier);
+  if (slot == parsed::Shape::kNotFound) {
+    // Falls back to binding a method of the class.
+    return instance->GetField(getter->GetName());
   }
 
-  if (left_type == LS_TYPE_NUMBER) {
-    return AnyAs<double&>(left_side) == AnyAs<double&>(right_side);
+  cache.Update(
+      parsed::PropertyCacheEntry{
+          parsed::Ref<parsed::Shape>(shape), nullptr, slot});
+  return instance->GetSlot(slot);
+}
+
+/// Writes that add a field cache the shape that they move instances to, so
+/// that constructors only look up each field the first time they run.
+void Interpreter::WriteField(
+    parsed::LamscriptInstance* instance,
+    parsed::Set* setter,
+    const Value& value) {
+  parsed::InlineCache& cache = setter->GetCache();
+  parsed::Shape* shape = instance->GetShape();
+
+  if (const parsed::PropertyCacheEntry* entry = cache.Lookup(shape)) {
+    if (entry->Transition != nullptr) {
+      instance->AddSlot(entry->Transition.get(), value);
+    } else {
+      instance->SetSlot(entry->Slot, value);
+    }
+    return;
   }
 
-  if (left_type == LS_TYPE_STRING) {
-    return AnyAs<std::string&>(left_side) == AnyAs<std::string&>(right_side);
+  parsing::Symbol name = setter->GetName().Identifier;
+  size_t slot = shape->FindSlot(name);
+
+  if (slot != parsed::Shape::kNotFound) {
+    cache.Update(
+        parsed::PropertyCacheEntry{
+            parsed::Ref<parsed::Shape>(shape), nullptr, slot});
+    instance->SetSlot(slot, value);
+    return;
   }
 
-  return false;
+  parsed::Shape* transition = shape->AddField(name);
+  cache.Update(parsed::PropertyCacheEntry{
+      parsed::Ref<parsed::Shape>(shape),
+      parsed::Ref<parsed::Shape>(transition),
+      shape->GetFieldCount()});
+  instance->AddSlot(transition, value);
 }
 
-std::string Interpreter::Stringify(std::any object) {
-  if (!object.has_value()) {
-    return "nil";
+Value Interpreter::LookupVariable(
+    const parsing::Token& name, const parsed::VariableLocation& location) {
+  switch (location.Storage) {
+    case parsed::VariableStorage::Stack:
+      return stack_[frame_base_ + location.Slot];
+    case parsed::VariableStorage::Cell:
+      return cells_[frame_base_ + location.Slot]->Get();
+    case parsed::VariableStorage::Upvalue:
+      return (*upvalues_)[location.Slot]->Get();
+    case parsed::VariableStorage::Global:
+      break;
   }
 
-  const std::type_info& type = object.type();
+  return globals_->GetVariable(name);
+}
 
-  if (type == LS_TYPE_BOOLEAN) {
-    return AnyAs<bool&>(object) ? "true" : "false";
+void Interpreter::AssignVariable(
+    const parsing::Token& name,
+    const parsed::VariableLocation& location,
+    const Value& value) {
+  switch (location.Storage) {
+    case parsed::VariableStorage::Stack:
+      stack_[frame_base_ + location.Slot] = value;
+      break;
+    case parsed::VariableStorage::Cell:
+      cells_[frame_base_ + location.Slot]->Set(value);
+      break;
+    case parsed::VariableStorage::Upvalue:
+      (*upvalues_)[location.Slot]->Set(value);
+      break;
+    case parsed::VariableStorage::Global:
+      globals_->AssignVariable(name, value);
+      break;
   }
+}
 
-  if (type == LS_TYPE_NUMBER) {
-    return std::to_string(AnyAs<double&>(object));
+/// Captured variables get a fresh cell every time their declaration runs, so
+/// closures created in different iterations of a loop don't share variables.
+void Interpreter::DeclareVariable(const parsed::VariableLocation& location) {
+  if (location.Storage == parsed::VariableStorage::Cell) {
+    cells_[frame_base_ + location.Slot] = parsed::MakeRef<Cell>();
   }
+}
 
-  if (type == LS_TYPE_CALLABLE) {
-    return AnyAs<SharedLamscriptCallable>(object)->ToString();
+void Interpreter::DefineVariable(
+    const parsing::Token& name,
+    const parsed::VariableLocation& location,
+    const Value& value) {
+  if (location.Storage == parsed::VariableStorage::Global) {
+    globals_->SetVariable(name, value);
+    return;
   }
 
-  if (type == LS_TYPE_CLASS) {
-    return AnyAs<SharedLamscriptClass>(object)->ToString();
+  AssignVariable(name, location, value);
+}
+
+void Interpreter::PushFrame(
+    const parsing::Token& name, size_t frame_base, size_t frame_size) {
+  if (call_depth_ == kMaxCallDepth
+      || frame_size > kMaxStackSize - frame_base
+      || native_stack_base_ - GetNativeStackPointer() > native_stack_limit_) {
+    throw StackOverflowError(name);
   }
 
-  if (type == LS_TYPE_INSTANCE) {
-    return AnyAs<SharedLamscriptInstance>(object)->ToString();
+  call_depth_ += 1;
+  frame_base_ = frame_base;
+  stack_top_ = std::max(stack_top_, frame_base + frame_size);
+}
+
+/// Frames are cleared once they're popped so that values and cells aren't kept
+/// alive by slots that are no longer in use.
+void Interpreter::PopFrame(size_t previous_base, size_t previous_top) {
+  TruncateStack(frame_base_);
+  stack_top_ = previous_top;
+  frame_base_ = previous_base;
+  call_depth_ -= 1;
+}
+
+void Interpreter::TruncateStack(size_t new_top) {
+  for (size_t slot = new_top; slot < stack_top_; slot++) {
+    stack_[slot] = nullptr;
+    cells_[slot] = nullptr;
   }
 
-  return AnyAs<std::string>(object);
+  stack_top_ = new_top;
 }
 
-std::any Interpreter::LookupVariable(
-    const parsing::Token& name, parsed::Expression* expression) {
-  try {
-    size_t& distance = locals_.at(expression);
-    return environment_->GetVariableAtScope(distance, name);
-  } catch (const std::out_of_range& error) {
-    return globals_->GetVariable(name);
+/// Closures only hold onto the cells of the variables they reference. Cells
+/// from the enclosing function's frame are captured directly while cells from
+/// further out are shared through the enclosing function's own upvalues.
+std::vector<parsed::Ref<Cell>> Interpreter::CaptureUpvalues(
+    parsed::Function* function) {
+  const std::vector<parsed::UpvalueMetadata>& metadata =
+      function->GetUpvalues();
+  std::vector<parsed::Ref<Cell>> upvalues;
+  upvalues.reserve(metadata.size());
+
+  for (const parsed::UpvalueMetadata& upvalue : metadata) {
+    if (upvalue.IsLocal) {
+      upvalues.push_back(cells_[frame_base_ + upvalue.Index]);
+    } else {
+      upvalues.push_back((*upvalues_)[upvalue.Index]);
+    }
   }
+
+  return upvalues;
+}
+
+parsed::Ref<parsed::LamscriptFunction> Interpreter::MakeFunction(
+    parsed::Function* declaration, bool is_initializer) {
+  return parsed::MakeRef<parsed::LamscriptFunction>(
+      declaration, *program_, CaptureUpvalues(declaration), is_initializer);
 }
 
 }  // namespace runtime
@@ -1,18 +1,29 @@
 #ifndef SRC_LAMSCRIPT_RUNTIME_INTERPRETER_H_
 #define SRC_LAMSCRIPT_RUNTIME_INTERPRETER_H_
 
-#include <any>
+#include <cstdint>
 #include <memory>
+#include <string>
 #include <unordered_map>
-#include <typeinfo>
 
 #include <Lamscript/Visitor.h>
 #include <Lamscript/errors/RuntimeError.h>
 #include <Lamscript/parsed/Expression.h>
 #include <Lamscript/parsed/Statement.h>
+#include <Lamscript/runtime/Cell.h>
+#include <Lamscript/runtime/CompiledCode.h>
+#include <Lamscript/runtime/Completion.h>
 #include <Lamscript/runtime/Environment.h>
+#include <Lamscript/runtime/Value.h>
 
 namespace lamscript {
+
+namespace parsed {
+class LamscriptClass;
+class LamscriptFunction;
+class LamscriptInstance;
+}  // namespace parsed
+
 namespace runtime {
 
 class Interpreter : ExpressionVisitor, StatementVisitor {
@@ -20,33 +31,33 @@ class Interpreter : ExpressionVisitor, StatementVisitor {
   Interpreter();
   // Implemented Expressions.
 
-  std::any VisitAssignExpression(parsed::Assign* expression) override;
-  std::any VisitLiteralExpression(parsed::Literal* expression) override;
-  std::any VisitGroupingExpression(parsed::Grouping* expression) override;
-  std::any VisitUnaryExpression(parsed::Unary* expression) override;
-  std::any VisitBinaryExpression(parsed::Binary* expression) override;
-  std::any VisitVariableExpression(parsed::Variable* expression) override;
-  std::any VisitLogicalExpression(parsed::Logical* expression) override;
-  std::any VisitCallExpression(parsed::Call* expression) override;
-  std::any VisitLambdaExpression(parsed::LambdaExpression* expression) override;
-  std::any VisitGetExpression(parsed::Get* getter) override;
-  std::any VisitSetExpression(parsed::Set* setter) override;
-  std::any VisitThisExpression(parsed::This* this_expr) override;
-  std::any VisitSuperExpression(parsed::Super* expression) override;
+  Value VisitAssignExpression(parsed::Assign* expression) override;
+  Value VisitLiteralExpression(parsed::Literal* expression) override;
+  Value VisitGroupingExpression(parsed::Grouping* expression) override;
+  Value VisitUnaryExpression(parsed::Unary* expression) override;
+  Value VisitBinaryExpression(parsed::Binary* expression) override;
+  Value VisitVariableExpression(parsed::Variable* expression) override;
+  Value VisitLogicalExpression(parsed::Logical* expression) override;
+  Value VisitCallExpression(parsed::Call* expression) override;
+  Value VisitLambdaExpression(parsed::LambdaExpression* expression) override;
+  Value VisitGetExpression(parsed::Get* getter) override;
+  Value VisitSetExpression(parsed::Set* setter) override;
+  Value VisitThisExpression(parsed::This* this_expr) override;
+  Value VisitSuperExpression(parsed::Super* expression) override;
 
   // Implemented Statements
 
-  std::any VisitBlockStatement(parsed::Block* statement) override;
-  std::any VisitExpressionStatement(
+  Completion VisitBlockStatement(parsed::Block* statement) override;
+  Completion VisitExpressionStatement(
       parsed::ExpressionStatement* statement) override;
-  std::any VisitPrintStatement(parsed::Print* statement) override;
-  std::any VisitVariableStatement(
+  Completion VisitPrintStatement(parsed::Print* statement) override;
+  Completion VisitVariableStatement(
       parsed::VariableStatement* statement) override;
-  std::any VisitIfStatement(parsed::If* statement) override;
-  std::any VisitWhileStatement(parsed::While* statement) override;
-  std::any VisitFunctionStatement(parsed::Function* statement) override;
-  std::any VisitReturnStatement(parsed::Return* statement) override;
-  std::any VisitClassStatement(parsed::Class* statement) override;
+  Completion VisitIfStatement(parsed::If* statement) override;
+  Completion VisitWhileStatement(parsed::While* statement) override;
+  Completion VisitFunctionStatement(parsed::Function* statement) override;
+  Completion VisitReturnStatement(parsed::Return* statement) override;
+  Completion VisitClassStatement(parsed::Class* statement) override;
 
   /// @todo (C3NZ) Implement the rest of the visitor pattern.
 
@@ -54,44 +65,190 @@ class Interpreter : ExpressionVisitor, StatementVisitor {
   // Statements
   // Primary external API
 
+  /// @brief Interprets a program. Variables declared within the blocks of
+  /// top level code are stored in a frame of frame_size slots.
+  void Interpret(const parsed::SharedProgram& program, size_t frame_size);
+
+  /// @brief Runs a program compiled by the ClosureCompiler from the
+  /// statements of program. Variables declared within the blocks of top level
+  /// code are stored in a frame of frame_size slots.
   void Interpret(
+      const CompiledStatement& compiled_program,
+      const parsed::SharedProgram& program,
+      size_t frame_size);
+
+  Completion Execute(parsed::Statement* statement);
+
+  /// @brief Executes statements within the current call frame.
+  Completion ExecuteStatements(
       const std::vector<std::unique_ptr<parsed::Statement>>& statements);
-  void Execute(parsed::Statement* statement);
-  void ExecuteBlock(
-      const std::vector<std::unique_ptr<parsed::Statement>>& statements,
-      std::shared_ptr<Environment> current_env);
 
-  void Resolve(parsed::Expression* expression, size_t distance);
+  /// @brief Executes the body of a function within a new frame on the value
+  /// stack. Methods store the instance they're bound to in the first slot of
+  /// the frame, followed by the arguments. Arguments that were evaluated onto
+  /// the top of the stack by a call expression become part of the frame
+  /// without being copied. Functions that have been compiled run their
+  /// compiled body instead of walking their statements. Functions created by
+  /// the body hold onto the program that the function was parsed from.
+  Completion ExecuteFrame(
+      parsed::Function* function,
+      const parsed::SharedProgram& program,
+      const std::vector<parsed::Ref<Cell>>& upvalues,
+      const Value& receiver,
+      Arguments arguments);
+
+  /// @brief Takes the value of the last executed return statement, leaving nil
+  /// in its place.
+  Value TakeReturnValue();
 
   std::shared_ptr<Environment> GetGlobalEnvironment() { return globals_; }
-  std::shared_ptr<Environment> GetCurrentEnvironment() { return environment_; }
+
+  /// @brief Evaluates if an object is truthy or not.
+  static bool IsTruthy(const Value& object);
+
+  /// @brief Check to see if two values are equal.
+  static bool IsEqual(const Value& left_side, const Value& right_side);
 
  private:
+  /// @brief Compiled code reads and writes the interpreter's state directly.
+  friend class ClosureCompiler;
+
   std::shared_ptr<Environment> globals_;
-  std::shared_ptr<Environment> environment_;
-  std::unordered_map<parsed::Expression*, size_t> locals_;
+  Value return_value_;
+
+  /// @brief Stores the parameters and locals of every call frame. Slots of
+  /// captured variables store their cell in cells_ at the same index. The
+  /// stacks never grow, so references to slots stay valid.
+  std::vector<Value> stack_;
+  std::vector<parsed::Ref<Cell>> cells_;
+  size_t stack_top_;
+  size_t frame_base_;
+  size_t call_depth_;
+
+  /// @brief Calls recurse on the native stack, so frames are only pushed
+  /// while less than native_stack_limit_ bytes of it are used past
+  /// native_stack_base_, where the outermost program started running.
+  uintptr_t native_stack_base_;
+  size_t native_stack_limit_;
+
+  /// @brief The upvalues of the closure that's currently running.
+  const std::vector<parsed::Ref<Cell>>* upvalues_;
+
+  /// @brief The program that the running code was parsed from.
+  const parsed::SharedProgram* program_;
+
+  /// @brief Makes the frame_size slots starting at frame_base the current
+  /// frame, growing the stack to fit them.
+  void PushFrame(
+      const parsing::Token& name, size_t frame_base, size_t frame_size);
+
+  /// @brief Clears the slots of the current frame and returns to the frame
+  /// with the given base and stack top.
+  void PopFrame(size_t previous_base, size_t previous_top);
+
+  /// @brief Clears every slot above new_top and shrinks the stack to it.
+  void TruncateStack(size_t new_top);
+
+  /// @brief Captures the upvalues of a closure being created from the
+  /// function.
+  std::vector<parsed::Ref<Cell>> CaptureUpvalues(parsed::Function* function);
+
+  /// @brief Creates a closure of the declaration that holds onto the program
+  /// that's running.
+  parsed::Ref<parsed::LamscriptFunction> MakeFunction(
+      parsed::Function* declaration, bool is_initializer);
 
   /// @brief Validates that a unary operand is indeed a number.
-  void CheckNumberOperand(parsing::Token operator_used, std::any operand);
+  void CheckNumberOperand(
+      const parsing::Token& operator_used, const Value& operand);
 
   /// @brief Validates that binary operands are indeed both numbers.
   void CheckNumberOperands(
-      parsing::Token operator_used, std::any left_side, std::any right_side);
+      const parsing::Token& operator_used,
+      const Value& left_side,
+      const Value& right_side);
 
-  /// @brief Evaluates if an object is truthy or not.
-  bool IsTruthy(std::any object);
+  /// @brief Applies a unary operator to an operand of any type.
+  Value ApplyUnaryOperator(
+      const parsing::Token& operator_used, const Value& right_side);
+
+  /// @brief Applies a binary operator to operands of any type.
+  Value ApplyBinaryOperator(
+      const parsing::Token& expression_operator,
+      const Value& left_side,
+      const Value& right_side);
+
+  /// @brief Finishes evaluating a logical expression with a left operand of
+  /// any type.
+  Value ApplyLogicalOperator(
+      parsed::Logical* expression, const Value& left_side);
+
+  /// @brief Gets the class a value refers to, or a nullptr if the value isn't
+  /// a class.
+  static parsed::LamscriptClass* AsClass(const Value& value);
+
+  /// @brief Finds the method that calling the named property of an object
+  /// would invoke, or a nullptr if the property has to be evaluated as a value
+  /// first (e.g. fields, getters, and missing properties).
+  static const parsed::LamscriptFunction* FindMethod(
+      const Value& object, const parsing::Token& name);
+
+  /// @brief Calls a callee (or a method of the receiver) with the
+  /// argument_count arguments that have been evaluated onto the stack above
+  /// call_base.
+  Value CallWithArguments(
+      const parsing::Token& parentheses,
+      const Value& callee,
+      const parsed::LamscriptFunction* method,
+      const Value& receiver,
+      size_t call_base,
+      size_t argument_count);
+
+  /// @brief Creates and defines a class, with the already evaluated super
+  /// class if the class has one.
+  void DefineClass(parsed::Class* class_def, const Value& super_class);
 
   /// @brief Evaluate a given expression.
-  std::any Evaluate(parsed::Expression* expression);
+  Value Evaluate(parsed::Expression* expression);
 
-  /// @brief Check to see if two values are equal.
-  bool IsEqual(std::any left_side, std::any right_side);
+  /// @brief Gets the value of a property of an already evaluated object.
+  Value GetProperty(const Value& object, parsed::Get* getter);
+
+  /// @brief Reads a field of an instance through the getter's inline cache,
+  /// binding a method of the instance's class if it has no such field.
+  Value ReadField(parsed::LamscriptInstance* instance, parsed::Get* getter);
+
+  /// @brief Writes a field of an instance through the setter's inline cache.
+  void WriteField(
+      parsed::LamscriptInstance* instance,
+      parsed::Set* setter,
+      const Value& value);
 
   /// @brief Stringify any given interpreted object.
-  std::string Stringify(std::any value);
+  std::string Stringify(const Value& value);
+
+  /// @brief Looks up a variable at the location that the resolver found it
+  /// at.
+  Value LookupVariable(
+      const parsing::Token& name, const parsed::VariableLocation& location);
+
+  /// @brief Assigns a value to the variable at the location that the
+  /// resolver found it at.
+  void AssignVariable(
+      const parsing::Token& name,
+      const parsed::VariableLocation& location,
+      const Value& value);
+
+  /// @brief Prepares the storage of a variable that's about to be declared,
+  /// giving captured variables a new cell.
+  void DeclareVariable(const parsed::VariableLocation& location);
 
-  std::any LookupVariable(
-      const parsing::Token& name, parsed::Expression* expression);
+  /// @brief Defines a variable at the location that the resolver declared it
+  /// at. Only the global environment keeps track of variables by name.
+  void DefineVariable(
+      const parsing::Token& name,
+      const parsed::VariableLocation& location,
+      const Value& value);
 };
 
 }  // namespace runtime
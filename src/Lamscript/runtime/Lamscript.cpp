@@ -1,12 +1,13 @@
 #include <Lamscript/runtime/Lamscript.h>
 
-#include <any>
 #include <memory>
 
 #include <Lamscript/errors/RuntimeError.h>
+#include <Lamscript/parsing/Optimizer.h>
 #include <Lamscript/parsing/Parser.h>
 #include <Lamscript/parsing/Resolver.h>
 #include <Lamscript/parsing/Scanner.h>
+#include <Lamscript/runtime/ClosureCompiler.h>
 #include <Lamscript/util/Logger.h>
 
 namespace lamscript {
@@ -19,35 +20,77 @@ bool Lamscript::had_error_ = false;
 
 bool Lamscript::had_runtime_error_ = false;
 
+bool Lamscript::optimizations_enabled_ = true;
+
+ExecutionEngine Lamscript::execution_engine_ = ExecutionEngine::TreeWalker;
+
 /// @brief Run the given source.
 ProgramResult Lamscript::Run(const std::string& source) {
+  had_runtime_error_ = false;
+  ParsedProgram program;
+  ProgramResult result = Parse(source, &program);
+
+  if (result.Status != ProgramStatus::Success) {
+    return result;
+  }
+
+  // Functions created by the program hold onto its statements, which are
+  // freed once neither they nor the interpreter need them anymore.
+  parsed::SharedProgram statements = std::make_shared<
+      const std::vector<std::unique_ptr<parsed::Statement>>>(
+          std::move(program.Statements));
+
+  if (execution_engine_ == ExecutionEngine::ClosureCompiler) {
+    ClosureCompiler compiler = ClosureCompiler();
+    CompiledStatement compiled_program = compiler.CompileProgram(*statements);
+    interpreter_->Interpret(compiled_program, statements, program.FrameSize);
+  } else {
+    interpreter_->Interpret(statements, program.FrameSize);
+  }
+
+  if (had_runtime_error_) {
+    return ProgramResult{
+        ProgramStatus::FailedAtInterpeter, 70, "Failed to run the program."};
+  }
+
+  return ProgramResult{ProgramStatus::Success, 0};
+}
+
+ProgramResult Lamscript::Parse(
+    const std::string& source, ParsedProgram* program) {
+  // Compilers that report errors through Error leave the flag set.
+  had_error_ = false;
   parsing::Scanner scanner = parsing::Scanner(source);
   std::vector<parsing::Token> tokens = scanner.ScanTokens();
 
   LAMSCRIPT_TRACE("Finished scanning tokens.")
 
   parsing::Parser parser = parsing::Parser(tokens);
-  std::vector<std::unique_ptr<parsed::Statement>> statements = parser.Parse();
+  program->Statements = parser.Parse();
 
   if (had_error_) {
     had_error_ = false;
-    return ProgramResult{ProgramStatus::FailedAtParser, 65};
+    return ProgramResult{
+        ProgramStatus::FailedAtParser, 65, "Failed to parse the program."};
   }
 
-  parsing::Resolver resolver = parsing::Resolver(interpreter_);
-  resolver.Resolve(statements);
+  parsing::Resolver resolver = parsing::Resolver();
+  resolver.Resolve(program->Statements);
 
   if (had_error_) {
     had_error_ = false;
-    return ProgramResult{ProgramStatus::FailedAtResolver, 65};
+    return ProgramResult{
+        ProgramStatus::FailedAtResolver,
+        65,
+        "Failed to resolve the program."};
   }
 
-  interpreter_->Interpret(statements);
-
-  if (had_runtime_error_) {
-    return ProgramResult{ProgramStatus::FailedAtInterpeter, 70};
+  if (optimizations_enabled_) {
+    parsing::Optimizer optimizer = parsing::Optimizer();
+    optimizer.Optimize(&program->Statements);
   }
 
+  program->FrameSize = resolver.GetFrameSize();
   return ProgramResult{ProgramStatus::Success, 0};
 }
 
@@ -64,7 +107,10 @@ ProgramResult Lamscript::RunFile(const std::string& file_path)  {
     source_file.seekg(0, std::ios::beg);
     source_file.read(&source_code[0], source_code.size());
   } else {
-    return ProgramResult{ProgramStatus::FailedAtReadingFile, 1};
+    return ProgramResult{
+        ProgramStatus::FailedAtReadingFile,
+        1,
+        "Failed to read the file " + file_path + "."};
   }
 
   return Run(source_code);
@@ -4,10 +4,13 @@
 #include <fstream>
 #include <ios>
 #include <iostream>
+#include <memory>
 #include <vector>
 
 #include <Lamscript/errors/RuntimeError.h>
+#include <Lamscript/parsed/Statement.h>
 #include <Lamscript/parsing/Token.h>
+#include <Lamscript/runtime/CompiledCode.h>
 #include <Lamscript/runtime/Interpreter.h>
 
 namespace lamscript {
@@ -27,12 +30,28 @@ enum class ProgramStatus {
 struct ProgramResult{
   ProgramStatus Status;
   int ReturnCode;
-  std::string Message;
+  /// @brief Describes why the program failed, or is empty if it succeeded.
+  std::string Message = "";
+};
+
+/// @brief A program that has been parsed, resolved, and optimized, ready for
+/// an engine to run.
+struct ParsedProgram {
+  std::vector<std::unique_ptr<parsed::Statement>> Statements;
+  /// @brief The number of slots needed to store the variables declared in
+  /// blocks of the top level code.
+  size_t FrameSize;
 };
 
 class Lamscript {
  public:
   static ProgramResult Run(const std::string& source);
+
+  /// @brief Runs the front end (scanner, parser, resolver, and optimizer) on
+  /// the source without running it. Errors are reported as they're found and
+  /// are returned as a failed result.
+  static ProgramResult Parse(const std::string& source, ParsedProgram* program);
+
   static ProgramResult RunFile(const std::string& file_path);
   static ProgramResult RunPrompt();
   static void Error(int line, const std::string& message);
@@ -40,9 +59,24 @@ class Lamscript {
   static void RuntimeError(lamscript::RuntimeError error);
   static void Report(
       int line, const std::string& where, const std::string& message);
+
+  /// @brief Toggles the optimization pass that runs on programs after they're
+  /// resolved. Enabled by default.
+  static void SetOptimizationsEnabled(bool enabled) {
+    optimizations_enabled_ = enabled;
+  }
+
+  /// @brief Selects the engine that runs programs. Programs are run by the
+  /// tree walker by default.
+  static void SetExecutionEngine(ExecutionEngine engine) {
+    execution_engine_ = engine;
+  }
+
  private:
   static std::shared_ptr<Interpreter> interpreter_;
   static bool had_error_, had_runtime_error_;
+  static bool optimizations_enabled_;
+  static ExecutionEngine execution_engine_;
 };
 
 }  // namespace runtime
@@ -0,0 +1,150 @@
+#ifndef SRC_LAMSCRIPT_RUNTIME_VALUE_H_
+#define SRC_LAMSCRIPT_RUNTIME_VALUE_H_
+
+#include <cstddef>
+#include <cstdint>
+#include <span>
+#include <string>
+#include <utility>
+
+#include <Lamscript/parsed/LamscriptObject.h>
+#include <Lamscript/parsed/LamscriptString.h>
+
+namespace lamscript {
+namespace runtime {
+
+/// @brief The kinds of values that lamscript programs can produce.
+enum class ValueType : std::uint8_t {
+  Nil,
+  Boolean,
+  Number,
+  String,
+  Callable,
+  Instance
+};
+
+/// @brief A lamscript value.
+///
+/// Values are a 16 byte tagged union. Booleans and numbers are stored inline
+/// while strings, callables, and instances are stored as a pointer to their
+/// reference counted heap object. Copying a value never copies the object
+/// that it points to.
+class Value {
+ public:
+  Value() : type_(ValueType::Nil), bits_(0) {}
+  Value(std::nullptr_t) : Value() {}  // NOLINT(runtime/explicit)
+  Value(bool boolean)  // NOLINT(runtime/explicit)
+      : type_(ValueType::Boolean), boolean_(boolean) {}
+  Value(double number)  // NOLINT(runtime/explicit)
+      : type_(ValueType::Number), number_(number) {}
+
+  /// @brief Allocates a new string object to hold the given string.
+  Value(const std::string& string)  // NOLINT(runtime/explicit)
+      : Value(new parsed::LamscriptString(string)) {}
+
+  Value(parsed::LamscriptString* string)  // NOLINT(runtime/explicit)
+      : type_(ValueType::String), object_(string) {
+    Retain();
+  }
+
+  /// @brief Wraps a heap allocated callable or instance. The type of the value
+  /// is determined by the objects kValueType.
+  template<class ObjectType>
+  Value(ObjectType* object)  // NOLINT(runtime/explicit)
+      : type_(object == nullptr ? ValueType::Nil : ObjectType::kValueType),
+      object_(object) {
+    Retain();
+  }
+
+  template<class ObjectType>
+  Value(const parsed::Ref<ObjectType>& object)  // NOLINT(runtime/explicit)
+      : Value(object.get()) {}
+
+  Value(const Value& other) : type_(other.type_), bits_(other.bits_) {
+    Retain();
+  }
+
+  Value(Value&& other) : type_(other.type_), bits_(other.bits_) {
+    other.type_ = ValueType::Nil;
+  }
+
+  ~Value() {
+    Release();
+  }
+
+  Value& operator=(const Value& other) {
+    Value copy(other);
+    Swap(copy);
+    return *this;
+  }
+
+  Value& operator=(Value&& other) {
+    Value moved(std::move(other));
+    Swap(moved);
+    return *this;
+  }
+
+  ValueType GetType() const { return type_; }
+
+  bool IsNil() const { return type_ == ValueType::Nil; }
+  bool IsBoolean() const { return type_ == ValueType::Boolean; }
+  bool IsNumber() const { return type_ == ValueType::Number; }
+  bool IsString() const { return type_ == ValueType::String; }
+  bool IsCallable() const { return type_ == ValueType::Callable; }
+  bool IsInstance() const { return type_ == ValueType::Instance; }
+
+  /// @brief Checks if the value points to a heap allocated object.
+  bool IsObject() const { return type_ >= ValueType::String; }
+
+  bool AsBoolean() const { return boolean_; }
+  double AsNumber() const { return number_; }
+
+  const std::string& AsString() const {
+    return static_cast<parsed::LamscriptString*>(object_)->GetValue();
+  }
+
+  /// @brief Gets the heap object the value points to as the given type. The
+  /// caller is responsible for checking the type of the value first.
+  template<class ObjectType>
+  ObjectType* AsObject() const {
+    return static_cast<ObjectType*>(object_);
+  }
+
+ private:
+  ValueType type_;
+  union {
+    bool boolean_;
+    double number_;
+    parsed::LamscriptObject* object_;
+    std::uint64_t bits_;
+  };
+
+  void Retain() {
+    if (IsObject()) {
+      object_->Retain();
+    }
+  }
+
+  void Release() {
+    if (IsObject()) {
+      object_->Release();
+    }
+  }
+
+  void Swap(Value& other) {
+    std::swap(type_, other.type_);
+    std::swap(bits_, other.bits_);
+  }
+};
+
+static_assert(sizeof(Value) == 16, "Values must stay 16 bytes.");
+
+/// @brief A view over the arguments of a call. The values are owned by the
+/// caller (usually the interpreter's value stack) and are only valid for the
+/// duration of the call.
+using Arguments = std::span<const Value>;
+
+}  // namespace runtime
+}  // namespace lamscript
+
+#endif  // SRC_LAMSCRIPT_RUNTIME_VALUE_H_
@@ -1,26 +1,123 @@
-#include <Lamscripten/core/Common.h>
-#include <Lamscripten/core/Chunk.h>
-#include <Lamscripten/core/Types.h>
+#include <cstdint>
+#include <cstring>
+#include <fstream>
+#include <iostream>
+#include <memory>
+#include <string>
 
+#include <Lamscript/runtime/Lamscript.h>
+#include <Lamscripten/cache/BytecodeCache.h>
+#include <Lamscripten/compiler/Compiler.h>
+#include <Lamscripten/compiler/RegisterCompiler.h>
+#include <Lamscripten/core/Function.h>
 #include <Lamscripten/util/Debug.h>
+#include <Lamscripten/vm/VirtualMachine.h>
 
-using lamscripten::core::OpCode;
-using lamscripten::core::DynamicArray;
+using lamscript::runtime::Lamscript;
+using lamscript::runtime::ParsedProgram;
+using lamscript::runtime::ProgramResult;
+using lamscript::runtime::ProgramStatus;
 
 int main(int argc, const char* argv[]) {
-  lamscripten::core::Chunk chunk;
-  size_t _ = chunk.WriteOpCode(OpCode::Return);
+  bool disassemble = false;
+  bool use_registers = false;
+  bool use_cache = false;
 
-  auto location = static_cast<uint8_t>(chunk.AddConstant(1.2));
+  while (argc > 2 && strncmp(argv[1], "--", 2) == 0) {
+    if (strcmp(argv[1], "--disassemble") == 0) {
+      disassemble = true;
+    } else if (strcmp(argv[1], "--registers") == 0) {
+      use_registers = true;
+    } else if (strcmp(argv[1], "--cache") == 0) {
+      use_cache = true;
+    } else {
+      break;
+    }
 
-  chunk.WriteOpCode(OpCode::Constant);
-  chunk.WriteBytes({location});
+    argv++;
+    argc--;
+  }
 
-  lamscripten::core::DynamicArray<int> int_array;
-  _ = int_array.PushMemory(20);
-  int val = int_array.Pop().value_or(222);
-  int val2 = int_array.Pop().value_or(5000);
+  if (argc != 2) {
+    std::cout
+        << "Usage: lamscripten [--disassemble] [--registers] [--cache] [script]"
+        << std::endl;
+    return 64;
+  }
 
-  lamscripten::util::DisassembleChunk(chunk, "Disassembled opcode chunk");
-  return 0;
+  std::ifstream source_file(argv[1], std::ios::in | std::ios::binary);
+
+  if (!source_file) {
+    std::cout << "Couldn't read " << argv[1] << std::endl;
+    return 1;
+  }
+
+  std::string source_code(
+      (std::istreambuf_iterator<char>(source_file)),
+      std::istreambuf_iterator<char>());
+
+  lamscripten::core::InstructionSet instruction_set = use_registers
+      ? lamscripten::core::InstructionSet::Register
+      : lamscripten::core::InstructionSet::Stack;
+  uint64_t source_hash = lamscripten::cache::HashSource(source_code);
+  std::string cache_path = lamscripten::cache::GetCachePath(argv[1]);
+  lamscripten::core::Ref<lamscripten::core::Function> script;
+
+  // Scripts that haven't changed since they were cached skip the front end
+  // and the compiler entirely.
+  if (use_cache) {
+    script = lamscripten::cache::LoadCache(
+        cache_path, source_hash, instruction_set);
+  }
+
+  if (script.get() == nullptr) {
+    // Lamscripten reuses lamscript's front end and compiles the resolved
+    // program into bytecode.
+    ParsedProgram program;
+    ProgramResult result = Lamscript::Parse(source_code, &program);
+
+    if (result.Status != ProgramStatus::Success) {
+      return result.ReturnCode;
+    }
+
+    // Both backends compile the same resolved program, so the instruction
+    // sets can be compared on the same scripts.
+    bool had_compile_error;
+
+    if (use_registers) {
+      lamscripten::compiler::RegisterCompiler compiler;
+      script = compiler.Compile(program.Statements, program.FrameSize);
+      had_compile_error = compiler.HadError();
+    } else {
+      lamscripten::compiler::Compiler compiler;
+      script = compiler.Compile(program.Statements, program.FrameSize);
+      had_compile_error = compiler.HadError();
+    }
+
+    if (had_compile_error) {
+      return 65;
+    }
+
+    // Failing to write the cache only costs the next run a compile.
+    if (use_cache) {
+      lamscripten::cache::WriteCache(cache_path, source_hash, *script);
+    }
+  }
+
+  if (disassemble) {
+    lamscripten::util::DisassembleFunction(*script);
+    return 0;
+  }
+
+  auto machine = std::make_unique<lamscripten::vm::VirtualMachine>();
+  lamscripten::vm::InterpretResult interpret_result =
+      machine->Interpret(script);
+
+#ifdef LAMSCRIPTEN_COUNT_DISPATCHES
+  std::cerr
+      << "Dispatched " << machine->GetDispatchCount() << " instructions."
+      << std::endl;
+#endif
+
+  return interpret_result == lamscripten::vm::InterpretResult::Ok ? 0 : 70;
 }
@@ -0,0 +1,461 @@
+#include <Lamscripten/cache/BytecodeCache.h>
+
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+#include <cstdio>
+#include <cstring>
+#include <fstream>
+#include <memory>
+#include <string>
+#include <string_view>
+#include <utility>
+#include <vector>
+
+#include <Lamscript/parsed/LamscriptString.h>
+#include <Lamscript/parsed/Statement.h>
+#include <Lamscript/parsing/Symbol.h>
+
+namespace lamscripten::cache {
+
+using lamscript::parsed::LamscriptString;
+
+// ---------------------------------- INTERNAL ---------------------------------
+
+namespace {
+
+constexpr char kMagic[4] = {'L', 'S', 'C', '\0'};
+
+/// @brief Files are written in the byte order of the machine that writes
+/// them, so a file from a machine with a different byte order reads this
+/// back swapped and is treated as a miss.
+constexpr uint16_t kByteOrderMark = 0x0102;
+
+/// @brief FNV-1a, which is plenty to tell edits of a script apart and to
+/// catch files that were corrupted after they were written.
+uint64_t Hash(std::string_view bytes) {
+  uint64_t hash = 14695981039346656037ull;
+
+  for (char byte : bytes) {
+    hash ^= static_cast<uint8_t>(byte);
+    hash *= 1099511628211ull;
+  }
+
+  return hash;
+}
+
+enum class ConstantTag : uint8_t {
+  Nil,
+  Boolean,
+  Number,
+  String,
+  Function
+};
+
+/// @brief Serializes values into the buffer of a cache file.
+class Writer {
+ public:
+  template<class Type>
+  void Put(Type value) {
+    buffer_.append(reinterpret_cast<const char*>(&value), sizeof(Type));
+  }
+
+  void PutString(const std::string& value) {
+    Put<uint32_t>(static_cast<uint32_t>(value.size()));
+    buffer_.append(value);
+  }
+
+  void PutBytes(const uint8_t* bytes, size_t count) {
+    buffer_.append(reinterpret_cast<const char*>(bytes), count);
+  }
+
+  [[nodiscard]] const std::string& GetBuffer() const { return buffer_; }
+
+ private:
+  std::string buffer_;
+};
+
+/// @brief Deserializes values out of a mapped cache file. Reads past the end
+/// of the file fail the reader instead of reading out of bounds.
+class Reader {
+ public:
+  Reader(const uint8_t* data, size_t size)
+      : data_(data), size_(size), offset_(0), failed_(false) {}
+
+  template<class Type>
+  [[nodiscard]] Type Get() {
+    Type value{};
+
+    if (Reserve(sizeof(Type))) {
+      std::memcpy(&value, data_ + offset_, sizeof(Type));
+      offset_ += sizeof(Type);
+    }
+
+    return value;
+  }
+
+  [[nodiscard]] std::string GetString() {
+    uint32_t length = Get<uint32_t>();
+
+    if (!Reserve(length)) {
+      return "";
+    }
+
+    std::string value(reinterpret_cast<const char*>(data_ + offset_), length);
+    offset_ += length;
+    return value;
+  }
+
+  /// @brief Gets the number of elements that follow, failing if there
+  /// aren't enough bytes left for them so that corrupt files can't request
+  /// huge allocations.
+  [[nodiscard]] uint32_t GetCount() {
+    uint32_t count = Get<uint32_t>();
+
+    if (!Reserve(count)) {
+      return 0;
+    }
+
+    return count;
+  }
+
+  /// @brief Gets a pointer to bytes that are stored in place in the file.
+  [[nodiscard]] const uint8_t* GetBytes(size_t count) {
+    if (!Reserve(count)) {
+      return nullptr;
+    }
+
+    const uint8_t* bytes = data_ + offset_;
+    offset_ += count;
+    return bytes;
+  }
+
+  /// @brief Gets the bytes that haven't been read yet without reading them.
+  [[nodiscard]] std::string_view PeekRemaining() const {
+    return std::string_view(
+        reinterpret_cast<const char*>(data_ + offset_), size_ - offset_);
+  }
+
+  [[nodiscard]] bool Failed() const { return failed_; }
+
+ private:
+  const uint8_t* data_;
+  size_t size_;
+  size_t offset_;
+  bool failed_;
+
+  bool Reserve(size_t size) {
+    if (failed_ || size > size_ - offset_) {
+      failed_ = true;
+    }
+
+    return !failed_;
+  }
+};
+
+/// @brief Writes the header of a cache file, which ends with the checksum
+/// of the body that follows it.
+void WriteHeader(
+    Writer* writer,
+    uint64_t source_hash,
+    core::InstructionSet set,
+    const std::string& body) {
+  for (char byte : kMagic) {
+    writer->Put<char>(byte);
+  }
+
+  writer->Put<uint32_t>(kCacheFormatVersion);
+  writer->Put<uint16_t>(kByteOrderMark);
+  writer->Put<uint16_t>(static_cast<uint16_t>(set));
+  writer->Put<uint64_t>(source_hash);
+  writer->Put<uint64_t>(Hash(body));
+}
+
+/// @brief Code is run straight out of the file, so the body is checked
+/// against its checksum before anything in it is trusted.
+bool ReadHeader(
+    Reader* reader, uint64_t source_hash, core::InstructionSet set) {
+  for (char byte : kMagic) {
+    if (reader->Get<char>() != byte) {
+      return false;
+    }
+  }
+
+  return reader->Get<uint32_t>() == kCacheFormatVersion
+      && reader->Get<uint16_t>() == kByteOrderMark
+      && reader->Get<uint16_t>() == static_cast<uint16_t>(set)
+      && reader->Get<uint64_t>() == source_hash
+      && reader->Get<uint64_t>() == Hash(reader->PeekRemaining())
+      && !reader->Failed();
+}
+
+/// @brief Writes a function followed by its chunk. Prototypes in the
+/// constant pool are written in place.
+void WriteFunction(Writer* writer, const core::Function& function) {
+  writer->PutString(function.GetName());
+  writer->Put<int32_t>(function.GetArity());
+  writer->Put<uint64_t>(function.GetFrameSize());
+  writer->Put<uint64_t>(function.GetStackDepth());
+  writer->Put<uint8_t>(function.IsStatic());
+  writer->Put<uint8_t>(function.IsMethod());
+  writer->Put<uint8_t>(function.IsGetter());
+  writer->Put<uint8_t>(function.IsInitializer());
+
+  writer->Put<uint32_t>(static_cast<uint32_t>(function.GetUpvalues().size()));
+  for (const auto& upvalue : function.GetUpvalues()) {
+    writer->Put<uint8_t>(upvalue.IsLocal);
+    writer->Put<uint64_t>(upvalue.Index);
+  }
+
+  const std::vector<size_t>& captured = function.GetCapturedParameters();
+  writer->Put<uint32_t>(static_cast<uint32_t>(captured.size()));
+  for (size_t slot : captured) {
+    writer->Put<uint64_t>(slot);
+  }
+
+  const core::Chunk& chunk = function.GetChunk();
+  writer->Put<uint32_t>(
+      static_cast<uint32_t>(chunk.GetErrorHandlers().GetCount()));
+  for (const core::ErrorHandler& handler : chunk.GetErrorHandlers()) {
+    writer->Put<uint64_t>(handler.Start);
+    writer->Put<uint64_t>(handler.End);
+    writer->Put<uint64_t>(handler.Target);
+  }
+
+  writer->Put<uint32_t>(static_cast<uint32_t>(chunk.GetLineRuns().GetCount()));
+  for (const core::LineRun& run : chunk.GetLineRuns()) {
+    writer->Put<uint64_t>(run.Start);
+    writer->Put<uint64_t>(run.Line);
+  }
+
+  std::vector<std::string> names;
+  for (size_t i = 0; chunk.GetNameAt(i).has_value(); i++) {
+    names.push_back(chunk.GetNameAt(i)->GetName());
+  }
+
+  writer->Put<uint32_t>(static_cast<uint32_t>(names.size()));
+  for (const std::string& name : names) {
+    writer->PutString(name);
+  }
+
+  writer->Put<uint32_t>(static_cast<uint32_t>(chunk.GetConstantCount()));
+  for (size_t i = 0; i < chunk.GetConstantCount(); i++) {
+    core::Value constant = chunk.GetConstantAt(i).value();
+
+    if (constant.IsBoolean()) {
+      writer->Put<ConstantTag>(ConstantTag::Boolean);
+      writer->Put<uint8_t>(constant.AsBoolean());
+    } else if (constant.IsNumber()) {
+      writer->Put<ConstantTag>(ConstantTag::Number);
+      writer->Put<double>(constant.AsNumber());
+    } else if (constant.IsString()) {
+      writer->Put<ConstantTag>(ConstantTag::String);
+      writer->PutString(constant.AsString());
+    } else if (constant.IsCallable()
+        && constant.AsObject<core::Object>()->GetKind()
+            == core::ObjectKind::Function) {
+      writer->Put<ConstantTag>(ConstantTag::Function);
+      WriteFunction(writer, *constant.AsObject<core::Function>());
+    } else {
+      writer->Put<ConstantTag>(ConstantTag::Nil);
+    }
+  }
+
+  writer->Put<uint64_t>(chunk.GetOpCodeCount());
+  writer->PutBytes(chunk.GetCode(), chunk.GetOpCodeCount());
+}
+
+core::Ref<core::Function> ReadFunction(
+    Reader* reader,
+    core::InstructionSet set,
+    const std::shared_ptr<const void>& mapping) {
+  std::string name = reader->GetString();
+  int32_t arity = reader->Get<int32_t>();
+  uint64_t frame_size = reader->Get<uint64_t>();
+  uint64_t stack_depth = reader->Get<uint64_t>();
+  lamscript::parsed::FunctionMetadata metadata{
+      reader->Get<uint8_t>() != 0,
+      reader->Get<uint8_t>() != 0,
+      reader->Get<uint8_t>() != 0};
+  bool is_initializer = reader->Get<uint8_t>() != 0;
+
+  core::Ref<core::Function> function =
+      lamscript::parsed::MakeRef<core::Function>(
+          std::move(name), arity, frame_size, metadata, is_initializer, set);
+  function->SetStackDepth(stack_depth);
+
+  std::vector<lamscript::parsed::UpvalueMetadata> upvalues(
+      reader->GetCount());
+  for (auto& upvalue : upvalues) {
+    upvalue.IsLocal = reader->Get<uint8_t>() != 0;
+    upvalue.Index = reader->Get<uint64_t>();
+  }
+  function->SetUpvalues(std::move(upvalues));
+
+  std::vector<size_t> captured(reader->GetCount());
+  for (size_t& slot : captured) {
+    slot = reader->Get<uint64_t>();
+  }
+  function->SetCapturedParameters(std::move(captured));
+
+  core::Chunk* chunk = function->GetChunk();
+  uint32_t handler_count = reader->GetCount();
+  for (uint32_t i = 0; i < handler_count && !reader->Failed(); i++) {
+    core::ErrorHandler handler;
+    handler.Start = reader->Get<uint64_t>();
+    handler.End = reader->Get<uint64_t>();
+    handler.Target = reader->Get<uint64_t>();
+    chunk->AddErrorHandler(handler);
+  }
+
+  uint32_t run_count = reader->GetCount();
+  for (uint32_t i = 0; i < run_count && !reader->Failed(); i++) {
+    core::LineRun run;
+    run.Start = reader->Get<uint64_t>();
+    run.Line = reader->Get<uint64_t>();
+    chunk->AddLineRun(run);
+  }
+
+  uint32_t name_count = reader->GetCount();
+  for (uint32_t i = 0; i < name_count && !reader->Failed(); i++) {
+    static_cast<void>(chunk->AddName(
+        lamscript::parsing::Symbol::Intern(reader->GetString())));
+  }
+
+  uint32_t constant_count = reader->GetCount();
+  for (uint32_t i = 0; i < constant_count && !reader->Failed(); i++) {
+    core::Value constant = nullptr;
+
+    switch (reader->Get<ConstantTag>()) {
+      case ConstantTag::Nil:
+        break;
+      case ConstantTag::Boolean:
+        constant = reader->Get<uint8_t>() != 0;
+        break;
+      case ConstantTag::Number:
+        constant = reader->Get<double>();
+        break;
+      case ConstantTag::String:
+        constant = lamscript::parsed::MakeRef<LamscriptString>(
+            reader->GetString());
+        break;
+      case ConstantTag::Function:
+        constant = ReadFunction(reader, set, mapping);
+        break;
+    }
+
+    static_cast<void>(chunk->AddConstant(constant));
+  }
+
+  uint64_t code_count = reader->Get<uint64_t>();
+  const uint8_t* code = reader->GetBytes(code_count);
+
+  if (code != nullptr) {
+    chunk->AdoptCode(code, code_count, mapping);
+  }
+
+  return function;
+}
+
+}  // namespace
+
+// ---------------------------------- PUBLIC -----------------------------------
+
+uint64_t HashSource(std::string_view source) {
+  return Hash(source);
+}
+
+std::string GetCachePath(const std::string& script_path) {
+  if (script_path.size() >= 3
+      && script_path.compare(script_path.size() - 3, 3, ".ls") == 0) {
+    return script_path + "c";
+  }
+
+  return script_path + ".lsc";
+}
+
+bool WriteCache(
+    const std::string& path,
+    uint64_t source_hash,
+    const core::Function& script) {
+  Writer body;
+  WriteFunction(&body, script);
+
+  Writer writer;
+  WriteHeader(
+      &writer,
+      source_hash,
+      script.GetChunk().GetInstructionSet(),
+      body.GetBuffer());
+  writer.PutBytes(
+      reinterpret_cast<const uint8_t*>(body.GetBuffer().data()),
+      body.GetBuffer().size());
+
+  std::string temporary_path = path + "." + std::to_string(getpid());
+  std::ofstream file(temporary_path, std::ios::out | std::ios::binary);
+
+  if (!file) {
+    return false;
+  }
+
+  file.write(writer.GetBuffer().data(), writer.GetBuffer().size());
+  file.close();
+
+  if (!file || std::rename(temporary_path.c_str(), path.c_str()) != 0) {
+    std::remove(temporary_path.c_str());
+    return false;
+  }
+
+  return true;
+}
+
+core::Ref<core::Function> LoadCache(
+    const std::string& path,
+    uint64_t source_hash,
+    core::InstructionSet instruction_set) {
+  int descriptor = open(path.c_str(), O_RDONLY);
+
+  if (descriptor < 0) {
+    return nullptr;
+  }
+
+  struct stat status;
+  void* data = MAP_FAILED;
+
+  if (fstat(descriptor, &status) == 0 && status.st_size > 0) {
+    data = mmap(
+        nullptr, status.st_size, PROT_READ, MAP_PRIVATE, descriptor, 0);
+  }
+
+  // The mapping stays valid after the descriptor is closed.
+  close(descriptor);
+
+  if (data == MAP_FAILED) {
+    return nullptr;
+  }
+
+  size_t size = static_cast<size_t>(status.st_size);
+  std::shared_ptr<const void> mapping(
+      data, [size](const void* mapped) {
+        munmap(const_cast<void*>(mapped), size);
+      });
+
+  Reader reader(static_cast<const uint8_t*>(data), size);
+
+  if (!ReadHeader(&reader, source_hash, instruction_set)) {
+    return nullptr;
+  }
+
+  core::Ref<core::Function> script = ReadFunction(
+      &reader, instruction_set, mapping);
+
+  if (reader.Failed()) {
+    return nullptr;
+  }
+
+  return script;
+}
+
+}  // namespace lamscripten::cache
@@ -0,0 +1,47 @@
+#ifndef SRC_LAMSCRIPTEN_CACHE_BYTECODECACHE_H_
+#define SRC_LAMSCRIPTEN_CACHE_BYTECODECACHE_H_
+
+#include <cstdint>
+#include <string>
+#include <string_view>
+
+#include <Lamscripten/core/Chunk.h>
+#include <Lamscripten/core/Function.h>
+#include <Lamscripten/core/Value.h>
+
+namespace lamscripten::cache {
+
+/// @brief Bumped whenever the layout of cache files or the encoding of
+/// either instruction set changes, which invalidates every existing cache
+/// file.
+constexpr uint32_t kCacheFormatVersion = 8;
+
+/// @brief Hashes the source of a script to key its cache file with.
+[[nodiscard]] uint64_t HashSource(std::string_view source);
+
+/// @brief Gets the path of the cache file of the script at the path.
+[[nodiscard]] std::string GetCachePath(const std::string& script_path);
+
+/// @brief Writes a compiled script and every function declared within it to
+/// a cache file. The file is written next to its final path and then moved
+/// over it, so processes that load it concurrently never see a partial
+/// file. Returns false if the file couldn't be written.
+bool WriteCache(
+    const std::string& path,
+    uint64_t source_hash,
+    const core::Function& script);
+
+/// @brief Loads a compiled script from a cache file by mapping it into
+/// memory. The code of every chunk is run straight out of the mapping, which
+/// stays mapped for as long as any of the functions are alive. Returns a
+/// nullptr if the file doesn't exist, was compiled from a different source
+/// or into a different instruction set, doesn't match its checksum, or can't
+/// be read.
+[[nodiscard]] core::Ref<core::Function> LoadCache(
+    const std::string& path,
+    uint64_t source_hash,
+    core::InstructionSet instruction_set);
+
+}  // namespace lamscripten::cache
+
+#endif  // SRC_LAMSCRIPTEN_CACHE_BYTECODECACHE_H_
@@ -0,0 +1,626 @@
+#include <Lamscripten/compiler/Compiler.h>
+
+#include <algorithm>
+#include <cstddef>
+#include <limits>
+#include <memory>
+#include <string>
+#include <vector>
+
+#include <Lamscript/parsed/LamscriptString.h>
+#include <Lamscript/runtime/Lamscript.h>
+
+namespace lamscripten::compiler {
+
+using lamscript::runtime::Completion;
+using lamscripten::core::OpCode;
+using lamscripten::core::Ref;
+using lamscripten::core::Value;
+
+namespace parsed = lamscript::parsed;
+namespace parsing = lamscript::parsing;
+
+// ---------------------------------- PUBLIC -----------------------------------
+
+/// Errors in top level statements stop the program, so the script doesn't
+/// register a handler for them.
+Ref<core::Function> Compiler::Compile(
+    const std::vector<std::unique_ptr<parsed::Statement>>& statements,
+    size_t frame_size) {
+  Ref<core::Function> script;
+  bool long_jumps = false;
+
+  do {
+    script = parsed::MakeRef<core::Function>(
+        "script", 0, frame_size, parsed::FunctionMetadata{false, false, false},
+        false);
+    PushFunction(script.get(), long_jumps);
+
+    for (auto&& statement : statements) {
+      Compile(statement.get());
+    }
+
+    Emit(OpCode::Nil);
+    Emit(OpCode::Return);
+    long_jumps = PopFunction();
+  } while (long_jumps);
+
+  return script;
+}
+
+// --------------------------------- EXPRESSIONS -------------------------------
+
+Value Compiler::VisitAssignExpression(parsed::Assign* assignment) {
+  Compile(assignment->GetValue());
+  SetLine(assignment->GetName());
+  EmitStore(assignment->GetName(), assignment->GetLocation());
+  return nullptr;
+}
+
+Value Compiler::VisitBinaryExpression(parsed::Binary* binary) {
+  Compile(binary->GetLeftSide());
+  Compile(binary->GetRightSide());
+  SetLine(binary->GetOperator());
+
+  switch (binary->GetOperator().Type) {
+    case parsing::PLUS: Emit(OpCode::Add); break;
+    case parsing::MINUS: Emit(OpCode::Subtract); break;
+    case parsing::STAR: Emit(OpCode::Multiply); break;
+    case parsing::SLASH: Emit(OpCode::Divide); break;
+    case parsing::MODULUS: Emit(OpCode::Modulus); break;
+    case parsing::GREATER: Emit(OpCode::Greater); break;
+    case parsing::GREATER_EQUAL: Emit(OpCode::GreaterEqual); break;
+    case parsing::LESS: Emit(OpCode::Less); break;
+    case parsing::LESS_EQUAL: Emit(OpCode::LessEqual); break;
+    case parsing::EQUAL_EQUAL: Emit(OpCode::Equal); break;
+    case parsing::BANG_EQUAL: Emit(OpCode::NotEqual); break;
+    default:
+      Emit(OpCode::Pop);
+      Emit(OpCode::Pop);
+      Emit(OpCode::Nil);
+      break;
+  }
+
+  return nullptr;
+}
+
+/// Calls to methods of an object are compiled into Invoke, which calls the
+/// method without binding it to the object first.
+Value Compiler::VisitCallExpression(parsed::Call* call) {
+  parsed::Get* getter = call->GetMethodCallee();
+
+  if (getter != nullptr) {
+    Compile(getter->GetObject().get());
+  } else {
+    Compile(call->GetCallee());
+  }
+
+  for (auto&& argument : call->GetArguments()) {
+    Compile(argument.get());
+  }
+
+  uint8_t argument_count = MakeOperand(
+      call->GetArguments().size(), "Too many arguments in call.");
+  SetLine(call->GetParentheses());
+
+  if (getter != nullptr) {
+    EmitIndexed(
+        OpCode::Invoke, MakeName(getter->GetName()), {argument_count});
+  } else {
+    Emit(OpCode::Call, argument_count);
+  }
+
+  AdjustStackDepth(-static_cast<ptrdiff_t>(argument_count));
+
+  return nullptr;
+}
+
+Value Compiler::VisitGetExpression(parsed::Get* getter) {
+  Compile(getter->GetObject().get());
+  SetLine(getter->GetName());
+  EmitIndexed(OpCode::GetProperty, MakeName(getter->GetName()));
+  return nullptr;
+}
+
+Value Compiler::VisitGroupingExpression(parsed::Grouping* grouping) {
+  Compile(grouping->GetExpression());
+  return nullptr;
+}
+
+Value Compiler::VisitLiteralExpression(parsed::Literal* literal) {
+  const Value& value = literal->GetValue();
+
+  if (value.IsNil()) {
+    Emit(OpCode::Nil);
+  } else if (value.IsBoolean()) {
+    Emit(value.AsBoolean() ? OpCode::True : OpCode::False);
+  } else {
+    EmitIndexed(OpCode::Constant, MakeConstant(value));
+  }
+
+  return nullptr;
+}
+
+/// The left operand is left on the stack as the result when it short circuits
+/// the expression, and popped otherwise.
+Value Compiler::VisitLogicalExpression(parsed::Logical* logical) {
+  Compile(logical->GetLeftOperand());
+
+  PendingJump short_circuit = EmitJump(
+      logical->GetLogicalOperator().Type == parsing::OR
+          ? OpCode::JumpIfTrue : OpCode::JumpIfFalse);
+  Emit(OpCode::Pop);
+  Compile(logical->GetRightOperand());
+  PatchJump(short_circuit);
+  return nullptr;
+}
+
+Value Compiler::VisitSetExpression(parsed::Set* setter) {
+  Compile(setter->GetObject().get());
+  Compile(setter->GetValue());
+  SetLine(setter->GetName());
+  EmitIndexed(OpCode::SetProperty, MakeName(setter->GetName()));
+  return nullptr;
+}
+
+Value Compiler::VisitSuperExpression(parsed::Super* super) {
+  EmitLoad(super->GetKeyword(), super->GetLocation());
+  Compile(super->GetThis());
+  SetLine(super->GetMethod());
+  EmitIndexed(OpCode::GetSuper, MakeName(super->GetMethod()));
+  return nullptr;
+}
+
+Value Compiler::VisitThisExpression(parsed::This* this_expr) {
+  EmitLoad(this_expr->GetKeyword(), this_expr->GetLocation());
+  return nullptr;
+}
+
+Value Compiler::VisitUnaryExpression(parsed::Unary* unary) {
+  Compile(unary->GetRightExpression());
+  SetLine(unary->GetUnaryOperator());
+
+  switch (unary->GetUnaryOperator().Type) {
+    case parsing::BANG: Emit(OpCode::Not); break;
+    case parsing::MINUS: Emit(OpCode::Negate); break;
+    default:
+      Emit(OpCode::Pop);
+      Emit(OpCode::Nil);
+      break;
+  }
+
+  return nullptr;
+}
+
+Value Compiler::VisitVariableExpression(parsed::Variable* variable) {
+  SetLine(variable->GetName());
+  EmitLoad(variable->GetName(), variable->GetLocation());
+  return nullptr;
+}
+
+Value Compiler::VisitLambdaExpression(parsed::LambdaExpression* expression) {
+  parsed::Function* function = static_cast<parsed::Function*>(
+      expression->GetFunctionStatement());
+  Ref<core::Function> prototype = CompileFunction(function, false);
+  EmitIndexed(OpCode::Closure, MakeConstant(prototype));
+  return nullptr;
+}
+
+// --------------------------------- STATEMENTS --------------------------------
+
+Completion Compiler::VisitBlockStatement(parsed::Block* block) {
+  CompileHandledStatements(block->GetStatements());
+  return Completion::Normal;
+}
+
+/// The class and super class are declared before the methods are created so
+/// that the methods can capture them. The super class is loaded back onto the
+/// stack underneath the methods for Class to inherit from.
+Completion Compiler::VisitClassStatement(parsed::Class* class_def) {
+  bool has_super_class = class_def->GetSuperClass() != nullptr;
+
+  if (has_super_class) {
+    const parsed::VariableLocation& super_location =
+        class_def->GetSuperClassLocation();
+    parsing::Token super_name{parsing::SUPER, "super", nullptr, 0};
+
+    EmitDeclare(super_location);
+    Compile(class_def->GetSuperClass());
+    EmitDefine(super_name, super_location);
+    EmitDeclare(class_def->GetLocation());
+    EmitLoad(super_name, super_location);
+  } else {
+    EmitDeclare(class_def->GetLocation());
+  }
+
+  for (auto& method : class_def->GetMethods()) {
+    Ref<core::Function> prototype = CompileFunction(
+        method.get(), method->GetName().Lexeme.compare("constructor") == 0);
+    EmitIndexed(OpCode::Closure, MakeConstant(prototype));
+  }
+
+  // Class pops the methods and super class before it pushes the class.
+  AdjustStackDepth(
+      -static_cast<ptrdiff_t>(
+          class_def->GetMethods().size() + (has_super_class ? 1 : 0)));
+  SetLine(class_def->GetName());
+  EmitIndexed(
+      OpCode::Class,
+      MakeConstant(
+          parsed::MakeRef<parsed::LamscriptString>(
+              class_def->GetName().Lexeme)),
+      {static_cast<uint8_t>(has_super_class ? 1 : 0)});
+  size_t _ = CurrentChunk()->WriteShort(
+      MakeShortOperand(class_def->GetMethods().size(), "Too many methods."));
+  EmitDefine(class_def->GetName(), class_def->GetLocation());
+  return Completion::Normal;
+}
+
+Completion Compiler::VisitExpressionStatement(
+    parsed::ExpressionStatement* statement) {
+  Compile(statement->GetExpression());
+  Emit(OpCode::Pop);
+  return Completion::Normal;
+}
+
+/// The variable is declared before the closure is created so that recursive
+/// functions can capture themselves.
+Completion Compiler::VisitFunctionStatement(parsed::Function* func) {
+  EmitDeclare(func->GetLocation());
+  Ref<core::Function> prototype = CompileFunction(func, false);
+  EmitIndexed(OpCode::Closure, MakeConstant(prototype));
+  EmitDefine(func->GetName(), func->GetLocation());
+  return Completion::Normal;
+}
+
+Completion Compiler::VisitIfStatement(parsed::If* if_statement) {
+  Compile(if_statement->GetCondition());
+
+  PendingJump else_jump = EmitJump(OpCode::JumpIfFalse);
+  Emit(OpCode::Pop);
+  Compile(if_statement->GetThenBranch());
+
+  PendingJump end_jump = EmitJump(OpCode::Jump);
+  PatchJump(else_jump);
+  Emit(OpCode::Pop);
+
+  if (if_statement->GetElseBranch() != nullptr) {
+    Compile(if_statement->GetElseBranch());
+  }
+
+  PatchJump(end_jump);
+  return Completion::Normal;
+}
+
+Completion Compiler::VisitPrintStatement(parsed::Print* print) {
+  Compile(print->GetExpression());
+  Emit(OpCode::Print);
+  return Completion::Normal;
+}
+
+/// Returning from an initializer returns its receiver, which methods keep in
+/// slot 0.
+Completion Compiler::VisitReturnStatement(parsed::Return* return_statement) {
+  if (return_statement->GetValue() != nullptr) {
+    Compile(return_statement->GetValue());
+  } else {
+    Emit(OpCode::Nil);
+  }
+
+  SetLine(return_statement->GetKeyword());
+
+  if (functions_.back().Function->IsInitializer()) {
+    Emit(OpCode::Pop);
+    Emit(OpCode::GetLocal, 0);
+  }
+
+  Emit(OpCode::Return);
+  return Completion::Normal;
+}
+
+/// Captured variables get a fresh cell every time their declaration runs, so
+/// the cell is created before the initializer is evaluated.
+Completion Compiler::VisitVariableStatement(
+    parsed::VariableStatement* variable) {
+  EmitDeclare(variable->GetLocation());
+
+  if (variable->GetInitializer() != nullptr) {
+    Compile(variable->GetInitializer());
+  } else {
+    Emit(OpCode::Nil);
+  }
+
+  SetLine(variable->GetName());
+  EmitDefine(variable->GetName(), variable->GetLocation());
+  return Completion::Normal;
+}
+
+Completion Compiler::VisitWhileStatement(parsed::While* while_statement) {
+  size_t loop_start = CurrentChunk()->GetOpCodeCount();
+  Compile(while_statement->GetCondition());
+
+  PendingJump exit_jump = EmitJump(OpCode::JumpIfFalse);
+  Emit(OpCode::Pop);
+  Compile(while_statement->GetBody());
+  EmitLoop(loop_start);
+
+  PatchJump(exit_jump);
+  Emit(OpCode::Pop);
+  return Completion::Normal;
+}
+
+// ---------------------------------- PRIVATE ----------------------------------
+
+core::Chunk* Compiler::CurrentChunk() {
+  return functions_.back().Function->GetChunk();
+}
+
+void Compiler::Compile(parsed::Expression* expression) {
+  expression->Accept(this);
+}
+
+void Compiler::Compile(parsed::Statement* statement) {
+  statement->Accept(this);
+}
+
+void Compiler::CompileHandledStatements(
+    const std::vector<std::unique_ptr<parsed::Statement>>& statements) {
+  size_t start = CurrentChunk()->GetOpCodeCount();
+
+  for (auto&& statement : statements) {
+    Compile(statement.get());
+  }
+
+  size_t end = CurrentChunk()->GetOpCodeCount();
+
+  if (start != end) {
+    CurrentChunk()->AddErrorHandler(core::ErrorHandler{start, end, end});
+  }
+}
+
+/// Functions that finish without returning return nil, which is also where
+/// errors within the body resume.
+Ref<core::Function> Compiler::CompileFunction(
+    parsed::Function* declaration, bool is_initializer) {
+  Ref<core::Function> function;
+  bool long_jumps = false;
+
+  do {
+    function = parsed::MakeRef<core::Function>(
+        declaration->GetName().Lexeme,
+        static_cast<int>(declaration->GetParams().size()),
+        declaration->GetFrameSize(),
+        parsed::FunctionMetadata{
+            declaration->IsStatic(),
+            declaration->IsMethod(),
+            declaration->IsGetter()},
+        is_initializer);
+    function->SetUpvalues(declaration->GetUpvalues());
+    function->SetCapturedParameters(declaration->GetCapturedParameters());
+
+    PushFunction(function.get(), long_jumps);
+    SetLine(declaration->GetName());
+    CompileHandledStatements(declaration->GetBody());
+
+    Emit(OpCode::Nil);
+    Emit(OpCode::Return);
+    long_jumps = PopFunction();
+  } while (long_jumps);
+
+  return function;
+}
+
+void Compiler::PushFunction(core::Function* function, bool long_jumps) {
+  functions_.push_back(FunctionState{
+      function, 1, 0, 0, long_jumps, false, false, had_error_});
+  had_error_ = false;
+}
+
+/// Other errors are reported the first time that the function is compiled,
+/// so it's only compiled again when its jumps are the only problem.
+bool Compiler::PopFunction() {
+  FunctionState state = functions_.back();
+  functions_.pop_back();
+  state.Function->SetStackDepth(state.MaxStackDepth);
+
+  bool needs_long_jumps = state.JumpTooFar && !had_error_;
+  had_error_ = had_error_ || state.EnclosingHadError;
+  return needs_long_jumps;
+}
+
+void Compiler::Emit(OpCode code) {
+  size_t _ = CurrentChunk()->WriteOpCode(code, functions_.back().Line);
+  AdjustStackDepth(core::GetStackEffect(code));
+}
+
+void Compiler::Emit(OpCode code, uint8_t operand) {
+  Emit(code, {operand});
+}
+
+void Compiler::Emit(OpCode code, std::initializer_list<uint8_t> operands) {
+  Emit(code);
+  size_t _ = CurrentChunk()->WriteBytes(operands);
+}
+
+void Compiler::EmitIndexed(
+    OpCode code, uint16_t index, std::initializer_list<uint8_t> operands) {
+  if (index <= std::numeric_limits<uint8_t>::max()) {
+    Emit(code, {static_cast<uint8_t>(index)});
+  } else {
+    Emit(core::GetLongForm(code));
+    size_t _ = CurrentChunk()->WriteShort(index);
+  }
+
+  size_t _ = CurrentChunk()->WriteBytes(operands);
+}
+
+void Compiler::AdjustStackDepth(ptrdiff_t change) {
+  FunctionState& state = functions_.back();
+  state.StackDepth = static_cast<size_t>(
+      static_cast<ptrdiff_t>(state.StackDepth) + change);
+  state.MaxStackDepth = std::max(state.MaxStackDepth, state.StackDepth);
+}
+
+void Compiler::SetLine(const parsing::Token& token) {
+  functions_.back().Line = static_cast<size_t>(token.Line);
+}
+
+Compiler::PendingJump Compiler::EmitJump(OpCode code) {
+  if (functions_.back().LongJumps) {
+    Emit(core::GetLongForm(code));
+    return PendingJump{
+        CurrentChunk()->WriteLong(std::numeric_limits<uint32_t>::max()),
+        functions_.back().StackDepth};
+  }
+
+  Emit(code);
+  return PendingJump{
+      CurrentChunk()->WriteShort(std::numeric_limits<uint16_t>::max()),
+      functions_.back().StackDepth};
+}
+
+/// The code after a jump is either unreachable or left with the same values
+/// on the stack as the jump, so the target starts from the jump's depth.
+void Compiler::PatchJump(const PendingJump& jump) {
+  size_t offset_index = jump.OffsetIndex;
+  functions_.back().StackDepth = jump.StackDepth;
+  bool long_jumps = functions_.back().LongJumps;
+  size_t offset =
+      CurrentChunk()->GetOpCodeCount() - (offset_index + (long_jumps ? 4 : 2));
+  uint32_t operand = MakeJumpOffset(offset, "Too much code to jump over.");
+
+  if (long_jumps) {
+    CurrentChunk()->PatchLong(offset_index, operand);
+  } else {
+    CurrentChunk()->PatchShort(offset_index, static_cast<uint16_t>(operand));
+  }
+}
+
+void Compiler::EmitLoop(size_t loop_start) {
+  bool long_jumps = functions_.back().LongJumps;
+  // The offset is measured from the end of the Loop instruction.
+  size_t offset =
+      CurrentChunk()->GetOpCodeCount() + (long_jumps ? 5 : 3) - loop_start;
+  uint32_t operand = MakeJumpOffset(offset, "Loop body too large.");
+
+  if (long_jumps) {
+    Emit(OpCode::LoopLong);
+    size_t _ = CurrentChunk()->WriteLong(operand);
+  } else {
+    Emit(OpCode::Loop);
+    size_t _ = CurrentChunk()->WriteShort(static_cast<uint16_t>(operand));
+  }
+}
+
+uint16_t Compiler::MakeConstant(const Value& value) {
+  return MakeShortOperand(
+      CurrentChunk()->AddConstant(value), "Too many constants in one chunk.");
+}
+
+uint16_t Compiler::MakeName(const parsing::Token& name) {
+  return MakeShortOperand(
+      CurrentChunk()->AddName(name.Identifier), "Too many names in one chunk.");
+}
+
+uint16_t Compiler::MakeSlot(const parsed::VariableLocation& location) {
+  return MakeShortOperand(
+      location.Slot,
+      location.Storage == parsed::VariableStorage::Upvalue
+          ? "Too many closure variables." : "Too many local variables.");
+}
+
+uint8_t Compiler::MakeOperand(size_t value, const char* message) {
+  return static_cast<uint8_t>(
+      CheckOperand(value, std::numeric_limits<uint8_t>::max(), message));
+}
+
+uint16_t Compiler::MakeShortOperand(size_t value, const char* message) {
+  return static_cast<uint16_t>(
+      CheckOperand(value, std::numeric_limits<uint16_t>::max(), message));
+}
+
+uint32_t Compiler::MakeJumpOffset(size_t offset, const char* message) {
+  FunctionState& state = functions_.back();
+
+  if (!state.LongJumps && offset > std::numeric_limits<uint16_t>::max()) {
+    state.JumpTooFar = true;
+    return 0;
+  }
+
+  return static_cast<uint32_t>(
+      CheckOperand(offset, std::numeric_limits<uint32_t>::max(), message));
+}
+
+/// Once a function overflows a limit, every instruction after it is likely to
+/// as well, so only the first error in each function is reported.
+size_t Compiler::CheckOperand(size_t value, size_t max, const char* message) {
+  if (value > max) {
+    FunctionState& state = functions_.back();
+
+    if (!state.ReportedError) {
+      lamscript::runtime::Lamscript::Error(
+          static_cast<int>(state.Line), message);
+      state.ReportedError = true;
+    }
+
+    had_error_ = true;
+    return 0;
+  }
+
+  return value;
+}
+
+void Compiler::EmitLoad(
+    const parsing::Token& name, const parsed::VariableLocation& location) {
+  switch (location.Storage) {
+    case parsed::VariableStorage::Stack:
+      EmitIndexed(OpCode::GetLocal, MakeSlot(location));
+      break;
+    case parsed::VariableStorage::Cell:
+      EmitIndexed(OpCode::GetCell, MakeSlot(location));
+      break;
+    case parsed::VariableStorage::Upvalue:
+      EmitIndexed(OpCode::GetUpvalue, MakeSlot(location));
+      break;
+    case parsed::VariableStorage::Global:
+      EmitIndexed(OpCode::GetGlobal, MakeName(name));
+      break;
+  }
+}
+
+void Compiler::EmitStore(
+    const parsing::Token& name, const parsed::VariableLocation& location) {
+  switch (location.Storage) {
+    case parsed::VariableStorage::Stack:
+      EmitIndexed(OpCode::SetLocal, MakeSlot(location));
+      break;
+    case parsed::VariableStorage::Cell:
+      EmitIndexed(OpCode::SetCell, MakeSlot(location));
+      break;
+    case parsed::VariableStorage::Upvalue:
+      EmitIndexed(OpCode::SetUpvalue, MakeSlot(location));
+      break;
+    case parsed::VariableStorage::Global:
+      EmitIndexed(OpCode::SetGlobal, MakeName(name));
+      break;
+  }
+}
+
+void Compiler::EmitDeclare(const parsed::VariableLocation& location) {
+  if (location.Storage == parsed::VariableStorage::Cell) {
+    EmitIndexed(OpCode::MakeCell, MakeSlot(location));
+  }
+}
+
+void Compiler::EmitDefine(
+    const parsing::Token& name, const parsed::VariableLocation& location) {
+  if (location.Storage == parsed::VariableStorage::Global) {
+    EmitIndexed(OpCode::DefineGlobal, MakeName(name));
+    return;
+  }
+
+  EmitStore(name, location);
+  Emit(OpCode::Pop);
+}
+
+}  // namespace lamscripten::compiler
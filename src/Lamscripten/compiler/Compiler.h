@@ -0,0 +1,222 @@
+#ifndef SRC_LAMSCRIPTEN_COMPILER_COMPILER_H_
+#define SRC_LAMSCRIPTEN_COMPILER_COMPILER_H_
+
+#include <cstddef>
+#include <cstdint>
+#include <initializer_list>
+#include <memory>
+#include <vector>
+
+#include <Lamscript/Visitor.h>
+#include <Lamscript/parsed/Expression.h>
+#include <Lamscript/parsed/Statement.h>
+#include <Lamscript/parsing/Token.h>
+#include <Lamscripten/core/Chunk.h>
+#include <Lamscripten/core/Function.h>
+#include <Lamscripten/core/Value.h>
+
+namespace lamscripten::compiler {
+
+/// @brief Compiles programs that have been parsed and resolved by lamscript's
+/// front end into Lamscripten bytecode.
+///
+/// The compiler reuses the variable locations that the resolver assigned, so
+/// locals are read straight out of their slot in the call frame and captured
+/// variables through their cell, the same way lamscript's interpreter stores
+/// them. Every function is compiled into its own chunk and stored as a
+/// prototype in the constant pool of the function that declares it.
+class Compiler
+    : public lamscript::ExpressionVisitor, public lamscript::StatementVisitor {
+ public:
+  Compiler() : functions_(), had_error_(false) {}
+
+  /// @brief Compiles the top level statements of a program into the function
+  /// that runs it. Variables declared within the blocks of top level code are
+  /// stored in a frame of frame_size slots.
+  [[nodiscard]] core::Ref<core::Function> Compile(
+      const std::vector<std::unique_ptr<lamscript::parsed::Statement>>&
+          statements,
+      size_t frame_size);
+
+  /// @brief Whether a program was too large to be encoded. Errors are
+  /// reported as they're found.
+  [[nodiscard]] bool HadError() const { return had_error_; }
+
+  core::Value VisitAssignExpression(
+      lamscript::parsed::Assign* assignment) override;
+  core::Value VisitBinaryExpression(lamscript::parsed::Binary* binary) override;
+  core::Value VisitCallExpression(lamscript::parsed::Call* call) override;
+  core::Value VisitGetExpression(lamscript::parsed::Get* getter) override;
+  core::Value VisitGroupingExpression(
+      lamscript::parsed::Grouping* grouping) override;
+  core::Value VisitLiteralExpression(
+      lamscript::parsed::Literal* literal) override;
+  core::Value VisitLogicalExpression(
+      lamscript::parsed::Logical* logical) override;
+  core::Value VisitSetExpression(lamscript::parsed::Set* setter) override;
+  core::Value VisitSuperExpression(lamscript::parsed::Super* super) override;
+  core::Value VisitThisExpression(lamscript::parsed::This* this_expr) override;
+  core::Value VisitUnaryExpression(lamscript::parsed::Unary* unary) override;
+  core::Value VisitVariableExpression(
+      lamscript::parsed::Variable* variable) override;
+  core::Value VisitLambdaExpression(
+      lamscript::parsed::LambdaExpression* expression) override;
+
+  lamscript::runtime::Completion VisitBlockStatement(
+      lamscript::parsed::Block* block) override;
+  lamscript::runtime::Completion VisitClassStatement(
+      lamscript::parsed::Class* class_def) override;
+  lamscript::runtime::Completion VisitExpressionStatement(
+      lamscript::parsed::ExpressionStatement* statement) override;
+  lamscript::runtime::Completion VisitFunctionStatement(
+      lamscript::parsed::Function* func) override;
+  lamscript::runtime::Completion VisitIfStatement(
+      lamscript::parsed::If* if_statement) override;
+  lamscript::runtime::Completion VisitPrintStatement(
+      lamscript::parsed::Print* print) override;
+  lamscript::runtime::Completion VisitReturnStatement(
+      lamscript::parsed::Return* return_statement) override;
+  lamscript::runtime::Completion VisitVariableStatement(
+      lamscript::parsed::VariableStatement* variable) override;
+  lamscript::runtime::Completion VisitWhileStatement(
+      lamscript::parsed::While* while_statement) override;
+
+ private:
+  /// @brief A function that's being compiled and the source line that the
+  /// instructions written to it are attributed to.
+  struct FunctionState {
+    core::Function* Function;
+    size_t Line;
+    /// @brief The number of temporaries on the stack after the instructions
+    /// written so far.
+    size_t StackDepth;
+    /// @brief The most temporaries that have been on the stack at once.
+    size_t MaxStackDepth;
+    /// @brief Whether jumps are written in their Long form.
+    bool LongJumps;
+    /// @brief Whether a jump didn't fit in its short form.
+    bool JumpTooFar;
+    /// @brief Whether an operand of the function has already overflowed.
+    bool ReportedError;
+    /// @brief Whether errors had been reported before the function.
+    bool EnclosingHadError;
+  };
+
+  /// @brief A jump whose offset is patched once its target is compiled, and
+  /// the number of temporaries on the stack when it's taken.
+  struct PendingJump {
+    size_t OffsetIndex;
+    size_t StackDepth;
+  };
+
+  /// @brief The functions being compiled, innermost last.
+  std::vector<FunctionState> functions_;
+  bool had_error_;
+
+  [[nodiscard]] core::Chunk* CurrentChunk();
+
+  void Compile(lamscript::parsed::Expression* expression);
+  void Compile(lamscript::parsed::Statement* statement);
+
+  /// @brief Compiles statements that report the runtime errors raised within
+  /// them and then skip to the end of the statements, like the blocks and
+  /// function bodies of lamscript's interpreter.
+  void CompileHandledStatements(
+      const std::vector<std::unique_ptr<lamscript::parsed::Statement>>&
+          statements);
+
+  /// @brief Compiles a function declaration into a prototype.
+  [[nodiscard]] core::Ref<core::Function> CompileFunction(
+      lamscript::parsed::Function* declaration, bool is_initializer);
+
+  /// @brief Starts compiling a function, writing its jumps in their Long form
+  /// if long_jumps is set.
+  void PushFunction(core::Function* function, bool long_jumps);
+
+  /// @brief Finishes compiling the innermost function. Returns whether it has
+  /// to be compiled again with long jumps because one of its jumps didn't fit
+  /// in a two byte offset.
+  [[nodiscard]] bool PopFunction();
+
+  void Emit(core::OpCode code);
+  void Emit(core::OpCode code, uint8_t operand);
+  void Emit(
+      core::OpCode code,
+      std::initializer_list<uint8_t> operands);
+
+  /// @brief Writes an instruction that takes an index into the constant pool
+  /// or name table, using its Long form when the index doesn't fit in a byte.
+  void EmitIndexed(
+      core::OpCode code,
+      uint16_t index,
+      std::initializer_list<uint8_t> operands = {});
+
+  /// @brief Attributes the instructions written after it to the line of the
+  /// token, so that errors raised by them report it.
+  void SetLine(const lamscript::parsing::Token& token);
+
+  /// @brief Tracks the values that an instruction pushes or pops beyond its
+  /// stack effect, such as the arguments of a call.
+  void AdjustStackDepth(ptrdiff_t change);
+
+  /// @brief Writes a jump with a placeholder offset and returns it to be
+  /// patched. Functions that are compiled with long jumps use the Long form of
+  /// every jump, whose offset is four bytes.
+  [[nodiscard]] PendingJump EmitJump(core::OpCode code);
+
+  /// @brief Points the jump at the next instruction to be written.
+  void PatchJump(const PendingJump& jump);
+
+  /// @brief Writes a jump back to the instruction at loop_start.
+  void EmitLoop(size_t loop_start);
+
+  [[nodiscard]] uint16_t MakeConstant(const core::Value& value);
+  [[nodiscard]] uint16_t MakeName(const lamscript::parsing::Token& name);
+
+  /// @brief Gets the index of the slot or upvalue that a variable is stored
+  /// in.
+  [[nodiscard]] uint16_t MakeSlot(
+      const lamscript::parsed::VariableLocation& location);
+
+  /// @brief Checks that a jump's offset fits within its operand. Offsets that
+  /// don't fit in a short jump mark the function to be compiled again with
+  /// long jumps instead of reporting an error.
+  [[nodiscard]] uint32_t MakeJumpOffset(size_t offset, const char* message);
+
+  /// @brief Checks that a value fits within a one byte operand, reporting an
+  /// error if it doesn't and none has been reported in the function yet.
+  [[nodiscard]] uint8_t MakeOperand(size_t value, const char* message);
+
+  /// @brief Checks that a value fits within a two byte operand, reporting an
+  /// error if it doesn't.
+  [[nodiscard]] uint16_t MakeShortOperand(size_t value, const char* message);
+
+  [[nodiscard]] size_t CheckOperand(
+      size_t value, size_t max, const char* message);
+
+  /// @brief Pushes the value of the variable at the location that the
+  /// resolver found it at.
+  void EmitLoad(
+      const lamscript::parsing::Token& name,
+      const lamscript::parsed::VariableLocation& location);
+
+  /// @brief Assigns the top of the stack to the variable at the location
+  /// without popping it.
+  void EmitStore(
+      const lamscript::parsing::Token& name,
+      const lamscript::parsed::VariableLocation& location);
+
+  /// @brief Gives a variable that's about to be declared a new cell if it's
+  /// captured.
+  void EmitDeclare(const lamscript::parsed::VariableLocation& location);
+
+  /// @brief Pops the top of the stack into the variable declared at the
+  /// location.
+  void EmitDefine(
+      const lamscript::parsing::Token& name,
+      const lamscript::parsed::VariableLocation& location);
+};
+
+}  // namespace lamscripten::compiler
+
+#endif  // SRC_LAMSCRIPTEN_COMPILER_COMPILER_H_
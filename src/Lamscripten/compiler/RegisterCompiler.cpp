@@ -0,0 +1,862 @@
+#include <Lamscripten/compiler/RegisterCompiler.h>
+
+#include <algorithm>
+#include <limits>
+#include <memory>
+#include <string>
+#include <vector>
+
+#include <Lamscript/parsed/LamscriptString.h>
+#include <Lamscript/runtime/Lamscript.h>
+
+namespace lamscripten::compiler {
+
+using lamscript::runtime::Completion;
+using lamscripten::core::Ref;
+using lamscripten::core::Value;
+
+using Op = lamscripten::core::RegisterOpCode;
+
+namespace parsed = lamscript::parsed;
+namespace parsing = lamscript::parsing;
+
+// ---------------------------------- INTERNAL ---------------------------------
+
+namespace {
+
+/// @brief Whether evaluating the expression can't assign to a local, so the
+/// register of a local that's read before it doesn't have to be copied.
+bool CantAssignLocals(parsed::Expression* expression) {
+  if (dynamic_cast<parsed::Literal*>(expression) != nullptr
+      || dynamic_cast<parsed::Variable*>(expression) != nullptr
+      || dynamic_cast<parsed::This*>(expression) != nullptr) {
+    return true;
+  }
+
+  if (auto grouping = dynamic_cast<parsed::Grouping*>(expression)) {
+    return CantAssignLocals(grouping->GetExpression());
+  }
+
+  if (auto unary = dynamic_cast<parsed::Unary*>(expression)) {
+    return CantAssignLocals(unary->GetRightExpression());
+  }
+
+  if (auto binary = dynamic_cast<parsed::Binary*>(expression)) {
+    return CantAssignLocals(binary->GetLeftSide())
+        && CantAssignLocals(binary->GetRightSide());
+  }
+
+  return false;
+}
+
+}  // namespace
+
+// ---------------------------------- PUBLIC -----------------------------------
+
+/// Errors in top level statements stop the program, so the script doesn't
+/// register a handler for them.
+Ref<core::Function> RegisterCompiler::Compile(
+    const std::vector<std::unique_ptr<parsed::Statement>>& statements,
+    size_t frame_size) {
+  Ref<core::Function> script;
+  bool long_jumps = false;
+
+  do {
+    script = parsed::MakeRef<core::Function>(
+        "script", 0, frame_size, parsed::FunctionMetadata{false, false, false},
+        false, core::InstructionSet::Register);
+    PushFunction(script.get(), frame_size, long_jumps);
+    uint8_t _ = MakeOperand(
+        frame_size, "Too many local variables in function.");
+
+    for (auto&& statement : statements) {
+      Compile(statement.get());
+    }
+
+    uint8_t result = AllocateRegister();
+    Emit(Op::LoadNil, {result});
+    Emit(Op::Return, {result});
+    long_jumps = PopFunction();
+  } while (long_jumps);
+
+  return script;
+}
+
+// --------------------------------- EXPRESSIONS -------------------------------
+
+/// Plain locals are assigned by compiling the value straight into their
+/// register.
+Value RegisterCompiler::VisitAssignExpression(parsed::Assign* assignment) {
+  const parsed::VariableLocation& location = assignment->GetLocation();
+
+  if (location.Storage == parsed::VariableStorage::Stack) {
+    SetLine(assignment->GetName());
+    uint8_t slot = MakeOperand(location.Slot, "Too many local variables.");
+    CompileInto(assignment->GetValue(), slot, true);
+    SetResult(slot);
+    return nullptr;
+  }
+
+  CompileInto(assignment->GetValue(), target_, target_is_local_);
+  SetLine(assignment->GetName());
+  EmitStore(assignment->GetName(), location, target_);
+  result_ = target_;
+  return nullptr;
+}
+
+/// The left operand is read from its local's register only when the right
+/// operand can't assign to it in between.
+Value RegisterCompiler::VisitBinaryExpression(parsed::Binary* binary) {
+  TemporaryScope scope(this);
+  uint8_t left_side;
+
+  if (CantAssignLocals(binary->GetRightSide())) {
+    left_side = CompileOperand(binary->GetLeftSide());
+  } else {
+    left_side = AllocateRegister();
+    CompileInto(binary->GetLeftSide(), left_side);
+  }
+
+  uint8_t right_side = CompileOperand(binary->GetRightSide());
+  SetLine(binary->GetOperator());
+
+  Op code;
+  switch (binary->GetOperator().Type) {
+    case parsing::PLUS: code = Op::Add; break;
+    case parsing::MINUS: code = Op::Subtract; break;
+    case parsing::STAR: code = Op::Multiply; break;
+    case parsing::SLASH: code = Op::Divide; break;
+    case parsing::MODULUS: code = Op::Modulus; break;
+    case parsing::GREATER: code = Op::Greater; break;
+    case parsing::GREATER_EQUAL: code = Op::GreaterEqual; break;
+    case parsing::LESS: code = Op::Less; break;
+    case parsing::LESS_EQUAL: code = Op::LessEqual; break;
+    case parsing::EQUAL_EQUAL: code = Op::Equal; break;
+    case parsing::BANG_EQUAL: code = Op::NotEqual; break;
+    default:
+      Emit(Op::LoadNil, {target_});
+      result_ = target_;
+      return nullptr;
+  }
+
+  Emit(code, {target_, left_side, right_side});
+  result_ = target_;
+  return nullptr;
+}
+
+/// The callee and arguments are compiled into consecutive registers at the
+/// top of the temporaries, starting at the target when it's the topmost
+/// temporary so that the result doesn't need to be moved. Calls to methods of
+/// an object are compiled into Invoke, which calls the method without binding
+/// it to the object first.
+Value RegisterCompiler::VisitCallExpression(parsed::Call* call) {
+  TemporaryScope scope(this);
+  parsed::Get* getter = call->GetMethodCallee();
+  uint8_t base =
+      !target_is_local_ && target_ + 1u == functions_.back().NextRegister
+          ? target_ : AllocateRegister();
+
+  if (getter != nullptr) {
+    CompileInto(getter->GetObject().get(), base);
+  } else {
+    CompileInto(call->GetCallee(), base);
+  }
+
+  for (auto&& argument : call->GetArguments()) {
+    CompileInto(argument.get(), AllocateRegister());
+  }
+
+  uint8_t argument_count = MakeOperand(
+      call->GetArguments().size(), "Too many arguments in call.");
+  SetLine(call->GetParentheses());
+
+  if (getter != nullptr) {
+    EmitIndexed(
+        Op::Invoke, MakeName(getter->GetName()), {base, argument_count});
+  } else {
+    Emit(Op::Call, {base, argument_count});
+  }
+
+  SetResult(base);
+  return nullptr;
+}
+
+Value RegisterCompiler::VisitGetExpression(parsed::Get* getter) {
+  TemporaryScope scope(this);
+  uint8_t object = CompileOperand(getter->GetObject().get());
+  SetLine(getter->GetName());
+  EmitIndexed(Op::GetProperty, MakeName(getter->GetName()), {target_, object});
+  result_ = target_;
+  return nullptr;
+}
+
+Value RegisterCompiler::VisitGroupingExpression(parsed::Grouping* grouping) {
+  grouping->GetExpression()->Accept(this);
+  return nullptr;
+}
+
+Value RegisterCompiler::VisitLiteralExpression(parsed::Literal* literal) {
+  const Value& value = literal->GetValue();
+
+  if (value.IsNil()) {
+    Emit(Op::LoadNil, {target_});
+  } else if (value.IsBoolean()) {
+    Emit(value.AsBoolean() ? Op::LoadTrue : Op::LoadFalse, {target_});
+  } else {
+    EmitIndexed(Op::LoadConstant, MakeConstant(value), {target_});
+  }
+
+  result_ = target_;
+  return nullptr;
+}
+
+/// The left operand is stored as the result before the right operand is
+/// evaluated, so it goes through a temporary when the target is a local that
+/// the right operand could read.
+Value RegisterCompiler::VisitLogicalExpression(parsed::Logical* logical) {
+  TemporaryScope scope(this);
+  uint8_t result = target_is_local_ ? AllocateRegister() : target_;
+  CompileInto(logical->GetLeftOperand(), result);
+
+  size_t short_circuit = EmitJump(
+      logical->GetLogicalOperator().Type == parsing::OR
+          ? Op::JumpIfTrue : Op::JumpIfFalse,
+      {result});
+  CompileInto(logical->GetRightOperand(), result);
+  PatchJump(short_circuit);
+  SetResult(result);
+  return nullptr;
+}
+
+Value RegisterCompiler::VisitSetExpression(parsed::Set* setter) {
+  TemporaryScope scope(this);
+  uint8_t object;
+
+  if (CantAssignLocals(setter->GetValue())) {
+    object = CompileOperand(setter->GetObject().get());
+  } else {
+    object = AllocateRegister();
+    CompileInto(setter->GetObject().get(), object);
+  }
+
+  uint8_t value = target_;
+
+  if (target_is_local_) {
+    value = CompileOperand(setter->GetValue());
+  } else {
+    CompileInto(setter->GetValue(), value);
+  }
+
+  SetLine(setter->GetName());
+  EmitIndexed(Op::SetProperty, MakeName(setter->GetName()), {object, value});
+  SetResult(value);
+  return nullptr;
+}
+
+Value RegisterCompiler::VisitSuperExpression(parsed::Super* super) {
+  TemporaryScope scope(this);
+  uint8_t super_class = AllocateRegister();
+  EmitLoad(super->GetKeyword(), super->GetLocation(), super_class);
+  uint8_t receiver = CompileOperand(super->GetThis());
+  SetLine(super->GetMethod());
+  EmitIndexed(
+      Op::GetSuper,
+      MakeName(super->GetMethod()),
+      {target_, super_class, receiver});
+  result_ = target_;
+  return nullptr;
+}
+
+Value RegisterCompiler::VisitThisExpression(parsed::This* this_expr) {
+  const parsed::VariableLocation& location = this_expr->GetLocation();
+  SetLine(this_expr->GetKeyword());
+
+  if (location.Storage == parsed::VariableStorage::Stack) {
+    SetResult(MakeOperand(location.Slot, "Too many local variables."));
+    return nullptr;
+  }
+
+  EmitLoad(this_expr->GetKeyword(), location, target_);
+  result_ = target_;
+  return nullptr;
+}
+
+Value RegisterCompiler::VisitUnaryExpression(parsed::Unary* unary) {
+  TemporaryScope scope(this);
+  uint8_t operand = CompileOperand(unary->GetRightExpression());
+  SetLine(unary->GetUnaryOperator());
+
+  switch (unary->GetUnaryOperator().Type) {
+    case parsing::BANG: Emit(Op::Not, {target_, operand}); break;
+    case parsing::MINUS: Emit(Op::Negate, {target_, operand}); break;
+    default:
+      Emit(Op::LoadNil, {target_});
+      break;
+  }
+
+  result_ = target_;
+  return nullptr;
+}
+
+Value RegisterCompiler::VisitVariableExpression(parsed::Variable* variable) {
+  const parsed::VariableLocation& location = variable->GetLocation();
+  SetLine(variable->GetName());
+
+  if (location.Storage == parsed::VariableStorage::Stack) {
+    SetResult(MakeOperand(location.Slot, "Too many local variables."));
+    return nullptr;
+  }
+
+  EmitLoad(variable->GetName(), location, target_);
+  result_ = target_;
+  return nullptr;
+}
+
+Value RegisterCompiler::VisitLambdaExpression(
+    parsed::LambdaExpression* expression) {
+  parsed::Function* function = static_cast<parsed::Function*>(
+      expression->GetFunctionStatement());
+  Ref<core::Function> prototype = CompileFunction(function, false);
+  EmitIndexed(Op::Closure, MakeConstant(prototype), {target_});
+  result_ = target_;
+  return nullptr;
+}
+
+// --------------------------------- STATEMENTS --------------------------------
+
+Completion RegisterCompiler::VisitBlockStatement(parsed::Block* block) {
+  CompileHandledStatements(block->GetStatements());
+  return Completion::Normal;
+}
+
+/// The class and super class are declared before the methods are created so
+/// that the methods can capture them. The class is created from the super
+/// class in its register, and each method is then created in a register that
+/// they all share and added to it.
+Completion RegisterCompiler::VisitClassStatement(parsed::Class* class_def) {
+  TemporaryScope scope(this);
+  bool has_super_class = class_def->GetSuperClass() != nullptr;
+  SetLine(class_def->GetName());
+  uint8_t class_register = AllocateRegister();
+
+  if (has_super_class) {
+    parsing::Token super_name{parsing::SUPER, "super", nullptr, 0};
+
+    EmitDeclare(class_def->GetSuperClassLocation());
+    CompileInto(class_def->GetSuperClass(), class_register);
+    EmitDefine(super_name, class_def->GetSuperClassLocation(), class_register);
+    SetLine(class_def->GetName());
+  }
+
+  EmitDeclare(class_def->GetLocation());
+  EmitIndexed(
+      Op::Class,
+      MakeConstant(
+          parsed::MakeRef<parsed::LamscriptString>(
+              class_def->GetName().Lexeme)),
+      {class_register, static_cast<uint8_t>(has_super_class ? 1 : 0)});
+
+  uint8_t method_register = AllocateRegister();
+
+  for (auto&& method : class_def->GetMethods()) {
+    Ref<core::Function> prototype = CompileFunction(
+        method.get(), method->GetName().Lexeme.compare("constructor") == 0);
+    EmitIndexed(Op::Closure, MakeConstant(prototype), {method_register});
+    Emit(Op::Method, {class_register, method_register});
+  }
+
+  EmitDefine(class_def->GetName(), class_def->GetLocation(), class_register);
+  return Completion::Normal;
+}
+
+Completion RegisterCompiler::VisitExpressionStatement(
+    parsed::ExpressionStatement* statement) {
+  TemporaryScope scope(this);
+  uint8_t _ = CompileOperand(statement->GetExpression());
+  return Completion::Normal;
+}
+
+/// The variable is declared before the closure is created so that recursive
+/// functions can capture themselves.
+Completion RegisterCompiler::VisitFunctionStatement(parsed::Function* func) {
+  TemporaryScope scope(this);
+  const parsed::VariableLocation& location = func->GetLocation();
+  SetLine(func->GetName());
+  EmitDeclare(location);
+  Ref<core::Function> prototype = CompileFunction(func, false);
+
+  if (location.Storage == parsed::VariableStorage::Stack) {
+    EmitIndexed(
+        Op::Closure,
+        MakeConstant(prototype),
+        {MakeOperand(location.Slot, "Too many local variables.")});
+    return Completion::Normal;
+  }
+
+  uint8_t closure = AllocateRegister();
+  EmitIndexed(Op::Closure, MakeConstant(prototype), {closure});
+  EmitDefine(func->GetName(), location, closure);
+  return Completion::Normal;
+}
+
+Completion RegisterCompiler::VisitIfStatement(parsed::If* if_statement) {
+  size_t else_jump;
+
+  {
+    TemporaryScope scope(this);
+    uint8_t condition = CompileOperand(if_statement->GetCondition());
+    else_jump = EmitJump(Op::JumpIfFalse, {condition});
+  }
+
+  Compile(if_statement->GetThenBranch());
+
+  if (if_statement->GetElseBranch() == nullptr) {
+    PatchJump(else_jump);
+    return Completion::Normal;
+  }
+
+  size_t end_jump = EmitJump(Op::Jump);
+  PatchJump(else_jump);
+  Compile(if_statement->GetElseBranch());
+  PatchJump(end_jump);
+  return Completion::Normal;
+}
+
+Completion RegisterCompiler::VisitPrintStatement(parsed::Print* print) {
+  TemporaryScope scope(this);
+  uint8_t value = CompileOperand(print->GetExpression());
+  Emit(Op::Print, {value});
+  return Completion::Normal;
+}
+
+/// Returning from an initializer returns its receiver, which methods keep in
+/// register 0.
+Completion RegisterCompiler::VisitReturnStatement(
+    parsed::Return* return_statement) {
+  TemporaryScope scope(this);
+  uint8_t value;
+
+  if (return_statement->GetValue() != nullptr) {
+    value = CompileOperand(return_statement->GetValue());
+  } else {
+    value = AllocateRegister();
+    Emit(Op::LoadNil, {value});
+  }
+
+  SetLine(return_statement->GetKeyword());
+
+  if (functions_.back().Function->IsInitializer()) {
+    value = 0;
+  }
+
+  Emit(Op::Return, {value});
+  return Completion::Normal;
+}
+
+/// Captured variables get a fresh cell every time their declaration runs, so
+/// the cell is created before the initializer is evaluated.
+Completion RegisterCompiler::VisitVariableStatement(
+    parsed::VariableStatement* variable) {
+  SetLine(variable->GetName());
+  EmitDeclare(variable->GetLocation());
+  CompileDefinition(
+      variable->GetName(), variable->GetLocation(),
+      variable->GetInitializer());
+  return Completion::Normal;
+}
+
+Completion RegisterCompiler::VisitWhileStatement(
+    parsed::While* while_statement) {
+  size_t loop_start = CurrentChunk()->GetOpCodeCount();
+  size_t exit_jump;
+
+  {
+    TemporaryScope scope(this);
+    uint8_t condition = CompileOperand(while_statement->GetCondition());
+    exit_jump = EmitJump(Op::JumpIfFalse, {condition});
+  }
+
+  Compile(while_statement->GetBody());
+  EmitLoop(loop_start);
+  PatchJump(exit_jump);
+  return Completion::Normal;
+}
+
+// ---------------------------------- PRIVATE ----------------------------------
+
+core::Chunk* RegisterCompiler::CurrentChunk() {
+  return functions_.back().Function->GetChunk();
+}
+
+void RegisterCompiler::Compile(parsed::Statement* statement) {
+  statement->Accept(this);
+}
+
+void RegisterCompiler::CompileInto(
+    parsed::Expression* expression, uint8_t target, bool target_is_local) {
+  uint8_t enclosing_target = target_;
+  bool enclosing_target_is_local = target_is_local_;
+  bool enclosing_any_register = any_register_;
+
+  target_ = target;
+  target_is_local_ = target_is_local;
+  any_register_ = false;
+  expression->Accept(this);
+
+  target_ = enclosing_target;
+  target_is_local_ = enclosing_target_is_local;
+  any_register_ = enclosing_any_register;
+}
+
+uint8_t RegisterCompiler::CompileOperand(parsed::Expression* expression) {
+  uint8_t enclosing_target = target_;
+  bool enclosing_target_is_local = target_is_local_;
+  bool enclosing_any_register = any_register_;
+
+  target_ = AllocateRegister();
+  target_is_local_ = false;
+  any_register_ = true;
+  expression->Accept(this);
+
+  // The temporary isn't needed when the expression left its value in a
+  // local's register.
+  if (result_ != target_) {
+    functions_.back().NextRegister = target_;
+  }
+
+  target_ = enclosing_target;
+  target_is_local_ = enclosing_target_is_local;
+  any_register_ = enclosing_any_register;
+  return result_;
+}
+
+void RegisterCompiler::CompileHandledStatements(
+    const std::vector<std::unique_ptr<parsed::Statement>>& statements) {
+  size_t start = CurrentChunk()->GetOpCodeCount();
+
+  for (auto&& statement : statements) {
+    Compile(statement.get());
+  }
+
+  size_t end = CurrentChunk()->GetOpCodeCount();
+
+  if (start != end) {
+    CurrentChunk()->AddErrorHandler(core::ErrorHandler{start, end, end});
+  }
+}
+
+/// Functions that finish without returning return nil, which is also where
+/// errors within the body resume.
+Ref<core::Function> RegisterCompiler::CompileFunction(
+    parsed::Function* declaration, bool is_initializer) {
+  // Arguments are stored above the receiver of methods, so they can take up
+  // more registers than the resolver assigned when none of them are used.
+  size_t local_count = std::max(
+      declaration->GetFrameSize(),
+      declaration->GetParams().size() + (declaration->IsMethod() ? 1 : 0));
+  Ref<core::Function> function;
+  bool long_jumps = false;
+
+  do {
+    function = parsed::MakeRef<core::Function>(
+        declaration->GetName().Lexeme,
+        static_cast<int>(declaration->GetParams().size()),
+        declaration->GetFrameSize(),
+        parsed::FunctionMetadata{
+            declaration->IsStatic(),
+            declaration->IsMethod(),
+            declaration->IsGetter()},
+        is_initializer,
+        core::InstructionSet::Register);
+    function->SetUpvalues(declaration->GetUpvalues());
+    function->SetCapturedParameters(declaration->GetCapturedParameters());
+
+    PushFunction(function.get(), local_count, long_jumps);
+    SetLine(declaration->GetName());
+
+    // Temporaries are allocated above the locals, so they need to leave at
+    // least one register free.
+    uint8_t _ = MakeOperand(
+        local_count, "Too many local variables in function.");
+    CompileHandledStatements(declaration->GetBody());
+
+    uint8_t result = AllocateRegister();
+    Emit(Op::LoadNil, {result});
+    Emit(Op::Return, {result});
+    long_jumps = PopFunction();
+  } while (long_jumps);
+
+  return function;
+}
+
+void RegisterCompiler::PushFunction(
+    core::Function* function, size_t local_count, bool long_jumps) {
+  functions_.push_back(FunctionState{
+      function,
+      1,
+      local_count,
+      local_count,
+      long_jumps,
+      false,
+      false,
+      had_error_});
+  had_error_ = false;
+}
+
+/// Other errors are reported the first time that the function is compiled,
+/// so it's only compiled again when its jumps are the only problem.
+bool RegisterCompiler::PopFunction() {
+  FunctionState state = functions_.back();
+  functions_.pop_back();
+  state.Function->SetFrameSize(state.RegisterCount);
+
+  bool needs_long_jumps = state.JumpTooFar && !had_error_;
+  had_error_ = had_error_ || state.EnclosingHadError;
+  return needs_long_jumps;
+}
+
+uint8_t RegisterCompiler::AllocateRegister() {
+  FunctionState& state = functions_.back();
+  uint8_t index = MakeOperand(
+      state.NextRegister, "Too many registers in one function.");
+  state.NextRegister += 1;
+  state.RegisterCount = std::max(state.RegisterCount, state.NextRegister);
+  return index;
+}
+
+void RegisterCompiler::SetResult(uint8_t source) {
+  bool is_local = source < functions_.back().Function->GetFrameSize();
+
+  if (source != target_ && !(any_register_ && is_local)) {
+    Emit(Op::Move, {target_, source});
+    source = target_;
+  }
+
+  result_ = source;
+}
+
+void RegisterCompiler::Emit(Op code) {
+  size_t _ = CurrentChunk()->WriteOpCode(code, functions_.back().Line);
+}
+
+void RegisterCompiler::Emit(Op code, std::initializer_list<uint8_t> operands) {
+  Emit(code);
+  size_t _ = CurrentChunk()->WriteBytes(operands);
+}
+
+void RegisterCompiler::EmitIndexed(
+    Op code, uint16_t index, std::initializer_list<uint8_t> operands) {
+  if (index <= std::numeric_limits<uint8_t>::max()) {
+    Emit(code, {static_cast<uint8_t>(index)});
+  } else {
+    Emit(core::GetLongForm(code));
+    size_t _ = CurrentChunk()->WriteShort(index);
+  }
+
+  size_t _ = CurrentChunk()->WriteBytes(operands);
+}
+
+void RegisterCompiler::SetLine(const parsing::Token& token) {
+  functions_.back().Line = static_cast<size_t>(token.Line);
+}
+
+size_t RegisterCompiler::EmitJump(
+    Op code, std::initializer_list<uint8_t> operands) {
+  if (functions_.back().LongJumps) {
+    Emit(core::GetLongForm(code), operands);
+    return CurrentChunk()->WriteLong(std::numeric_limits<uint32_t>::max());
+  }
+
+  Emit(code, operands);
+  return CurrentChunk()->WriteShort(std::numeric_limits<uint16_t>::max());
+}
+
+void RegisterCompiler::PatchJump(size_t offset_index) {
+  bool long_jumps = functions_.back().LongJumps;
+  size_t offset =
+      CurrentChunk()->GetOpCodeCount() - (offset_index + (long_jumps ? 4 : 2));
+  uint32_t operand = MakeJumpOffset(offset, "Too much code to jump over.");
+
+  if (long_jumps) {
+    CurrentChunk()->PatchLong(offset_index, operand);
+  } else {
+    CurrentChunk()->PatchShort(offset_index, static_cast<uint16_t>(operand));
+  }
+}
+
+void RegisterCompiler::EmitLoop(size_t loop_start) {
+  bool long_jumps = functions_.back().LongJumps;
+  // The offset is measured from the end of the Loop instruction.
+  size_t offset =
+      CurrentChunk()->GetOpCodeCount() + (long_jumps ? 5 : 3) - loop_start;
+  uint32_t operand = MakeJumpOffset(offset, "Loop body too large.");
+
+  if (long_jumps) {
+    Emit(Op::LoopLong);
+    size_t _ = CurrentChunk()->WriteLong(operand);
+  } else {
+    Emit(Op::Loop);
+    size_t _ = CurrentChunk()->WriteShort(static_cast<uint16_t>(operand));
+  }
+}
+
+uint16_t RegisterCompiler::MakeConstant(const Value& value) {
+  return MakeShortOperand(
+      CurrentChunk()->AddConstant(value), "Too many constants in one chunk.");
+}
+
+uint16_t RegisterCompiler::MakeName(const parsing::Token& name) {
+  return MakeShortOperand(
+      CurrentChunk()->AddName(name.Identifier), "Too many names in one chunk.");
+}
+
+uint8_t RegisterCompiler::MakeOperand(size_t value, const char* message) {
+  return static_cast<uint8_t>(
+      CheckOperand(value, std::numeric_limits<uint8_t>::max(), message));
+}
+
+uint16_t RegisterCompiler::MakeShortOperand(
+    size_t value, const char* message) {
+  return static_cast<uint16_t>(
+      CheckOperand(value, std::numeric_limits<uint16_t>::max(), message));
+}
+
+uint32_t RegisterCompiler::MakeJumpOffset(size_t offset, const char* message) {
+  FunctionState& state = functions_.back();
+
+  if (!state.LongJumps && offset > std::numeric_limits<uint16_t>::max()) {
+    state.JumpTooFar = true;
+    return 0;
+  }
+
+  return static_cast<uint32_t>(
+      CheckOperand(offset, std::numeric_limits<uint32_t>::max(), message));
+}
+
+/// Once a function overflows a limit, every instruction after it is likely to
+/// as well, so only the first error in each function is reported.
+size_t RegisterCompiler::CheckOperand(
+    size_t value, size_t max, const char* message) {
+  if (value > max) {
+    FunctionState& state = functions_.back();
+
+    if (!state.ReportedError) {
+      lamscript::runtime::Lamscript::Error(
+          static_cast<int>(state.Line), message);
+      state.ReportedError = true;
+    }
+
+    had_error_ = true;
+    return 0;
+  }
+
+  return value;
+}
+
+void RegisterCompiler::EmitLoad(
+    const parsing::Token& name,
+    const parsed::VariableLocation& location,
+    uint8_t target) {
+  switch (location.Storage) {
+    case parsed::VariableStorage::Stack:
+    {
+      uint8_t slot = MakeOperand(location.Slot, "Too many local variables.");
+
+      if (slot != target) {
+        Emit(Op::Move, {target, slot});
+      }
+      break;
+    }
+    case parsed::VariableStorage::Cell:
+      Emit(
+          Op::GetCell,
+          {target, MakeOperand(location.Slot, "Too many local variables.")});
+      break;
+    case parsed::VariableStorage::Upvalue:
+      EmitIndexed(
+          Op::GetUpvalue,
+          MakeShortOperand(location.Slot, "Too many closure variables."),
+          {target});
+      break;
+    case parsed::VariableStorage::Global:
+      EmitIndexed(Op::GetGlobal, MakeName(name), {target});
+      break;
+  }
+}
+
+void RegisterCompiler::EmitStore(
+    const parsing::Token& name,
+    const parsed::VariableLocation& location,
+    uint8_t source) {
+  switch (location.Storage) {
+    case parsed::VariableStorage::Stack:
+    {
+      uint8_t slot = MakeOperand(location.Slot, "Too many local variables.");
+
+      if (slot != source) {
+        Emit(Op::Move, {slot, source});
+      }
+      break;
+    }
+    case parsed::VariableStorage::Cell:
+      Emit(
+          Op::SetCell,
+          {MakeOperand(location.Slot, "Too many local variables."), source});
+      break;
+    case parsed::VariableStorage::Upvalue:
+      EmitIndexed(
+          Op::SetUpvalue,
+          MakeShortOperand(location.Slot, "Too many closure variables."),
+          {source});
+      break;
+    case parsed::VariableStorage::Global:
+      EmitIndexed(Op::SetGlobal, MakeName(name), {source});
+      break;
+  }
+}
+
+void RegisterCompiler::EmitDeclare(const parsed::VariableLocation& location) {
+  if (location.Storage == parsed::VariableStorage::Cell) {
+    Emit(
+        Op::MakeCell,
+        {MakeOperand(location.Slot, "Too many local variables.")});
+  }
+}
+
+void RegisterCompiler::EmitDefine(
+    const parsing::Token& name,
+    const parsed::VariableLocation& location,
+    uint8_t source) {
+  if (location.Storage == parsed::VariableStorage::Global) {
+    EmitIndexed(Op::DefineGlobal, MakeName(name), {source});
+    return;
+  }
+
+  EmitStore(name, location, source);
+}
+
+void RegisterCompiler::CompileDefinition(
+    const parsing::Token& name,
+    const parsed::VariableLocation& location,
+    parsed::Expression* value) {
+  TemporaryScope scope(this);
+  uint8_t target =
+      location.Storage == parsed::VariableStorage::Stack
+          ? MakeOperand(location.Slot, "Too many local variables.")
+          : AllocateRegister();
+
+  if (value != nullptr) {
+    CompileInto(
+        value, target, location.Storage == parsed::VariableStorage::Stack);
+  } else {
+    Emit(Op::LoadNil, {target});
+  }
+
+  SetLine(name);
+
+  if (location.Storage != parsed::VariableStorage::Stack) {
+    EmitDefine(name, location, target);
+  }
+}
+
+}  // namespace lamscripten::compiler
@@ -0,0 +1,276 @@
+#ifndef SRC_LAMSCRIPTEN_COMPILER_REGISTERCOMPILER_H_
+#define SRC_LAMSCRIPTEN_COMPILER_REGISTERCOMPILER_H_
+
+#include <cstdint>
+#include <initializer_list>
+#include <memory>
+#include <vector>
+
+#include <Lamscript/Visitor.h>
+#include <Lamscript/parsed/Expression.h>
+#include <Lamscript/parsed/Statement.h>
+#include <Lamscript/parsing/Token.h>
+#include <Lamscripten/core/Chunk.h>
+#include <Lamscripten/core/Function.h>
+#include <Lamscripten/core/RegisterOpCode.h>
+#include <Lamscripten/core/Value.h>
+
+namespace lamscripten::compiler {
+
+/// @brief Compiles programs that have been parsed and resolved by lamscript's
+/// front end into the register based instruction set.
+///
+/// Locals live in the registers of the slots that the resolver assigned them,
+/// so expressions over them read and write those registers directly instead
+/// of pushing copies. Temporaries are allocated above the locals in stack
+/// order and released when the expression that needed them is compiled, and
+/// the frame size of each function is grown to fit the most that were live
+/// at once.
+class RegisterCompiler
+    : public lamscript::ExpressionVisitor, public lamscript::StatementVisitor {
+ public:
+  RegisterCompiler()
+      : functions_(),
+      target_(0),
+      target_is_local_(false),
+      any_register_(false),
+      result_(0),
+      had_error_(false) {}
+
+  /// @brief Compiles the top level statements of a program into the function
+  /// that runs it. Variables declared within the blocks of top level code are
+  /// stored in the first frame_size registers.
+  [[nodiscard]] core::Ref<core::Function> Compile(
+      const std::vector<std::unique_ptr<lamscript::parsed::Statement>>&
+          statements,
+      size_t frame_size);
+
+  /// @brief Whether a program was too large to be encoded. Errors are
+  /// reported as they're found.
+  [[nodiscard]] bool HadError() const { return had_error_; }
+
+  core::Value VisitAssignExpression(
+      lamscript::parsed::Assign* assignment) override;
+  core::Value VisitBinaryExpression(lamscript::parsed::Binary* binary) override;
+  core::Value VisitCallExpression(lamscript::parsed::Call* call) override;
+  core::Value VisitGetExpression(lamscript::parsed::Get* getter) override;
+  core::Value VisitGroupingExpression(
+      lamscript::parsed::Grouping* grouping) override;
+  core::Value VisitLiteralExpression(
+      lamscript::parsed::Literal* literal) override;
+  core::Value VisitLogicalExpression(
+      lamscript::parsed::Logical* logical) override;
+  core::Value VisitSetExpression(lamscript::parsed::Set* setter) override;
+  core::Value VisitSuperExpression(lamscript::parsed::Super* super) override;
+  core::Value VisitThisExpression(lamscript::parsed::This* this_expr) override;
+  core::Value VisitUnaryExpression(lamscript::parsed::Unary* unary) override;
+  core::Value VisitVariableExpression(
+      lamscript::parsed::Variable* variable) override;
+  core::Value VisitLambdaExpression(
+      lamscript::parsed::LambdaExpression* expression) override;
+
+  lamscript::runtime::Completion VisitBlockStatement(
+      lamscript::parsed::Block* block) override;
+  lamscript::runtime::Completion VisitClassStatement(
+      lamscript::parsed::Class* class_def) override;
+  lamscript::runtime::Completion VisitExpressionStatement(
+      lamscript::parsed::ExpressionStatement* statement) override;
+  lamscript::runtime::Completion VisitFunctionStatement(
+      lamscript::parsed::Function* func) override;
+  lamscript::runtime::Completion VisitIfStatement(
+      lamscript::parsed::If* if_statement) override;
+  lamscript::runtime::Completion VisitPrintStatement(
+      lamscript::parsed::Print* print) override;
+  lamscript::runtime::Completion VisitReturnStatement(
+      lamscript::parsed::Return* return_statement) override;
+  lamscript::runtime::Completion VisitVariableStatement(
+      lamscript::parsed::VariableStatement* variable) override;
+  lamscript::runtime::Completion VisitWhileStatement(
+      lamscript::parsed::While* while_statement) override;
+
+ private:
+  /// @brief A function that's being compiled, the source line that the
+  /// instructions written to it are attributed to, and its temporaries.
+  struct FunctionState {
+    core::Function* Function;
+    size_t Line;
+    /// @brief The next free register.
+    size_t NextRegister;
+    /// @brief The number of registers that the function has needed so far.
+    size_t RegisterCount;
+    /// @brief Whether jumps are written in their Long form.
+    bool LongJumps;
+    /// @brief Whether a jump didn't fit in its short form.
+    bool JumpTooFar;
+    /// @brief Whether an operand of the function has already overflowed.
+    bool ReportedError;
+    /// @brief Whether errors had been reported before the function.
+    bool EnclosingHadError;
+  };
+
+  /// @brief Releases the temporaries allocated within its scope.
+  class TemporaryScope {
+   public:
+    explicit TemporaryScope(RegisterCompiler* compiler)
+        : compiler_(compiler),
+        next_register_(compiler->functions_.back().NextRegister) {}
+
+    ~TemporaryScope() {
+      compiler_->functions_.back().NextRegister = next_register_;
+    }
+
+   private:
+    RegisterCompiler* compiler_;
+    size_t next_register_;
+  };
+
+  /// @brief The functions being compiled, innermost last.
+  std::vector<FunctionState> functions_;
+
+  /// @brief The register that the expression being compiled stores its value
+  /// in.
+  uint8_t target_;
+  /// @brief Whether the target is a variable's register rather than a
+  /// temporary, in which case it can't hold intermediate values that the
+  /// rest of the expression could still read.
+  bool target_is_local_;
+  /// @brief Whether the expression can leave its value in a register other
+  /// than the target, such as the register of the local it reads.
+  bool any_register_;
+  /// @brief The register that the last compiled expression left its value
+  /// in.
+  uint8_t result_;
+  bool had_error_;
+
+  [[nodiscard]] core::Chunk* CurrentChunk();
+
+  void Compile(lamscript::parsed::Statement* statement);
+
+  /// @brief Compiles an expression into the target register.
+  void CompileInto(
+      lamscript::parsed::Expression* expression,
+      uint8_t target,
+      bool target_is_local = false);
+
+  /// @brief Compiles an expression into any register and returns it. The
+  /// register is only valid until the temporaries of the enclosing scope are
+  /// released.
+  [[nodiscard]] uint8_t CompileOperand(
+      lamscript::parsed::Expression* expression);
+
+  /// @brief Compiles statements that report the runtime errors raised within
+  /// them and then skip to the end of the statements, like the blocks and
+  /// function bodies of lamscript's interpreter.
+  void CompileHandledStatements(
+      const std::vector<std::unique_ptr<lamscript::parsed::Statement>>&
+          statements);
+
+  /// @brief Compiles a function declaration into a prototype.
+  [[nodiscard]] core::Ref<core::Function> CompileFunction(
+      lamscript::parsed::Function* declaration, bool is_initializer);
+
+  /// @brief Starts compiling a function whose first local_count registers
+  /// hold its locals, writing its jumps in their Long form if long_jumps is
+  /// set.
+  void PushFunction(
+      core::Function* function, size_t local_count, bool long_jumps);
+
+  /// @brief Finishes compiling the innermost function and sets its frame
+  /// size. Returns whether it has to be compiled again with long jumps because
+  /// one of its jumps didn't fit in a two byte offset.
+  [[nodiscard]] bool PopFunction();
+
+  /// @brief Allocates the next free register as a temporary.
+  [[nodiscard]] uint8_t AllocateRegister();
+
+  /// @brief Stores the value of the register into the target of the
+  /// expression being compiled, unless it can be left where it is.
+  void SetResult(uint8_t source);
+
+  void Emit(core::RegisterOpCode code);
+  void Emit(
+      core::RegisterOpCode code,
+      std::initializer_list<uint8_t> operands);
+
+  /// @brief Writes an instruction that takes an index into the constant pool
+  /// or name table, using its Long form when the index doesn't fit in a byte.
+  void EmitIndexed(
+      core::RegisterOpCode code,
+      uint16_t index,
+      std::initializer_list<uint8_t> operands);
+
+  /// @brief Attributes the instructions written after it to the line of the
+  /// token, so that errors raised by them report it.
+  void SetLine(const lamscript::parsing::Token& token);
+
+  /// @brief Writes a jump with a placeholder offset after the operands and
+  /// returns the index of the offset to patch. Functions that are compiled
+  /// with long jumps use the Long form of every jump, whose offset is four
+  /// bytes.
+  [[nodiscard]] size_t EmitJump(
+      core::RegisterOpCode code,
+      std::initializer_list<uint8_t> operands = {});
+
+  /// @brief Points the jump with the offset at the index at the next
+  /// instruction to be written.
+  void PatchJump(size_t offset_index);
+
+  /// @brief Writes a jump back to the instruction at loop_start.
+  void EmitLoop(size_t loop_start);
+
+  [[nodiscard]] uint16_t MakeConstant(const core::Value& value);
+  [[nodiscard]] uint16_t MakeName(const lamscript::parsing::Token& name);
+
+  /// @brief Checks that a jump's offset fits within its operand. Offsets that
+  /// don't fit in a short jump mark the function to be compiled again with
+  /// long jumps instead of reporting an error.
+  [[nodiscard]] uint32_t MakeJumpOffset(size_t offset, const char* message);
+
+  /// @brief Checks that a value fits within a one byte operand, reporting an
+  /// error if it doesn't and none has been reported in the function yet.
+  [[nodiscard]] uint8_t MakeOperand(size_t value, const char* message);
+
+  /// @brief Checks that a value fits within a two byte operand, reporting an
+  /// error if it doesn't.
+  [[nodiscard]] uint16_t MakeShortOperand(size_t value, const char* message);
+
+  [[nodiscard]] size_t CheckOperand(
+      size_t value, size_t max, const char* message);
+
+  /// @brief Loads the value of the variable at the location that the
+  /// resolver found it at into the target register.
+  void EmitLoad(
+      const lamscript::parsing::Token& name,
+      const lamscript::parsed::VariableLocation& location,
+      uint8_t target);
+
+  /// @brief Assigns the value of the register to the variable at the
+  /// location.
+  void EmitStore(
+      const lamscript::parsing::Token& name,
+      const lamscript::parsed::VariableLocation& location,
+      uint8_t source);
+
+  /// @brief Gives a variable that's about to be declared a new cell if it's
+  /// captured.
+  void EmitDeclare(const lamscript::parsed::VariableLocation& location);
+
+  /// @brief Defines the variable declared at the location with the value of
+  /// the register.
+  void EmitDefine(
+      const lamscript::parsing::Token& name,
+      const lamscript::parsed::VariableLocation& location,
+      uint8_t source);
+
+  /// @brief Compiles the value of a declaration straight into the register
+  /// of the variable when it's a plain local, and into a temporary that's
+  /// then used to define it otherwise.
+  void CompileDefinition(
+      const lamscript::parsing::Token& name,
+      const lamscript::parsed::VariableLocation& location,
+      lamscript::parsed::Expression* value);
+};
+
+}  // namespace lamscripten::compiler
+
+#endif  // SRC_LAMSCRIPTEN_COMPILER_REGISTERCOMPILER_H_
@@ -3,35 +3,282 @@
 
 #include <algorithm>
 #include <cstdint>
+#include <cstring>
+#include <functional>
+#include <memory>
 #include <optional>
+#include <string_view>
+#include <unordered_map>
+#include <utility>
 
+#include <Lamscript/parsing/Symbol.h>
 #include <Lamscripten/core/Memory.h>
+#include <Lamscripten/core/RegisterOpCode.h>
 #include <Lamscripten/core/Types.h>
+#include <Lamscripten/core/Value.h>
 
 namespace lamscripten::core {
 
 /// @brief Opcode types
-enum class OpCode : std::uint16_t {
+///
+/// Instructions operate on a stack of values. Variables declared by a
+/// function live in the frame_size slots at the bottom of its call frame
+/// (methods keep their receiver in slot 0), captured variables are boxed into
+/// cells that are stored alongside their slot, and globals are referenced by
+/// name.
+///
+/// Opcodes and operands are single bytes, except for jump offsets which are
+/// two. Instructions that index the constant pool, the name table, the slots
+/// of the frame or the closure's upvalues take the index as their first
+/// operand and are directly followed by a Long form whose index is two bytes.
+/// Jumps are followed by a Long form whose offset is four bytes, which
+/// functions that are too large for two byte offsets use for all of their
+/// jumps.
+enum class OpCode : std::uint8_t {
   NoOp,
+  /// @brief Returns the value on top of the stack from the current function.
   Return,
+  /// @brief Pushes the constant at the operand's index in the constant pool.
   Constant,
-  NextLine
+  ConstantLong,
+
+  Nil,
+  True,
+  False,
+  Pop,
+
+  /// @brief Pushes the value of the local in the operand's slot.
+  GetLocal,
+  GetLocalLong,
+  /// @brief Stores the top of the stack into the local in the operand's slot
+  /// without popping it.
+  SetLocal,
+  SetLocalLong,
+  /// @brief Gives the local in the operand's slot a new cell, since captured
+  /// variables get a new cell every time their declaration runs.
+  MakeCell,
+  MakeCellLong,
+  GetCell,
+  GetCellLong,
+  SetCell,
+  SetCellLong,
+  /// @brief Pushes the value of the current closure's upvalue at the
+  /// operand's index.
+  GetUpvalue,
+  GetUpvalueLong,
+  SetUpvalue,
+  SetUpvalueLong,
+  /// @brief Pushes the value of the global named by the operand's index in
+  /// the name table.
+  GetGlobal,
+  GetGlobalLong,
+  /// @brief Assigns the top of the stack to an existing global without
+  /// popping it.
+  SetGlobal,
+  SetGlobalLong,
+  /// @brief Pops the top of the stack into a new (or redefined) global.
+  DefineGlobal,
+  DefineGlobalLong,
+
+  /// @brief Replaces the object on top of the stack with the value of its
+  /// named property, binding methods and calling getters.
+  GetProperty,
+  GetPropertyLong,
+  /// @brief Pops a value and the instance below it, sets the named field of
+  /// the instance and pushes the value back.
+  SetProperty,
+  SetPropertyLong,
+  /// @brief Pops a receiver and the super class below it and pushes the named
+  /// method of the super class bound to the receiver.
+  GetSuper,
+  GetSuperLong,
+
+  Equal,
+  NotEqual,
+  Greater,
+  GreaterEqual,
+  Less,
+  LessEqual,
+  Add,
+  Subtract,
+  Multiply,
+  Divide,
+  Modulus,
+  Not,
+  Negate,
+
+  /// @brief Pops and prints the top of the stack.
+  Print,
+
+  /// @brief Jumps forward by the offset's number of bytes.
+  Jump,
+  JumpLong,
+  /// @brief Jumps forward by the offset's number of bytes if the top of the
+  /// stack is falsey, without popping it.
+  JumpIfFalse,
+  JumpIfFalseLong,
+  /// @brief Jumps forward by the offset's number of bytes if the top of the
+  /// stack is truthy, without popping it.
+  JumpIfTrue,
+  JumpIfTrueLong,
+  /// @brief Jumps backwards by the offset's number of bytes.
+  Loop,
+  LoopLong,
+
+  /// @brief Calls the callee below the operand's number of arguments.
+  Call,
+  /// @brief Calls the method named by the first operand of the object below
+  /// the second operand's number of arguments without binding it first.
+  Invoke,
+  InvokeLong,
+  /// @brief Creates a closure of the function prototype at the operand's
+  /// index in the constant pool, capturing the upvalues that it describes.
+  Closure,
+  ClosureLong,
+  /// @brief Creates a class named by the constant at the index from the last
+  /// operand's number of method closures on top of the stack, inheriting from
+  /// the class below them if the second operand is 1. The method count is two
+  /// bytes.
+  Class,
+  ClassLong
+};
+
+/// @brief Gets the Long form of an instruction that takes an index or a jump
+/// offset, which is declared directly after it in both instruction sets.
+template <typename Code>
+[[nodiscard]] constexpr Code GetLongForm(Code code) {
+  return static_cast<Code>(static_cast<uint8_t>(code) + 1);
+}
+
+/// @brief Gets the number of values that a stack instruction pushes minus the
+/// number that it pops. The arguments that Call and Invoke pop and the methods
+/// and super class that Class pops depend on their operands, so they aren't
+/// counted.
+[[nodiscard]] constexpr int GetStackEffect(OpCode code) {
+  switch (code) {
+    case OpCode::Constant:
+    case OpCode::ConstantLong:
+    case OpCode::Nil:
+    case OpCode::True:
+    case OpCode::False:
+    case OpCode::GetLocal:
+    case OpCode::GetLocalLong:
+    case OpCode::GetCell:
+    case OpCode::GetCellLong:
+    case OpCode::GetUpvalue:
+    case OpCode::GetUpvalueLong:
+    case OpCode::GetGlobal:
+    case OpCode::GetGlobalLong:
+    case OpCode::Closure:
+    case OpCode::ClosureLong:
+    case OpCode::Class:
+    case OpCode::ClassLong:
+      return 1;
+    case OpCode::Return:
+    case OpCode::Pop:
+    case OpCode::DefineGlobal:
+    case OpCode::DefineGlobalLong:
+    case OpCode::SetProperty:
+    case OpCode::SetPropertyLong:
+    case OpCode::GetSuper:
+    case OpCode::GetSuperLong:
+    case OpCode::Equal:
+    case OpCode::NotEqual:
+    case OpCode::Greater:
+    case OpCode::GreaterEqual:
+    case OpCode::Less:
+    case OpCode::LessEqual:
+    case OpCode::Add:
+    case OpCode::Subtract:
+    case OpCode::Multiply:
+    case OpCode::Divide:
+    case OpCode::Modulus:
+    case OpCode::Print:
+      return -1;
+    default:
+      return 0;
+  }
+}
+
+/// @brief Reads a two byte operand, which is stored big endian.
+[[nodiscard]] inline uint16_t ReadShort(const uint8_t* bytes) {
+  return static_cast<uint16_t>(bytes[0] << 8 | bytes[1]);
+}
+
+/// @brief Reads a four byte operand, which is stored big endian.
+[[nodiscard]] inline uint32_t ReadLong(const uint8_t* bytes) {
+  return static_cast<uint32_t>(ReadShort(bytes)) << 16 | ReadShort(bytes + 2);
+}
+
+/// @brief The source line of the instructions from Start up to the Start of
+/// the next run in a chunk's line table.
+struct LineRun {
+  size_t Start;
+  size_t Line;
+};
+
+/// @brief The instruction set that a chunk is encoded with.
+enum class InstructionSet {
+  /// @brief OpCode instructions, which operate on a stack of values.
+  Stack,
+  /// @brief RegisterOpCode instructions, which operate on the registers of
+  /// their call frame.
+  Register
+};
+
+/// @brief A range of instructions that handles the runtime errors raised
+/// within it by reporting them and resuming execution at Target, the same
+/// way lamscript's interpreter recovers from errors within blocks.
+struct ErrorHandler {
+  size_t Start;
+  size_t End;
+  size_t Target;
 };
 
 /// @brief A dynamic array of opcodes
 class Chunk {
  public:
-  Chunk() : opcodes_(), constants_() {}
+  explicit Chunk(InstructionSet instruction_set = InstructionSet::Stack)
+      : instruction_set_(instruction_set),
+      opcodes_(),
+      constants_(),
+      constant_indices_(),
+      names_(),
+      name_indices_(),
+      handlers_(),
+      lines_(),
+      mapped_code_(nullptr),
+      mapped_count_(0),
+      mapped_owner_() {}
+
+  [[nodiscard]] InstructionSet GetInstructionSet() const {
+    return instruction_set_;
+  }
 
-  /// @brief Writes an OpCode into the chunk.
-  [[nodiscard]] size_t WriteOpCode(OpCode code) {
-    size_t index = opcodes_.PushMemory(static_cast<uint16_t>(code));
+  /// @brief Writes an OpCode compiled from the source line into the chunk.
+  [[nodiscard]] size_t WriteOpCode(OpCode code, size_t line) {
+    AddLine(line);
+    size_t index = opcodes_.PushMemory(static_cast<uint8_t>(code));
     return index;
   }
 
+  /// @brief Writes a RegisterOpCode compiled from the source line into a
+  /// chunk of register instructions.
+  [[nodiscard]] size_t WriteOpCode(RegisterOpCode code, size_t line) {
+    AddLine(line);
+    size_t index = opcodes_.PushMemory(static_cast<uint8_t>(code));
+    return index;
+  }
+
+  /// @brief Appends a run to the line table. Runs have to be added in the
+  /// order of the instructions that they start at.
+  void AddLineRun(const LineRun& run) {
+    size_t _ = lines_.PushCopy(run);
+  }
+
   /// @brief Returns the start index of where the bytes are written to within
   /// the chunk.
-  [[nodiscard]] size_t WriteBytes(std::initializer_list<uint16_t> bytes) {
+  [[nodiscard]] size_t WriteBytes(std::initializer_list<uint8_t> bytes) {
     size_t start_index = opcodes_.GetCount() - 1;
 
     for (auto byte : bytes) {
@@ -41,55 +288,229 @@ class Chunk {
     return start_index;
   }
 
-  [[nodsicard]] size_t AddConstant(double value) {
-    size_t index = constants_.PushCopy(value);
+  /// @brief Writes a two byte operand and returns the index of its first
+  /// byte.
+  [[nodiscard]] size_t WriteShort(uint16_t value) {
+    size_t index = opcodes_.PushCopy(static_cast<uint8_t>(value >> 8));
+    size_t _ = opcodes_.PushCopy(static_cast<uint8_t>(value & 0xff));
+    return index;
+  }
+
+  /// @brief Overwrites a two byte operand that's already been written, e.g. to
+  /// patch the offset of a jump once its target is known.
+  void PatchShort(size_t index, uint16_t value) {
+    opcodes_.SetAtIndex(index, static_cast<uint8_t>(value >> 8));
+    opcodes_.SetAtIndex(index + 1, static_cast<uint8_t>(value & 0xff));
+  }
+
+  /// @brief Writes a four byte operand and returns the index of its first
+  /// byte.
+  [[nodiscard]] size_t WriteLong(uint32_t value) {
+    size_t index = WriteShort(static_cast<uint16_t>(value >> 16));
+    size_t _ = WriteShort(static_cast<uint16_t>(value & 0xffff));
     return index;
   }
 
+  void PatchLong(size_t index, uint32_t value) {
+    PatchShort(index, static_cast<uint16_t>(value >> 16));
+    PatchShort(index + 2, static_cast<uint16_t>(value & 0xffff));
+  }
+
+  /// @brief Adds a constant to the pool and returns its index. A constant
+  /// that's equal to one already in the pool reuses its entry, so a literal
+  /// that's used many times within a function is only stored once.
+  [[nodiscard]] size_t AddConstant(const Value& value) {
+    auto [entry, inserted] = constant_indices_.try_emplace(
+        MakeConstantKey(value), constants_.GetCount());
+
+    if (inserted) {
+      size_t _ = constants_.PushCopy(value);
+    }
+
+    return entry->second;
+  }
+
+  /// @brief Adds the name of a global or property that instructions refer to
+  /// by its index, reusing its index if it's already been added.
+  [[nodiscard]] size_t AddName(lamscript::parsing::Symbol name) {
+    auto [entry, inserted] = name_indices_.try_emplace(
+        name, names_.GetCount());
+
+    if (inserted) {
+      size_t _ = names_.PushCopy(name);
+    }
+
+    return entry->second;
+  }
+
+  void AddErrorHandler(const ErrorHandler& handler) {
+    size_t _ = handlers_.PushCopy(handler);
+  }
+
+  /// @brief Runs code that's stored outside of the chunk, such as code that's
+  /// mapped from a cache file, instead of the code written to it. The owner
+  /// keeps the code alive for as long as the chunk is.
+  void AdoptCode(
+      const uint8_t* code, size_t count, std::shared_ptr<const void> owner) {
+    mapped_code_ = code;
+    mapped_count_ = count;
+    mapped_owner_ = std::move(owner);
+  }
+
   [[nodiscard]] size_t GetOpCodeCount() const {
-    return opcodes_.GetCount();
+    return mapped_code_ != nullptr ? mapped_count_ : opcodes_.GetCount();
   }
 
-  [[nodiscard]] DynamicArray<uint16_t> GetBytesFromLine(size_t line) {
-    DynamicArray<uint16_t> bytes;
-    size_t line_count = 0;
+  /// @brief Gets the bytes of the instructions that were compiled from the
+  /// source line, in the order that they appear in the chunk.
+  [[nodiscard]] DynamicArray<uint8_t> GetBytesFromLine(size_t line) const {
+    DynamicArray<uint8_t> bytes;
 
-    for (auto& byte : opcodes_) {
-      if (line == line_count) {
-        bytes.PushCopy(byte);
-      }
-      if (line > line_count) {
-        return bytes;
+    for (size_t run = 0; run < lines_.GetCount(); run++) {
+      if (lines_.begin()[run].Line != line) {
+        continue;
       }
 
-      if (static_cast<OpCode>(byte) == OpCode::NextLine) {
-        line_count += 1;
+      size_t end = run + 1 < lines_.GetCount()
+          ? lines_.begin()[run + 1].Start : GetOpCodeCount();
+
+      for (size_t i = lines_.begin()[run].Start; i < end; i++) {
+        size_t _ = bytes.PushCopy(GetCode()[i]);
       }
     }
 
     return bytes;
   }
 
-  [[nodiscard]] std::optional<uint16_t> GetOpcodeAt(size_t index) const {
-    return opcodes_.GetAtIndex(index);
+  /// @brief Gets the source line of the instruction that the byte at the
+  /// index belongs to by binary searching the line table.
+  [[nodiscard]] size_t GetLineAt(size_t index) const {
+    const LineRun* run = std::upper_bound(
+        lines_.begin(), lines_.end(), index,
+        [](size_t target, const LineRun& run) { return target < run.Start; });
+
+    return run == lines_.begin() ? 0 : run[-1].Line;
+  }
+
+  [[nodiscard]] const DynamicArray<LineRun>& GetLineRuns() const {
+    return lines_;
+  }
+
+  [[nodiscard]] std::optional<uint8_t> GetOpcodeAt(size_t index) const {
+    if (index < GetOpCodeCount()) {
+      return GetCode()[index];
+    }
+    return std::nullopt;
   }
 
-  [[nodiscard]] std::optional<double> GetConstantAt(size_t index) const {
+  [[nodiscard]] std::optional<Value> GetConstantAt(size_t index) const {
     return constants_.GetAtIndex(index);
   }
 
-  [[nodiscard]] auto begin() const {
-    return opcodes_.begin();
+  [[nodiscard]] size_t GetConstantCount() const {
+    return constants_.GetCount();
   }
 
-  [[nodiscard]] auto end() const {
-    return opcodes_.end();
+  [[nodiscard]] std::optional<lamscript::parsing::Symbol> GetNameAt(
+      size_t index) const {
+    return names_.GetAtIndex(index);
+  }
+
+  [[nodiscard]] const DynamicArray<ErrorHandler>& GetErrorHandlers() const {
+    return handlers_;
+  }
+
+  /// @brief Unchecked access to the code and tables of the chunk for the
+  /// virtual machine, which only follows indices that the compiler wrote.
+  [[nodiscard]] const uint8_t* GetCode() const {
+    return mapped_code_ != nullptr ? mapped_code_ : opcodes_.begin();
+  }
+  [[nodiscard]] const Value* GetConstants() const {
+    return constants_.begin();
+  }
+  [[nodiscard]] const lamscript::parsing::Symbol* GetNames() const {
+    return names_.begin();
+  }
+
+  [[nodiscard]] const uint8_t* begin() const {
+    return GetCode();
+  }
+
+  [[nodiscard]] const uint8_t* end() const {
+    return GetCode() + GetOpCodeCount();
   }
 
  private:
-  DynamicArray<uint16_t> opcodes_;
-  DynamicArray<double> constants_;
-  size_t line_count_;
+  /// @brief Identifies a constant by what it holds. Strings are compared by
+  /// their text and every other value by its type and bits, which makes
+  /// function prototypes equal only to themselves.
+  struct ConstantKey {
+    ValueType Type;
+    uint64_t Bits;
+    std::string_view Text;
+
+    bool operator==(const ConstantKey& other) const {
+      return Type == other.Type && Bits == other.Bits && Text == other.Text;
+    }
+  };
+
+  struct ConstantKeyHash {
+    size_t operator()(const ConstantKey& key) const {
+      return std::hash<std::string_view>()(key.Text)
+          ^ std::hash<uint64_t>()(key.Bits) * 31
+          ^ static_cast<size_t>(key.Type);
+    }
+  };
+
+  InstructionSet instruction_set_;
+  DynamicArray<uint8_t> opcodes_;
+  DynamicArray<Value> constants_;
+  /// @brief The index of every constant in the pool. String keys view the
+  /// text of the strings in the pool, which keeps them alive.
+  std::unordered_map<ConstantKey, size_t, ConstantKeyHash> constant_indices_;
+  DynamicArray<lamscript::parsing::Symbol> names_;
+  lamscript::parsing::SymbolMap<size_t> name_indices_;
+  DynamicArray<ErrorHandler> handlers_;
+  /// @brief Run length encoded lines, which only get a new run when an
+  /// instruction's line differs from the line of the one before it.
+  DynamicArray<LineRun> lines_;
+  const uint8_t* mapped_code_;
+  size_t mapped_count_;
+  std::shared_ptr<const void> mapped_owner_;
+
+  [[nodiscard]] static ConstantKey MakeConstantKey(const Value& value) {
+    ConstantKey key{value.GetType(), 0, {}};
+
+    switch (value.GetType()) {
+      case ValueType::Nil:
+        break;
+      case ValueType::Boolean:
+        key.Bits = value.AsBoolean() ? 1 : 0;
+        break;
+      case ValueType::Number: {
+        double number = value.AsNumber();
+        std::memcpy(&key.Bits, &number, sizeof(number));
+        break;
+      }
+      case ValueType::String:
+        key.Text = value.AsString();
+        break;
+      case ValueType::Callable:
+      case ValueType::Instance:
+        key.Bits = reinterpret_cast<uintptr_t>(
+            value.AsObject<lamscript::parsed::LamscriptObject>());
+        break;
+    }
+
+    return key;
+  }
+
+  void AddLine(size_t line) {
+    if (lines_.GetCount() == 0
+        || lines_.begin()[lines_.GetCount() - 1].Line != line) {
+      AddLineRun(LineRun{opcodes_.GetCount(), line});
+    }
+  }
 };
 
 }  // namespace lamscripten::core
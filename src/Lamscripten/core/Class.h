@@ -0,0 +1,135 @@
+#ifndef SRC_LAMSCRIPTEN_CORE_CLASS_H_
+#define SRC_LAMSCRIPTEN_CORE_CLASS_H_
+
+#include <string>
+#include <utility>
+#include <vector>
+
+#include <Lamscript/parsed/Shape.h>
+#include <Lamscript/parsing/Symbol.h>
+#include <Lamscripten/core/Closure.h>
+#include <Lamscripten/core/Value.h>
+
+namespace lamscripten::core {
+
+/// @brief A class created by Lamscripten.
+///
+/// Like lamscript's classes, the method table is flattened when the class is
+/// created so looking up a method never walks the inheritance chain, and
+/// instances lay out their fields by shape.
+class Class : public Object {
+ public:
+  static constexpr ValueType kValueType = ValueType::Callable;
+
+  Class(
+      std::string name,
+      Ref<Class> super_class,
+      lamscript::parsing::SymbolMap<Ref<Closure>>&& methods)
+          : Object(ObjectKind::Class),
+          name_(std::move(name)),
+          super_class_(std::move(super_class)),
+          methods_(std::move(methods)),
+          constructor_(nullptr),
+          root_shape_(lamscript::parsed::MakeRef<lamscript::parsed::Shape>()) {
+    if (super_class_ != nullptr) {
+      // Doesn't replace methods that this class overrides.
+      methods_.insert(
+          super_class_->methods_.begin(), super_class_->methods_.end());
+    }
+
+    constructor_ = LookupMethod(
+        lamscript::parsing::Symbol::Intern("constructor"));
+  }
+
+  /// @brief Looks up a method of the class or any of its super classes.
+  /// Returns a nullptr if the class doesn't have the method.
+  [[nodiscard]] Closure* LookupMethod(
+      lamscript::parsing::Symbol method_name) const {
+    auto lookup = methods_.find(method_name);
+
+    if (lookup != methods_.end()) {
+      return lookup->second.get();
+    }
+
+    return nullptr;
+  }
+
+  [[nodiscard]] Closure* GetConstructor() const { return constructor_; }
+
+  /// @brief Adds a method to the class, overriding the method of a super
+  /// class with the same name.
+  void AddMethod(Ref<Closure> method) {
+    lamscript::parsing::Symbol name = lamscript::parsing::Symbol::Intern(
+        method->GetFunction()->GetName());
+
+    if (name == lamscript::parsing::Symbol::Intern("constructor")) {
+      constructor_ = method.get();
+    }
+
+    methods_.insert_or_assign(name, std::move(method));
+  }
+
+  /// @brief Gets the shape of instances that don't have any fields yet.
+  [[nodiscard]] lamscript::parsed::Shape* GetRootShape() const {
+    return root_shape_.get();
+  }
+
+  [[nodiscard]] std::string ToString() const override { return name_; }
+
+ private:
+  std::string name_;
+  Ref<Class> super_class_;
+  lamscript::parsing::SymbolMap<Ref<Closure>> methods_;
+  Closure* constructor_;
+  Ref<lamscript::parsed::Shape> root_shape_;
+};
+
+/// @brief Instance of a class created by Lamscripten.
+class Instance : public Object {
+ public:
+  static constexpr ValueType kValueType = ValueType::Instance;
+
+  explicit Instance(Class* class_def)
+      : Object(ObjectKind::Instance),
+      class_def_(class_def),
+      shape_(class_def->GetRootShape()) {}
+
+  [[nodiscard]] Class* GetClass() const { return class_def_.get(); }
+
+  /// @brief Finds a field without falling back to the methods of the class.
+  /// Returns a nullptr if the instance has no field with the given name.
+  [[nodiscard]] const Value* FindField(
+      lamscript::parsing::Symbol name) const {
+    size_t slot = shape_->FindSlot(name);
+    if (slot != lamscript::parsed::Shape::kNotFound) {
+      return &fields_[slot];
+    }
+
+    return nullptr;
+  }
+
+  void SetField(lamscript::parsing::Symbol name, const Value& value) {
+    size_t slot = shape_->FindSlot(name);
+    if (slot != lamscript::parsed::Shape::kNotFound) {
+      fields_[slot] = value;
+      return;
+    }
+
+    shape_ = shape_->AddField(name);
+    fields_.push_back(value);
+  }
+
+  [[nodiscard]] std::string ToString() const override {
+    return class_def_->ToString() + " Instance";
+  }
+
+ private:
+  Ref<Class> class_def_;
+  /// @brief Owned by the class's root shape, which the class keeps alive.
+  lamscript::parsed::Shape* shape_;
+  std::vector<Value> fields_;
+};
+
+}  // namespace lamscripten::core
+
+#endif  // SRC_LAMSCRIPTEN_CORE_CLASS_H_
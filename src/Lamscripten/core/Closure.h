@@ -0,0 +1,68 @@
+#ifndef SRC_LAMSCRIPTEN_CORE_CLOSURE_H_
+#define SRC_LAMSCRIPTEN_CORE_CLOSURE_H_
+
+#include <string>
+#include <utility>
+#include <vector>
+
+#include <Lamscript/runtime/Cell.h>
+#include <Lamscripten/core/Function.h>
+#include <Lamscripten/core/Value.h>
+
+namespace lamscripten::core {
+
+/// @brief A function along with the cells of the variables that it captured
+/// when it was created.
+class Closure : public Object {
+ public:
+  static constexpr ValueType kValueType = ValueType::Callable;
+
+  Closure(
+      Ref<Function> function,
+      std::vector<Ref<lamscript::runtime::Cell>> upvalues)
+          : Object(ObjectKind::Closure),
+          function_(std::move(function)),
+          upvalues_(std::move(upvalues)) {}
+
+  [[nodiscard]] const Function* GetFunction() const { return function_.get(); }
+
+  [[nodiscard]] const std::vector<Ref<lamscript::runtime::Cell>>&
+      GetUpvalues() const {
+    return upvalues_;
+  }
+
+  [[nodiscard]] std::string ToString() const override {
+    return function_->ToString();
+  }
+
+ private:
+  Ref<Function> function_;
+  std::vector<Ref<lamscript::runtime::Cell>> upvalues_;
+};
+
+/// @brief A method that's been read off of its receiver, which it's called
+/// with later on. Static methods are bound to nil.
+class BoundMethod : public Object {
+ public:
+  static constexpr ValueType kValueType = ValueType::Callable;
+
+  BoundMethod(Value receiver, Ref<Closure> method)
+      : Object(ObjectKind::BoundMethod),
+      receiver_(std::move(receiver)),
+      method_(std::move(method)) {}
+
+  [[nodiscard]] const Value& GetReceiver() const { return receiver_; }
+  [[nodiscard]] Closure* GetMethod() const { return method_.get(); }
+
+  [[nodiscard]] std::string ToString() const override {
+    return method_->ToString();
+  }
+
+ private:
+  Value receiver_;
+  Ref<Closure> method_;
+};
+
+}  // namespace lamscripten::core
+
+#endif  // SRC_LAMSCRIPTEN_CORE_CLOSURE_H_
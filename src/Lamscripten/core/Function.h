@@ -0,0 +1,100 @@
+#ifndef SRC_LAMSCRIPTEN_CORE_FUNCTION_H_
+#define SRC_LAMSCRIPTEN_CORE_FUNCTION_H_
+
+#include <string>
+#include <utility>
+#include <vector>
+
+#include <Lamscript/parsed/Statement.h>
+#include <Lamscripten/core/Chunk.h>
+#include <Lamscripten/core/Value.h>
+
+namespace lamscripten::core {
+
+/// @brief A compiled function. Functions are prototypes stored in the
+/// constant pool of the chunk that creates closures of them, and hold
+/// everything that's needed to call them.
+class Function : public Object {
+ public:
+  static constexpr ValueType kValueType = ValueType::Callable;
+
+  Function(
+      std::string name,
+      int arity,
+      size_t frame_size,
+      lamscript::parsed::FunctionMetadata metadata,
+      bool is_initializer,
+      InstructionSet instruction_set = InstructionSet::Stack)
+          : Object(ObjectKind::Function),
+          name_(std::move(name)),
+          arity_(arity),
+          frame_size_(frame_size),
+          metadata_(metadata),
+          is_initializer_(is_initializer),
+          stack_depth_(0),
+          chunk_(instruction_set) {}
+
+  [[nodiscard]] const std::string& GetName() const { return name_; }
+  [[nodiscard]] int GetArity() const { return arity_; }
+
+  /// @brief The number of slots that the parameters and locals of a call to
+  /// the function need at the bottom of its call frame.
+  [[nodiscard]] size_t GetFrameSize() const { return frame_size_; }
+
+  /// @brief Grows the frame to also hold the temporaries of the function's
+  /// expressions, which register instructions address like locals.
+  void SetFrameSize(size_t frame_size) { frame_size_ = frame_size; }
+
+  /// @brief The most temporaries that the function's stack instructions have
+  /// above its frame at once, which calls check that the stack has room for.
+  [[nodiscard]] size_t GetStackDepth() const { return stack_depth_; }
+  void SetStackDepth(size_t stack_depth) { stack_depth_ = stack_depth; }
+
+  [[nodiscard]] bool IsMethod() const { return metadata_.IsMethod; }
+  [[nodiscard]] bool IsStatic() const { return metadata_.IsStatic; }
+  [[nodiscard]] bool IsGetter() const { return metadata_.IsGetter; }
+  [[nodiscard]] bool IsInitializer() const { return is_initializer_; }
+
+  [[nodiscard]] Chunk* GetChunk() { return &chunk_; }
+  [[nodiscard]] const Chunk& GetChunk() const { return chunk_; }
+
+  /// @brief Where closures of the function capture each of their upvalues
+  /// from.
+  [[nodiscard]] const std::vector<lamscript::parsed::UpvalueMetadata>&
+      GetUpvalues() const {
+    return upvalues_;
+  }
+
+  void SetUpvalues(std::vector<lamscript::parsed::UpvalueMetadata> upvalues) {
+    upvalues_ = std::move(upvalues);
+  }
+
+  /// @brief The slots of parameters that are captured by closures, which are
+  /// moved into cells when the function is called.
+  [[nodiscard]] const std::vector<size_t>& GetCapturedParameters() const {
+    return captured_parameters_;
+  }
+
+  void SetCapturedParameters(std::vector<size_t> slots) {
+    captured_parameters_ = std::move(slots);
+  }
+
+  [[nodiscard]] std::string ToString() const override {
+    return "<fn " + name_ + ">";
+  }
+
+ private:
+  std::string name_;
+  int arity_;
+  size_t frame_size_;
+  lamscript::parsed::FunctionMetadata metadata_;
+  bool is_initializer_;
+  size_t stack_depth_;
+  Chunk chunk_;
+  std::vector<lamscript::parsed::UpvalueMetadata> upvalues_;
+  std::vector<size_t> captured_parameters_;
+};
+
+}  // namespace lamscripten::core
+
+#endif  // SRC_LAMSCRIPTEN_CORE_FUNCTION_H_
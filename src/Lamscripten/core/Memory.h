@@ -1,24 +1,77 @@
 #ifndef SRC_LAMSCRIPTEN_CORE_MEMORY_H_
 #define SRC_LAMSCRIPTEN_CORE_MEMORY_H_
 
-#include <algorithm>
+#include <cstddef>
+#include <cstdlib>
+#include <memory>
+#include <type_traits>
 
-/// @brief Reallocate memory for an array that wants to change in size.
+/// @brief Allocates the storage of arrays from the heap. Allocators are
+/// classes with static Allocate, Reallocate and Free functions that work in
+/// bytes, so that arrays can be given storage from elsewhere (e.g. an arena)
+/// by passing them a different one.
+///
+/// Reallocate is only used for arrays of trivially copyable types and moves
+/// the contents itself, which lets realloc extend allocations in place or,
+/// for large ones, remap their pages instead of copying them.
+struct HeapAllocator {
+  [[nodiscard]] static void* Allocate(size_t bytes) {
+    return std::malloc(bytes);
+  }
+
+  [[nodiscard]] static void* Reallocate(
+      void* memory, size_t /* old_bytes */, size_t new_bytes) {
+    return std::realloc(memory, new_bytes);
+  }
+
+  static void Free(void* memory, size_t /* bytes */) {
+    std::free(memory);
+  }
+};
+
+/// @brief Reallocate memory for an array that wants to change in capacity.
+/// The first count elements are moved into the new memory and the rest of it
+/// is left uninitialized, so callers construct elements as they add them.
+/// Capacities smaller than count destroy the elements that don't fit.
 /// @tparam ArrayType The array type to allocate new memory for.
-template<class ArrayType>
+/// @tparam Allocator The allocator that the array's memory comes from.
+template<class ArrayType, class Allocator = HeapAllocator>
 ArrayType* ReallocateArray(
-    ArrayType* array, size_t old_count, size_t new_count) {
-  if (new_count == 0) {
-    delete[] array;
+    ArrayType* array, size_t count, size_t old_capacity, size_t new_capacity) {
+  static_assert(
+      alignof(ArrayType) <= alignof(std::max_align_t),
+      "Arrays of over-aligned types aren't supported.");
+
+  if (new_capacity < count) {
+    std::destroy_n(array + new_capacity, count - new_capacity);
+    count = new_capacity;
+  }
+
+  if (new_capacity == 0) {
+    if (array) {
+      Allocator::Free(array, old_capacity * sizeof(ArrayType));
+    }
     return nullptr;
   }
 
-  ArrayType* new_array = new ArrayType[new_count];
-  std::copy_n(array, old_count, new_array);
+  ArrayType* new_array = nullptr;
+
+  if constexpr (std::is_trivially_copyable_v<ArrayType>) {
+    new_array = static_cast<ArrayType*>(array
+        ? Allocator::Reallocate(
+            array,
+            old_capacity * sizeof(ArrayType),
+            new_capacity * sizeof(ArrayType))
+        : Allocator::Allocate(new_capacity * sizeof(ArrayType)));
+  } else {
+    new_array = static_cast<ArrayType*>(
+        Allocator::Allocate(new_capacity * sizeof(ArrayType)));
 
-  // If the old array still exists, delete it.
-  [[likely]] if (array) {
-    delete[] array;
+    [[likely]] if (new_array && array) {
+      std::uninitialized_move_n(array, count, new_array);
+      std::destroy_n(array, count);
+      Allocator::Free(array, old_capacity * sizeof(ArrayType));
+    }
   }
 
   // If allocation fails, exit.
@@ -29,9 +82,10 @@ ArrayType* ReallocateArray(
   return new_array;
 }
 
-template<class ArrayType>
-void FreeArray(ArrayType* array, size_t current_count) {
-  ReallocateArray<ArrayType>(array, current_count, 0);
+/// @brief Destroys the elements of an array and frees its memory.
+template<class ArrayType, class Allocator = HeapAllocator>
+void FreeArray(ArrayType* array, size_t count, size_t capacity) {
+  ReallocateArray<ArrayType, Allocator>(array, count, capacity, 0);
 }
 
 #endif  // SRC_LAMSCRIPTEN_CORE_MEMORY_H_
@@ -0,0 +1,47 @@
+#ifndef SRC_LAMSCRIPTEN_CORE_NATIVE_H_
+#define SRC_LAMSCRIPTEN_CORE_NATIVE_H_
+
+#include <chrono>
+#include <string>
+
+#include <Lamscripten/core/Value.h>
+
+namespace lamscripten::core {
+
+/// @brief A function implemented in C++ that's called with its arguments in
+/// place on the stack of the virtual machine.
+class NativeFunction : public Object {
+ public:
+  static constexpr ValueType kValueType = ValueType::Callable;
+
+  using Implementation = Value (*)(const Value* arguments);
+
+  NativeFunction(int arity, Implementation implementation)
+      : Object(ObjectKind::Native),
+      arity_(arity),
+      implementation_(implementation) {}
+
+  [[nodiscard]] int GetArity() const { return arity_; }
+
+  [[nodiscard]] Value Call(const Value* arguments) const {
+    return implementation_(arguments);
+  }
+
+  [[nodiscard]] std::string ToString() const override {
+    return "<native fn>";
+  }
+
+ private:
+  int arity_;
+  Implementation implementation_;
+};
+
+/// @brief Matches lamscript's clock global.
+inline Value Clock(const Value* arguments) {
+  return static_cast<double>(
+      std::chrono::high_resolution_clock::now().time_since_epoch().count());
+}
+
+}  // namespace lamscripten::core
+
+#endif  // SRC_LAMSCRIPTEN_CORE_NATIVE_H_
@@ -0,0 +1,136 @@
+#ifndef SRC_LAMSCRIPTEN_CORE_REGISTEROPCODE_H_
+#define SRC_LAMSCRIPTEN_CORE_REGISTEROPCODE_H_
+
+#include <cstdint>
+
+namespace lamscripten::core {
+
+/// @brief Opcode types of the register based instruction set.
+///
+/// Instructions name the registers of the running call frame that they read
+/// and write, so an operation and the moves around it are a single
+/// instruction. A frame's registers are the slots that the resolver assigned
+/// to its parameters and locals followed by the temporaries of its
+/// expressions.
+///
+/// Opcodes and operands are single bytes, except for jump offsets which are
+/// two. Instructions that index the constant pool, the name table or the
+/// closure's upvalues take the index as their first operand and are directly
+/// followed by a Long form whose index is two bytes. Destinations come after
+/// the index. Jumps are followed by a Long form whose offset is four bytes,
+/// which functions that are too large for two byte offsets use for all of
+/// their jumps.
+enum class RegisterOpCode : std::uint8_t {
+  NoOp,
+  /// @brief Returns the value of the register.
+  Return,
+
+  /// @brief Copies the second register into the first.
+  Move,
+  /// @brief Loads the constant at the index in the constant pool into the
+  /// register.
+  LoadConstant,
+  LoadConstantLong,
+  LoadNil,
+  LoadTrue,
+  LoadFalse,
+
+  /// @brief Gives the local in the operand's slot a new cell, since captured
+  /// variables get a new cell every time their declaration runs.
+  MakeCell,
+  /// @brief Loads the value of the cell of the second operand's slot.
+  GetCell,
+  /// @brief Stores the register in the second operand into the cell of the
+  /// first operand's slot.
+  SetCell,
+  /// @brief Loads the value of the upvalue at the index into the register.
+  GetUpvalue,
+  GetUpvalueLong,
+  /// @brief Stores the register into the upvalue at the index.
+  SetUpvalue,
+  SetUpvalueLong,
+  /// @brief Loads the global named by the index in the name table into the
+  /// register.
+  GetGlobal,
+  GetGlobalLong,
+  /// @brief Assigns the register to an existing global.
+  SetGlobal,
+  SetGlobalLong,
+  /// @brief Defines a new (or redefined) global from the register.
+  DefineGlobal,
+  DefineGlobalLong,
+
+  /// @brief Loads the named property of the object in the second register
+  /// into the first, binding methods and calling getters.
+  GetProperty,
+  GetPropertyLong,
+  /// @brief Sets the named field of the instance in the first register to
+  /// the value of the second register.
+  SetProperty,
+  SetPropertyLong,
+  /// @brief Loads the named method of the super class in the second register
+  /// bound to the receiver in the third register into the first.
+  GetSuper,
+  GetSuperLong,
+
+  /// @brief Binary operations store the result of their second and third
+  /// registers into their first.
+  Equal,
+  NotEqual,
+  Greater,
+  GreaterEqual,
+  Less,
+  LessEqual,
+  Add,
+  Subtract,
+  Multiply,
+  Divide,
+  Modulus,
+  Not,
+  Negate,
+
+  Print,
+
+  /// @brief Jumps forward by the offset's number of bytes.
+  Jump,
+  JumpLong,
+  /// @brief Jumps forward by the offset's number of bytes if the register is
+  /// falsey.
+  JumpIfFalse,
+  JumpIfFalseLong,
+  /// @brief Jumps forward by the offset's number of bytes if the register is
+  /// truthy.
+  JumpIfTrue,
+  JumpIfTrueLong,
+  /// @brief Jumps backwards by the offset's number of bytes.
+  Loop,
+  LoopLong,
+
+  /// @brief Calls the callee in the register with the second operand's number
+  /// of arguments in the registers after it, and stores the result in the
+  /// callee's register.
+  Call,
+  /// @brief Calls the named method of the object in the register with the
+  /// third operand's number of arguments in the registers after it without
+  /// binding it first, and stores the result in the object's register.
+  Invoke,
+  InvokeLong,
+  /// @brief Loads a closure of the function prototype at the index in the
+  /// constant pool into the register.
+  Closure,
+  ClosureLong,
+  /// @brief Creates a class without methods named by the constant at the
+  /// index and stores it in the register. If the third operand is 1, the
+  /// register holds the super class, which the class is derived from.
+  Class,
+  ClassLong,
+  /// @brief Adds the method closure in the second register to the class in
+  /// the first, replacing any method with the same name that it inherited.
+  /// Classes are given their methods one at a time so that they don't need a
+  /// register for each of them.
+  Method
+};
+
+}  // namespace lamscripten::core
+
+#endif  // SRC_LAMSCRIPTEN_CORE_REGISTEROPCODE_H_
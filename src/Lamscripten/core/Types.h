@@ -1,13 +1,23 @@
 #ifndef SRC_LAMSCRIPTEN_CORE_TYPES_H_
 #define SRC_LAMSCRIPTEN_CORE_TYPES_H_
 
+#include <cassert>
+#include <initializer_list>
+#include <memory>
+#include <new>
 #include <optional>
+#include <utility>
 
 #include <Lamscripten/core/Memory.h>
 
 namespace lamscripten::core {
 
-template<class ValueType>
+/// @brief An array that grows as elements are pushed onto it. Only the
+/// elements that have been pushed are constructed, and growing moves them
+/// into the new memory (or reallocates it outright for trivially copyable
+/// types) instead of copying them.
+/// @tparam Allocator The allocator that the array's memory comes from.
+template<class ValueType, class Allocator = HeapAllocator>
 class DynamicArray {
  public:
   DynamicArray()
@@ -16,58 +26,55 @@ class DynamicArray {
       elements_(nullptr) {}
 
   ~DynamicArray() {
-    FreeArray<ValueType>(elements_, count_);
+    FreeArray<ValueType, Allocator>(elements_, count_, capacity_);
   }
 
-  /// @brief Allocate an array double the size of the input list
+  /// @brief Copy the values of the list into an array that fits them.
   explicit DynamicArray(std::initializer_list<ValueType> values)
       : count_(0), capacity_(0), elements_(nullptr) {
-    for (auto value : values) {
-      PushCopy(value);
+    GrowTo(values.size());
+    for (const auto& value : values) {
+      size_t _ = PushCopy(value);
     }
   }
 
-  /// @brief Copy the array elements. Creates new memory for the newly
-  /// constructed
+  /// @brief Copy the array elements into new memory that's only as large as
+  /// the array being copied needs.
   DynamicArray(const DynamicArray& array)
       : count_(0), capacity_(0), elements_(nullptr) {
-    ResizeTo(array.capacity_);
-    for (auto value : array) {
-      PushCopy(value);
-    }
+    GrowTo(array.count_);
+    std::uninitialized_copy_n(array.elements_, array.count_, elements_);
+    count_ = array.count_;
   }
 
-  DynamicArray(DynamicArray&& array) :
-      count_(std::move(array.count_)),
-      capacity_(std::move(array.capacity_)),
+  DynamicArray(DynamicArray&& array) noexcept
+      : count_(std::exchange(array.count_, 0)),
+      capacity_(std::exchange(array.capacity_, 0)),
       elements_(std::exchange(array.elements_, nullptr)) {}
 
+  DynamicArray& operator=(const DynamicArray& array) {
+    DynamicArray copy(array);
+    Swap(copy);
+    return *this;
+  }
 
-  void operator=(const DynamicArray& array) {
-    count_ = array.count_;
-    capacity_ = array.capacity_;
-    elements_ = array.elements_;
+  DynamicArray& operator=(DynamicArray&& array) noexcept {
+    DynamicArray moved(std::move(array));
+    Swap(moved);
+    return *this;
   }
 
   /// @brief Push an item into the array.
   [[nodiscard]] size_t PushCopy(ValueType val) {
-    [[unlikely]] if (ShouldResize()) {
-      size_t new_size = capacity_ < 8 ? 8 : capacity_ * 2;
-      ResizeTo(new_size);
-    }
-
-    elements_[count_] = val;
-    count_ += 1;
-    return count_ - 1;
+    return PushMemory(std::move(val));
   }
 
   [[nodiscard]] size_t PushMemory(ValueType&& val) {
-    if (ShouldResize()) {
-      size_t new_size = capacity_ < 8 ? 8 : capacity_ * 2;
-      ResizeTo(new_size);
+    [[unlikely]] if (ShouldResize()) {
+      ResizeTo(GetGrownCapacity());
     }
 
-    elements_[count_] = val;
+    new (elements_ + count_) ValueType(std::move(val));
     count_ += 1;
     return count_ - 1;
   }
@@ -78,31 +85,37 @@ class DynamicArray {
       return std::nullopt;
     }
 
-    // Dereference and copy.
-    ValueType val = elements_[count_ - 1];
     count_ -= 1;
+    ValueType val = std::move(elements_[count_]);
+    std::destroy_at(elements_ + count_);
 
     return val;
   }
 
+  /// @brief Reserves memory for at least new_size elements.
   void GrowTo(size_t new_size) {
-    [[unlikely]] if (new_size < count_ || new_size < capacity_) {
+    [[unlikely]] if (new_size <= capacity_) {
       return;
     }
     ResizeTo(new_size);
   }
 
+  /// @brief Releases the memory past new_size elements, which can't be less
+  /// than the number of elements in the array.
   void ShrinkTo(size_t new_size) {
-    [[unlikely]] if (new_size > count_ || new_size < capacity_) {
+    [[unlikely]] if (new_size < count_ || new_size >= capacity_) {
       return;
     }
     ResizeTo(new_size);
   }
 
+  /// @brief Changes the capacity of the array, destroying the elements that
+  /// no longer fit.
   void ResizeTo(size_t new_size) {
-    size_t old_capacity = capacity_;
+    elements_ = ReallocateArray<ValueType, Allocator>(
+        elements_, count_, capacity_, new_size);
     capacity_ = new_size;
-    elements_ = ReallocateArray<ValueType>(elements_, old_capacity, capacity_);
+    count_ = count_ < new_size ? count_ : new_size;
   }
 
   size_t GetElementSize() const {
@@ -113,6 +126,10 @@ class DynamicArray {
     return count_;
   }
 
+  size_t GetCapacity() const {
+    return capacity_;
+  }
+
   [[nodiscard]] auto begin() const {
     return elements_;
   }
@@ -128,6 +145,14 @@ class DynamicArray {
     return std::nullopt;
   }
 
+  /// @brief Overwrite an item that's already in the array. Indices past the
+  /// end of the array are ignored.
+  void SetAtIndex(size_t index, ValueType val) {
+    if (index < count_) {
+      elements_[index] = std::move(val);
+    }
+  }
+
  private:
   size_t count_;
   size_t capacity_;
@@ -136,13 +161,103 @@ class DynamicArray {
   bool ShouldResize() const {
     return capacity_ < count_ + 1;
   }
+
+  /// @brief Doubles the capacity, starting from room for 8 elements.
+  size_t GetGrownCapacity() const {
+    return capacity_ < 8 ? 8 : capacity_ * 2;
+  }
+
+  void Swap(DynamicArray& other) noexcept {
+    std::swap(count_, other.count_);
+    std::swap(capacity_, other.capacity_);
+    std::swap(elements_, other.elements_);
+  }
 };
 
-/// @brief Allocate an array of data on the stack.
+/// @brief An array with a fixed capacity whose elements are stored inline,
+/// so it lives wherever its owner does and never reallocates. Every element
+/// is constructed up front, and the count of elements in use is moved by
+/// pushing and popping them. Indices are only bounds checked in debug builds.
 template<class ValueType, size_t Size>
 class FixedArray {
+ public:
+  constexpr FixedArray() : array_(), count_(0) {}
+
+  /// @brief Starts with the first count elements in use, e.g. to use every
+  /// element as a slot that's addressed directly.
+  constexpr explicit FixedArray(size_t count) : array_(), count_(count) {
+    assert(count <= Size);
+  }
+
+  /// @brief Push an item into the array, which can't already be full.
+  [[nodiscard]] constexpr size_t Push(ValueType val) {
+    assert(count_ < Size);
+    array_[count_] = std::move(val);
+    count_ += 1;
+    return count_ - 1;
+  }
+
+  /// @brief Pop an item off of the array.
+  constexpr std::optional<ValueType> Pop() {
+    [[unlikely]] if (count_ == 0) {
+      return std::nullopt;
+    }
+
+    count_ -= 1;
+    return std::exchange(array_[count_], ValueType());
+  }
+
+  /// @brief Pops the items past the first count, resetting them so that they
+  /// release what they hold.
+  constexpr void Truncate(size_t count) {
+    assert(count <= count_);
+    for (size_t i = count; i < count_; i++) {
+      array_[i] = ValueType();
+    }
+    count_ = count;
+  }
+
+  [[nodiscard]] constexpr ValueType& operator[](size_t index) {
+    assert(index < count_);
+    return array_[index];
+  }
+
+  [[nodiscard]] constexpr const ValueType& operator[](size_t index) const {
+    assert(index < count_);
+    return array_[index];
+  }
+
+  [[nodiscard]] constexpr size_t GetCount() const {
+    return count_;
+  }
+
+  [[nodiscard]] static constexpr size_t GetCapacity() {
+    return Size;
+  }
+
+  [[nodiscard]] constexpr bool IsFull() const {
+    return count_ == Size;
+  }
+
+  [[nodiscard]] constexpr ValueType* begin() {
+    return array_;
+  }
+
+  [[nodiscard]] constexpr const ValueType* begin() const {
+    return array_;
+  }
+
+  [[nodiscard]] constexpr ValueType* end() {
+    return array_ + count_;
+  }
+
+  [[nodiscard]] constexpr const ValueType* end() const {
+    return array_ + count_;
+  }
+
  private:
   ValueType array_[Size];
+  size_t count_;
 };
 
 }  // namespace lamscripten::core
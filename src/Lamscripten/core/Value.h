@@ -0,0 +1,67 @@
+#ifndef SRC_LAMSCRIPTEN_CORE_VALUE_H_
+#define SRC_LAMSCRIPTEN_CORE_VALUE_H_
+
+#include <cstdint>
+#include <string>
+
+#include <Lamscript/parsed/LamscriptObject.h>
+#include <Lamscript/runtime/Value.h>
+
+namespace lamscripten::core {
+
+/// @brief Lamscripten shares lamscript's value representation, so both
+/// engines agree on how values behave and strings can be shared between them.
+using Value = lamscript::runtime::Value;
+using ValueType = lamscript::runtime::ValueType;
+
+template<class ObjectType>
+using Ref = lamscript::parsed::Ref<ObjectType>;
+
+/// @brief The kinds of objects that Lamscripten creates, which the virtual
+/// machine dispatches on instead of casting.
+enum class ObjectKind : std::uint8_t {
+  Function,
+  Closure,
+  BoundMethod,
+  Class,
+  Instance,
+  Native
+};
+
+/// @brief Base class for the callables and instances that Lamscripten creates.
+class Object : public lamscript::parsed::LamscriptObject {
+ public:
+  explicit Object(ObjectKind kind) : kind_(kind) {}
+
+  [[nodiscard]] ObjectKind GetKind() const { return kind_; }
+
+  /// @brief The string that printing the object outputs.
+  [[nodiscard]] virtual std::string ToString() const = 0;
+
+ private:
+  ObjectKind kind_;
+};
+
+/// @brief Converts a value into the string that printing it outputs, matching
+/// the output of lamscript's interpreter.
+[[nodiscard]] inline std::string ToString(const Value& value) {
+  switch (value.GetType()) {
+    case ValueType::Nil:
+      return "nil";
+    case ValueType::Boolean:
+      return value.AsBoolean() ? "true" : "false";
+    case ValueType::Number:
+      return std::to_string(value.AsNumber());
+    case ValueType::String:
+      return value.AsString();
+    case ValueType::Callable:
+    case ValueType::Instance:
+      return value.AsObject<Object>()->ToString();
+  }
+
+  return "nil";
+}
+
+}  // namespace lamscripten::core
+
+#endif  // SRC_LAMSCRIPTEN_CORE_VALUE_H_
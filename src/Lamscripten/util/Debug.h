@@ -7,36 +7,569 @@
 #include <iostream>
 
 #include <Lamscripten/core/Chunk.h>
+#include <Lamscripten/core/Function.h>
+#include <Lamscripten/core/Value.h>
 
 namespace lamscripten::util {
 
-[[nodiscard]] inline int DisassembleInstruction(
-    const core::Chunk& chunk, size_t opcode_index) {
+namespace internal {
+
+/// @brief Prints an instruction without operands.
+[[nodiscard]] inline size_t SimpleInstruction(
+    std::string_view name, size_t opcode_index) {
+  std::cout << name << std::endl;
+  return opcode_index + 1;
+}
+
+/// @brief Gets the big endian operand that starts at the index, which is one,
+/// two or four bytes wide.
+[[nodiscard]] inline uint32_t GetOperand(
+    const core::Chunk& chunk, size_t index, size_t width) {
+  uint32_t operand = 0;
+
+  for (size_t i = 0; i < width; i++) {
+    operand = operand << 8 | chunk.GetOpcodeAt(index + i).value_or(0);
+  }
+
+  return operand;
+}
+
+/// @brief Gets the width of the index operand of an instruction, which is
+/// two bytes in the Long form of the instruction and one otherwise.
+[[nodiscard]] constexpr size_t GetIndexWidth(bool is_long) {
+  return is_long ? 2 : 1;
+}
+
+/// @brief Gets the width of the offset of a jump, which is four bytes in the
+/// Long form of the jump and two otherwise.
+[[nodiscard]] constexpr size_t GetJumpWidth(bool is_long) {
+  return is_long ? 4 : 2;
+}
+
+/// @brief Whether an instruction is the Long form of an instruction that
+/// takes an index or a jump offset.
+[[nodiscard]] constexpr bool IsLongForm(core::OpCode code) {
+  switch (code) {
+    case core::OpCode::ConstantLong:
+    case core::OpCode::GetLocalLong:
+    case core::OpCode::SetLocalLong:
+    case core::OpCode::MakeCellLong:
+    case core::OpCode::GetCellLong:
+    case core::OpCode::SetCellLong:
+    case core::OpCode::GetUpvalueLong:
+    case core::OpCode::SetUpvalueLong:
+    case core::OpCode::GetGlobalLong:
+    case core::OpCode::SetGlobalLong:
+    case core::OpCode::DefineGlobalLong:
+    case core::OpCode::GetPropertyLong:
+    case core::OpCode::SetPropertyLong:
+    case core::OpCode::GetSuperLong:
+    case core::OpCode::InvokeLong:
+    case core::OpCode::JumpLong:
+    case core::OpCode::JumpIfFalseLong:
+    case core::OpCode::JumpIfTrueLong:
+    case core::OpCode::LoopLong:
+    case core::OpCode::ClosureLong:
+    case core::OpCode::ClassLong:
+      return true;
+    default:
+      return false;
+  }
+}
+
+[[nodiscard]] constexpr bool IsLongForm(core::RegisterOpCode code) {
+  switch (code) {
+    case core::RegisterOpCode::LoadConstantLong:
+    case core::RegisterOpCode::GetUpvalueLong:
+    case core::RegisterOpCode::SetUpvalueLong:
+    case core::RegisterOpCode::GetGlobalLong:
+    case core::RegisterOpCode::SetGlobalLong:
+    case core::RegisterOpCode::DefineGlobalLong:
+    case core::RegisterOpCode::GetPropertyLong:
+    case core::RegisterOpCode::SetPropertyLong:
+    case core::RegisterOpCode::GetSuperLong:
+    case core::RegisterOpCode::JumpLong:
+    case core::RegisterOpCode::JumpIfFalseLong:
+    case core::RegisterOpCode::JumpIfTrueLong:
+    case core::RegisterOpCode::LoopLong:
+    case core::RegisterOpCode::InvokeLong:
+    case core::RegisterOpCode::ClosureLong:
+    case core::RegisterOpCode::ClassLong:
+      return true;
+    default:
+      return false;
+  }
+}
+
+/// @brief Gets the width of a register instruction's operand of the kind.
+[[nodiscard]] constexpr size_t GetOperandWidth(char kind, bool is_long) {
+  switch (kind) {
+    case 'j':
+    case 'l':
+      return GetJumpWidth(is_long);
+    case 'i':
+    case 'k':
+    case 'n':
+      return GetIndexWidth(is_long);
+    default:
+      return 1;
+  }
+}
+
+/// @brief Prints an instruction with a single operand that isn't an index
+/// into one of the chunk's tables, such as a slot, which is two bytes wide in
+/// Long forms.
+[[nodiscard]] inline size_t OperandInstruction(
+    std::string_view name,
+    const core::Chunk& chunk,
+    size_t opcode_index,
+    bool is_long = false) {
+  size_t width = GetIndexWidth(is_long);
+  std::cout << name << " " << GetOperand(chunk, opcode_index + 1, width)
+      << std::endl;
+  return opcode_index + 1 + width;
+}
+
+/// @brief Prints an instruction whose operand is an index into the constant
+/// pool along with the constant.
+[[nodiscard]] inline size_t ConstantInstruction(
+    std::string_view name,
+    const core::Chunk& chunk,
+    size_t opcode_index,
+    bool is_long) {
+  size_t width = GetIndexWidth(is_long);
+  uint32_t const_index = GetOperand(chunk, opcode_index + 1, width);
+  std::cout
+      << name << " @ index " << const_index << " with a value of: "
+      << core::ToString(chunk.GetConstantAt(const_index).value_or(nullptr))
+      << std::endl;
+  return opcode_index + 1 + width;
+}
+
+/// @brief Prints an instruction whose first operand is an index into the
+/// name table along with the name, followed by any other operands.
+[[nodiscard]] inline size_t NameInstruction(
+    std::string_view name,
+    const core::Chunk& chunk,
+    size_t opcode_index,
+    bool is_long,
+    size_t operand_count = 1) {
+  size_t width = GetIndexWidth(is_long);
+  uint32_t name_index = GetOperand(chunk, opcode_index + 1, width);
+  auto symbol = chunk.GetNameAt(name_index);
+  std::cout
+      << name << " '"
+      << (symbol.has_value() ? symbol->GetName() : "INVALID NAME") << "'";
+
+  size_t end = opcode_index + width + operand_count;
+  for (size_t i = opcode_index + 1 + width; i < end; i++) {
+    std::cout << " " << GetOperand(chunk, i, 1);
+  }
+
+  std::cout << std::endl;
+  return end;
+}
+
+/// @brief Prints a jump along with the index of the instruction it jumps to.
+[[nodiscard]] inline size_t JumpInstruction(
+    std::string_view name,
+    int sign,
+    const core::Chunk& chunk,
+    size_t opcode_index,
+    bool is_long) {
+  size_t end = opcode_index + 1 + GetJumpWidth(is_long);
+  int64_t offset = GetOperand(chunk, opcode_index + 1, GetJumpWidth(is_long));
+  std::cout
+      << name << " " << offset << " -> "
+      << static_cast<int64_t>(end) + sign * offset << std::endl;
+  return end;
+}
+
+/// @brief Prints a register instruction with an operand of each kind in the
+/// layout: 'r' for registers, 'k' for constants, 'n' for names, 'i' for
+/// other indices, 'j' and 'l' for the offsets of forward and backward jumps,
+/// and 'u' for anything else. Indices are two bytes wide in Long forms, and
+/// jump offsets are two bytes wide or four in Long forms.
+[[nodiscard]] inline size_t RegisterInstruction(
+    std::string_view name,
+    const core::Chunk& chunk,
+    size_t opcode_index,
+    std::string_view layout,
+    bool is_long) {
+  std::cout << name;
+  size_t end = opcode_index + 1;
+
+  for (char kind : layout) {
+    end += GetOperandWidth(kind, is_long);
+  }
+
+  size_t operand_index = opcode_index + 1;
+  for (char kind : layout) {
+    size_t width = GetOperandWidth(kind, is_long);
+    uint32_t operand = GetOperand(chunk, operand_index, width);
+    operand_index += width;
+
+    switch (kind) {
+      case 'r':
+        std::cout << " r" << operand;
+        break;
+      case 'k':
+        std::cout
+            << " k" << operand << "("
+            << core::ToString(chunk.GetConstantAt(operand).value_or(nullptr))
+            << ")";
+        break;
+      case 'n':
+      {
+        auto symbol = chunk.GetNameAt(operand);
+        std::cout
+            << " '"
+            << (symbol.has_value() ? symbol->GetName() : "INVALID NAME")
+            << "'";
+        break;
+      }
+      case 'j':
+        std::cout << " " << operand << " -> " << end + operand;
+        break;
+      case 'l':
+        std::cout
+            << " " << operand << " -> "
+            << static_cast<int64_t>(end) - operand;
+        break;
+      default:
+        std::cout << " " << operand;
+        break;
+    }
+  }
+
+  std::cout << std::endl;
+  return end;
+}
+
+/// @brief Prints the index of an instruction and its source line, or a bar
+/// if it's on the same line as the instruction before it.
+inline void InstructionPrefix(const core::Chunk& chunk, size_t opcode_index) {
   std::cout << "\t" << opcode_index << ":";
 
+  size_t line = chunk.GetLineAt(opcode_index);
+  if (opcode_index > 0 && line == chunk.GetLineAt(opcode_index - 1)) {
+    std::cout << std::setw(5) << "|" << " ";
+  } else {
+    std::cout << std::setw(5) << line << " ";
+  }
+}
+
+}  // namespace internal
+
+[[nodiscard]] inline size_t DisassembleInstruction(
+    const core::Chunk& chunk, size_t opcode_index) {
+  internal::InstructionPrefix(chunk, opcode_index);
+
   auto op_or_null = chunk.GetOpcodeAt(opcode_index);
 
   [[unlikely]] if (!op_or_null.has_value()) {
     std::cout << "INVALID OP INDEX @ " << opcode_index << std::endl;
-    return -1;
+    return chunk.GetOpCodeCount();
   }
 
   auto op = core::OpCode(op_or_null.value());
+  bool is_long = internal::IsLongForm(op);
 
   switch (op) {
+    case core::OpCode::NoOp:
+      return internal::SimpleInstruction("OP_NOOP", opcode_index);
     case core::OpCode::Return:
-      std::cout << "OP_RETURN" << std::endl;
-      return opcode_index + 1;
+      return internal::SimpleInstruction("OP_RETURN", opcode_index);
     case core::OpCode::Constant:
-      uint8_t const_index = chunk.GetOpcodeAt(opcode_index + 1).value();
+    case core::OpCode::ConstantLong:
+      return internal::ConstantInstruction(
+          is_long ? "OP_CONSTANT_LONG" : "OP_CONSTANT",
+          chunk,
+          opcode_index,
+          is_long);
+    case core::OpCode::Nil:
+      return internal::SimpleInstruction("OP_NIL", opcode_index);
+    case core::OpCode::True:
+      return internal::SimpleInstruction("OP_TRUE", opcode_index);
+    case core::OpCode::False:
+      return internal::SimpleInstruction("OP_FALSE", opcode_index);
+    case core::OpCode::Pop:
+      return internal::SimpleInstruction("OP_POP", opcode_index);
+    case core::OpCode::GetLocal:
+    case core::OpCode::GetLocalLong:
+      return internal::OperandInstruction(
+          is_long ? "OP_GET_LOCAL_LONG" : "OP_GET_LOCAL",
+          chunk,
+          opcode_index,
+          is_long);
+    case core::OpCode::SetLocal:
+    case core::OpCode::SetLocalLong:
+      return internal::OperandInstruction(
+          is_long ? "OP_SET_LOCAL_LONG" : "OP_SET_LOCAL",
+          chunk,
+          opcode_index,
+          is_long);
+    case core::OpCode::MakeCell:
+    case core::OpCode::MakeCellLong:
+      return internal::OperandInstruction(
+          is_long ? "OP_MAKE_CELL_LONG" : "OP_MAKE_CELL",
+          chunk,
+          opcode_index,
+          is_long);
+    case core::OpCode::GetCell:
+    case core::OpCode::GetCellLong:
+      return internal::OperandInstruction(
+          is_long ? "OP_GET_CELL_LONG" : "OP_GET_CELL",
+          chunk,
+          opcode_index,
+          is_long);
+    case core::OpCode::SetCell:
+    case core::OpCode::SetCellLong:
+      return internal::OperandInstruction(
+          is_long ? "OP_SET_CELL_LONG" : "OP_SET_CELL",
+          chunk,
+          opcode_index,
+          is_long);
+    case core::OpCode::GetUpvalue:
+    case core::OpCode::GetUpvalueLong:
+      return internal::OperandInstruction(
+          is_long ? "OP_GET_UPVALUE_LONG" : "OP_GET_UPVALUE",
+          chunk,
+          opcode_index,
+          is_long);
+    case core::OpCode::SetUpvalue:
+    case core::OpCode::SetUpvalueLong:
+      return internal::OperandInstruction(
+          is_long ? "OP_SET_UPVALUE_LONG" : "OP_SET_UPVALUE",
+          chunk,
+          opcode_index,
+          is_long);
+    case core::OpCode::GetGlobal:
+    case core::OpCode::GetGlobalLong:
+      return internal::NameInstruction(
+          is_long ? "OP_GET_GLOBAL_LONG" : "OP_GET_GLOBAL",
+          chunk,
+          opcode_index,
+          is_long);
+    case core::OpCode::SetGlobal:
+    case core::OpCode::SetGlobalLong:
+      return internal::NameInstruction(
+          is_long ? "OP_SET_GLOBAL_LONG" : "OP_SET_GLOBAL",
+          chunk,
+          opcode_index,
+          is_long);
+    case core::OpCode::DefineGlobal:
+    case core::OpCode::DefineGlobalLong:
+      return internal::NameInstruction(
+          is_long ? "OP_DEFINE_GLOBAL_LONG" : "OP_DEFINE_GLOBAL",
+          chunk,
+          opcode_index,
+          is_long);
+    case core::OpCode::GetProperty:
+    case core::OpCode::GetPropertyLong:
+      return internal::NameInstruction(
+          is_long ? "OP_GET_PROPERTY_LONG" : "OP_GET_PROPERTY",
+          chunk,
+          opcode_index,
+          is_long);
+    case core::OpCode::SetProperty:
+    case core::OpCode::SetPropertyLong:
+      return internal::NameInstruction(
+          is_long ? "OP_SET_PROPERTY_LONG" : "OP_SET_PROPERTY",
+          chunk,
+          opcode_index,
+          is_long);
+    case core::OpCode::GetSuper:
+    case core::OpCode::GetSuperLong:
+      return internal::NameInstruction(
+          is_long ? "OP_GET_SUPER_LONG" : "OP_GET_SUPER",
+          chunk,
+          opcode_index,
+          is_long);
+    case core::OpCode::Equal:
+      return internal::SimpleInstruction("OP_EQUAL", opcode_index);
+    case core::OpCode::NotEqual:
+      return internal::SimpleInstruction("OP_NOT_EQUAL", opcode_index);
+    case core::OpCode::Greater:
+      return internal::SimpleInstruction("OP_GREATER", opcode_index);
+    case core::OpCode::GreaterEqual:
+      return internal::SimpleInstruction("OP_GREATER_EQUAL", opcode_index);
+    case core::OpCode::Less:
+      return internal::SimpleInstruction("OP_LESS", opcode_index);
+    case core::OpCode::LessEqual:
+      return internal::SimpleInstruction("OP_LESS_EQUAL", opcode_index);
+    case core::OpCode::Add:
+      return internal::SimpleInstruction("OP_ADD", opcode_index);
+    case core::OpCode::Subtract:
+      return internal::SimpleInstruction("OP_SUBTRACT", opcode_index);
+    case core::OpCode::Multiply:
+      return internal::SimpleInstruction("OP_MULTIPLY", opcode_index);
+    case core::OpCode::Divide:
+      return internal::SimpleInstruction("OP_DIVIDE", opcode_index);
+    case core::OpCode::Modulus:
+      return internal::SimpleInstruction("OP_MODULUS", opcode_index);
+    case core::OpCode::Not:
+      return internal::SimpleInstruction("OP_NOT", opcode_index);
+    case core::OpCode::Negate:
+      return internal::SimpleInstruction("OP_NEGATE", opcode_index);
+    case core::OpCode::Print:
+      return internal::SimpleInstruction("OP_PRINT", opcode_index);
+    case core::OpCode::Jump:
+    case core::OpCode::JumpLong:
+      return internal::JumpInstruction(
+          is_long ? "OP_JUMP_LONG" : "OP_JUMP",
+          1,
+          chunk,
+          opcode_index,
+          is_long);
+    case core::OpCode::JumpIfFalse:
+    case core::OpCode::JumpIfFalseLong:
+      return internal::JumpInstruction(
+          is_long ? "OP_JUMP_IF_FALSE_LONG" : "OP_JUMP_IF_FALSE",
+          1,
+          chunk,
+          opcode_index,
+          is_long);
+    case core::OpCode::JumpIfTrue:
+    case core::OpCode::JumpIfTrueLong:
+      return internal::JumpInstruction(
+          is_long ? "OP_JUMP_IF_TRUE_LONG" : "OP_JUMP_IF_TRUE",
+          1,
+          chunk,
+          opcode_index,
+          is_long);
+    case core::OpCode::Loop:
+    case core::OpCode::LoopLong:
+      return internal::JumpInstruction(
+          is_long ? "OP_LOOP_LONG" : "OP_LOOP",
+          -1,
+          chunk,
+          opcode_index,
+          is_long);
+    case core::OpCode::Call:
+      return internal::OperandInstruction("OP_CALL", chunk, opcode_index);
+    case core::OpCode::Invoke:
+    case core::OpCode::InvokeLong:
+      return internal::NameInstruction(
+          is_long ? "OP_INVOKE_LONG" : "OP_INVOKE",
+          chunk,
+          opcode_index,
+          is_long,
+          2);
+    case core::OpCode::Closure:
+    case core::OpCode::ClosureLong:
+      return internal::ConstantInstruction(
+          is_long ? "OP_CLOSURE_LONG" : "OP_CLOSURE",
+          chunk,
+          opcode_index,
+          is_long);
+    case core::OpCode::Class:
+    case core::OpCode::ClassLong:
+    {
+      size_t end = opcode_index + 1 + internal::GetIndexWidth(is_long);
       std::cout
-          << "OP_CONSTANT @ index "
-          << static_cast<int>(const_index)
-          << " with a value of: "
-          << chunk.GetConstantAt(const_index).value_or(0)
+          << (is_long ? "OP_CLASS_LONG " : "OP_CLASS ")
+          << core::ToString(
+              chunk.GetConstantAt(
+                  internal::GetOperand(
+                      chunk,
+                      opcode_index + 1,
+                      internal::GetIndexWidth(is_long)))
+                  .value_or(nullptr))
+          << " with " << internal::GetOperand(chunk, end + 1, 2) << " methods"
+          << (internal::GetOperand(chunk, end, 1) == 1
+              ? " and a super class" : "")
           << std::endl;
-      return opcode_index + 2;
+      return end + 3;
+    }
+  }
+
+  std::cout << "UNKNOWN OP " << op_or_null.value() << std::endl;
+  return opcode_index + 1;
+}
+
+[[nodiscard]] inline size_t DisassembleRegisterInstruction(
+    const core::Chunk& chunk, size_t opcode_index) {
+  internal::InstructionPrefix(chunk, opcode_index);
+
+  auto op_or_null = chunk.GetOpcodeAt(opcode_index);
+
+  [[unlikely]] if (!op_or_null.has_value()) {
+    std::cout << "INVALID OP INDEX @ " << opcode_index << std::endl;
+    return chunk.GetOpCodeCount();
   }
+
+  using Op = core::RegisterOpCode;
+  auto op = Op(op_or_null.value());
+  bool is_long = internal::IsLongForm(op);
+  auto print = [&chunk, opcode_index, is_long](
+      std::string_view name, std::string_view layout) {
+    return internal::RegisterInstruction(
+        name, chunk, opcode_index, layout, is_long);
+  };
+
+  switch (op) {
+    case Op::NoOp: return print("OP_NOOP", "");
+    case Op::Return: return print("OP_RETURN", "r");
+    case Op::Move: return print("OP_MOVE", "rr");
+    case Op::LoadConstant: return print("OP_LOAD_CONSTANT", "kr");
+    case Op::LoadConstantLong: return print("OP_LOAD_CONSTANT_LONG", "kr");
+    case Op::LoadNil: return print("OP_LOAD_NIL", "r");
+    case Op::LoadTrue: return print("OP_LOAD_TRUE", "r");
+    case Op::LoadFalse: return print("OP_LOAD_FALSE", "r");
+    case Op::MakeCell: return print("OP_MAKE_CELL", "u");
+    case Op::GetCell: return print("OP_GET_CELL", "ru");
+    case Op::SetCell: return print("OP_SET_CELL", "ur");
+    case Op::GetUpvalue: return print("OP_GET_UPVALUE", "ir");
+    case Op::GetUpvalueLong: return print("OP_GET_UPVALUE_LONG", "ir");
+    case Op::SetUpvalue: return print("OP_SET_UPVALUE", "ir");
+    case Op::SetUpvalueLong: return print("OP_SET_UPVALUE_LONG", "ir");
+    case Op::GetGlobal: return print("OP_GET_GLOBAL", "nr");
+    case Op::GetGlobalLong: return print("OP_GET_GLOBAL_LONG", "nr");
+    case Op::SetGlobal: return print("OP_SET_GLOBAL", "nr");
+    case Op::SetGlobalLong: return print("OP_SET_GLOBAL_LONG", "nr");
+    case Op::DefineGlobal: return print("OP_DEFINE_GLOBAL", "nr");
+    case Op::DefineGlobalLong: return print("OP_DEFINE_GLOBAL_LONG", "nr");
+    case Op::GetProperty: return print("OP_GET_PROPERTY", "nrr");
+    case Op::GetPropertyLong: return print("OP_GET_PROPERTY_LONG", "nrr");
+    case Op::SetProperty: return print("OP_SET_PROPERTY", "nrr");
+    case Op::SetPropertyLong: return print("OP_SET_PROPERTY_LONG", "nrr");
+    case Op::GetSuper: return print("OP_GET_SUPER", "nrrr");
+    case Op::GetSuperLong: return print("OP_GET_SUPER_LONG", "nrrr");
+    case Op::Equal: return print("OP_EQUAL", "rrr");
+    case Op::NotEqual: return print("OP_NOT_EQUAL", "rrr");
+    case Op::Greater: return print("OP_GREATER", "rrr");
+    case Op::GreaterEqual: return print("OP_GREATER_EQUAL", "rrr");
+    case Op::Less: return print("OP_LESS", "rrr");
+    case Op::LessEqual: return print("OP_LESS_EQUAL", "rrr");
+    case Op::Add: return print("OP_ADD", "rrr");
+    case Op::Subtract: return print("OP_SUBTRACT", "rrr");
+    case Op::Multiply: return print("OP_MULTIPLY", "rrr");
+    case Op::Divide: return print("OP_DIVIDE", "rrr");
+    case Op::Modulus: return print("OP_MODULUS", "rrr");
+    case Op::Not: return print("OP_NOT", "rr");
+    case Op::Negate: return print("OP_NEGATE", "rr");
+    case Op::Print: return print("OP_PRINT", "r");
+    case Op::Jump: return print("OP_JUMP", "j");
+    case Op::JumpLong: return print("OP_JUMP_LONG", "j");
+    case Op::JumpIfFalse: return print("OP_JUMP_IF_FALSE", "rj");
+    case Op::JumpIfFalseLong: return print("OP_JUMP_IF_FALSE_LONG", "rj");
+    case Op::JumpIfTrue: return print("OP_JUMP_IF_TRUE", "rj");
+    case Op::JumpIfTrueLong: return print("OP_JUMP_IF_TRUE_LONG", "rj");
+    case Op::Loop: return print("OP_LOOP", "l");
+    case Op::LoopLong: return print("OP_LOOP_LONG", "l");
+    case Op::Call: return print("OP_CALL", "ru");
+    case Op::Invoke: return print("OP_INVOKE", "nru");
+    case Op::InvokeLong: return print("OP_INVOKE_LONG", "nru");
+    case Op::Closure: return print("OP_CLOSURE", "kr");
+    case Op::ClosureLong: return print("OP_CLOSURE_LONG", "kr");
+    case Op::Class: return print("OP_CLASS", "kru");
+    case Op::ClassLong: return print("OP_CLASS_LONG", "kru");
+    case Op::Method: return print("OP_METHOD", "rr");
+  }
+
+  std::cout << "UNKNOWN OP " << op_or_null.value() << std::endl;
+  return opcode_index + 1;
 }
 
 inline void DisassembleChunk(
@@ -45,7 +578,29 @@ inline void DisassembleChunk(
 
   size_t chunk_index = 0;
   while (chunk_index < chunk.GetOpCodeCount()) {
-    chunk_index = DisassembleInstruction(chunk, chunk_index);
+    chunk_index =
+        chunk.GetInstructionSet() == core::InstructionSet::Register
+            ? DisassembleRegisterInstruction(chunk, chunk_index)
+            : DisassembleInstruction(chunk, chunk_index);
+  }
+}
+
+/// @brief Disassembles the chunk of a function followed by the chunks of the
+/// functions declared within it.
+inline void DisassembleFunction(const core::Function& function) {
+  DisassembleChunk(function.GetChunk(), function.GetName());
+
+  for (size_t i = 0; i < function.GetChunk().GetConstantCount(); i++) {
+    core::Value constant = function.GetChunk().GetConstantAt(i).value();
+
+    if (!constant.IsCallable()) {
+      continue;
+    }
+
+    if (auto* nested = dynamic_cast<const core::Function*>(
+            constant.AsObject<core::Object>())) {
+      DisassembleFunction(*nested);
+    }
   }
 }
 
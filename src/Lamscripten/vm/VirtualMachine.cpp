@@ -0,0 +1,1248 @@
+#include <Lamscripten/vm/VirtualMachine.h>
+
+#include <math.h>
+
+#include <algorithm>
+#include <cassert>
+#include <iostream>
+#include <string>
+#include <utility>
+#include <vector>
+
+#include <Lamscript/parsed/LamscriptString.h>
+#include <Lamscript/parsing/Token.h>
+#include <Lamscript/runtime/Interpreter.h>
+#include <Lamscript/runtime/Lamscript.h>
+#include <Lamscripten/core/Chunk.h>
+#include <Lamscripten/core/Class.h>
+#include <Lamscripten/core/Native.h>
+
+#if defined(__GNUC__) || defined(__clang__)
+#define LAMSCRIPTEN_COMPUTED_GOTO
+#endif
+
+namespace lamscripten::vm {
+
+using lamscript::runtime::Cell;
+using lamscript::runtime::Interpreter;
+using lamscript::runtime::Lamscript;
+using lamscript::parsing::Symbol;
+using core::OpCode;
+using core::Ref;
+using core::Value;
+
+// ---------------------------------- INTERNAL ---------------------------------
+
+namespace {
+
+bool IsKind(const Value& value, core::ObjectKind kind) {
+  return value.IsCallable()
+      && value.AsObject<core::Object>()->GetKind() == kind;
+}
+
+}  // namespace
+
+// ---------------------------------- PUBLIC -----------------------------------
+
+VirtualMachine::VirtualMachine()
+    : stack_(kMaxStackSize),
+    cells_(kMaxStackSize),
+    stack_top_(nullptr),
+    frames_(),
+    globals_(),
+    had_error_(false) {
+  stack_top_ = stack_.begin();
+  globals_.emplace(
+      Symbol::Intern("clock"),
+      lamscript::parsed::MakeRef<core::NativeFunction>(0, &core::Clock));
+}
+
+/// Errors that aren't handled by a block or function body stop the program,
+/// the same way they stop top level statements in lamscript's interpreter.
+InterpretResult VirtualMachine::Interpret(
+    const Ref<core::Function>& script) {
+  Value* callee = stack_top_;
+  *stack_top_++ = lamscript::parsed::MakeRef<core::Closure>(
+      script, std::vector<Ref<Cell>>());
+
+  try {
+    CallClosure(
+        stack_top_[-1].AsObject<core::Closure>(),
+        callee - stack_.begin(),
+        0,
+        false);
+    Value _ = Run(frames_.GetCount() - 1);
+  } catch (const lamscript::RuntimeError& error) {
+    Lamscript::RuntimeError(error);
+    had_error_ = true;
+    TruncateStack(callee);
+  }
+
+  return had_error_ ? InterpretResult::RuntimeError : InterpretResult::Ok;
+}
+
+// ---------------------------------- PRIVATE ----------------------------------
+
+Value VirtualMachine::Run(size_t base_frame) {
+  while (true) {
+    try {
+      // Programs are compiled with a single instruction set, so the frames
+      // that a dispatch loop runs all use the same one.
+      const core::Function* function =
+          frames_[frames_.GetCount() - 1].Closure->GetFunction();
+
+      if (function->GetChunk().GetInstructionSet()
+          == core::InstructionSet::Register) {
+        return ExecuteRegisters(base_frame);
+      }
+
+      return Execute(base_frame);
+    } catch (const lamscript::RuntimeError& error) {
+      if (!RecoverFromError(error, base_frame)) {
+        throw;
+      }
+    }
+  }
+}
+
+// The state of the running frame is cached in locals, so it's reloaded after
+// anything that pushes or pops a frame. The instruction pointer is written
+// back to the frame before anything that can raise an error or push a frame.
+#define VM_LOAD_FRAME() \
+  do { \
+    frame = &frames_[frames_.GetCount() - 1]; \
+    ip = frame->Ip; \
+    slots = stack_.begin() + frame->Base; \
+    cells = cells_.begin() + frame->Base; \
+    chunk = &frame->Closure->GetFunction()->GetChunk(); \
+    constants = chunk->GetConstants(); \
+    names = chunk->GetNames(); \
+  } while (false)
+
+// Register frames own every slot up to the end of their frame, so calls and
+// the values that they push land above it.
+#define VM_LOAD_REGISTER_FRAME() \
+  do { \
+    VM_LOAD_FRAME(); \
+    stack_top_ = slots + frame->Closure->GetFunction()->GetFrameSize(); \
+  } while (false)
+
+#define VM_SAVE_IP() (frame->Ip = ip)
+#define VM_ERROR(message) \
+  do { \
+    VM_SAVE_IP(); \
+    throw Error(message); \
+  } while (false)
+
+#define VM_READ_OPERAND() (*ip++)
+#define VM_READ_SHORT() (ip += 2, core::ReadShort(ip - 2))
+#define VM_READ_LONG() (ip += 4, core::ReadLong(ip - 4))
+#define VM_PUSH(value) \
+    (assert(stack_top_ < stack_.end()), *stack_top_++ = (value))
+#define VM_POP() (*--stack_top_ = nullptr)
+
+#define VM_NUMBER_OPERATION(operation) \
+  do { \
+    Value& left_side = stack_top_[-2]; \
+    const Value& right_side = stack_top_[-1]; \
+    if (!left_side.IsNumber() || !right_side.IsNumber()) { \
+      VM_ERROR("Operands must both be numbers."); \
+    } \
+    left_side = left_side.AsNumber() operation right_side.AsNumber(); \
+    VM_POP(); \
+  } while (false)
+
+#define VM_REGISTER_NUMBER_OPERATION(operation) \
+  do { \
+    Value& destination = slots[VM_READ_OPERAND()]; \
+    const Value& left_side = slots[VM_READ_OPERAND()]; \
+    const Value& right_side = slots[VM_READ_OPERAND()]; \
+    if (!left_side.IsNumber() || !right_side.IsNumber()) { \
+      VM_ERROR("Operands must both be numbers."); \
+    } \
+    destination = left_side.AsNumber() operation right_side.AsNumber(); \
+  } while (false)
+
+#ifdef LAMSCRIPTEN_COUNT_DISPATCHES
+#define VM_COUNT_DISPATCH() (dispatch_count_ += 1)
+#else
+#define VM_COUNT_DISPATCH() ((void) 0)
+#endif
+
+// Both dispatch loops name the opcode type that they run as Op.
+#ifdef LAMSCRIPTEN_COMPUTED_GOTO
+#define VM_DISPATCH() VM_COUNT_DISPATCH(); goto *kDispatchTable[*ip++];
+#define VM_CASE(opcode) Label##opcode
+#define VM_NEXT() VM_DISPATCH()
+#else
+#define VM_DISPATCH() VM_COUNT_DISPATCH(); switch (static_cast<Op>(*ip++))
+#define VM_CASE(opcode) case Op::opcode
+#define VM_NEXT() continue
+#endif
+
+// Instructions that take an index into the constant pool or name table read
+// it into index, one byte wide in their short form and two in their Long
+// form, and then share the rest of their handler.
+#define VM_INDEXED_CASE(opcode) \
+  VM_CASE(opcode##Long): \
+    index = VM_READ_SHORT(); \
+    goto Indexed##opcode; \
+  VM_CASE(opcode): \
+    index = VM_READ_OPERAND(); \
+  Indexed##opcode
+
+// Jumps read their offset into offset, two bytes wide in their short form
+// and four in their Long form, in the same way.
+#define VM_JUMP_CASE(opcode) \
+  VM_CASE(opcode##Long): \
+    offset = VM_READ_LONG(); \
+    goto Offset##opcode; \
+  VM_CASE(opcode): \
+    offset = VM_READ_SHORT(); \
+  Offset##opcode
+
+Value VirtualMachine::Execute(size_t base_frame) {
+  using Op = OpCode;
+
+#ifdef LAMSCRIPTEN_COMPUTED_GOTO
+  // Must list a label for every opcode in the order they're declared in.
+  static void* kDispatchTable[] = {
+    &&LabelNoOp, &&LabelReturn, &&LabelConstant, &&LabelConstantLong,
+    &&LabelNil, &&LabelTrue, &&LabelFalse, &&LabelPop, &&LabelGetLocal,
+    &&LabelGetLocalLong, &&LabelSetLocal, &&LabelSetLocalLong, &&LabelMakeCell,
+    &&LabelMakeCellLong, &&LabelGetCell, &&LabelGetCellLong, &&LabelSetCell,
+    &&LabelSetCellLong, &&LabelGetUpvalue, &&LabelGetUpvalueLong,
+    &&LabelSetUpvalue, &&LabelSetUpvalueLong, &&LabelGetGlobal,
+    &&LabelGetGlobalLong, &&LabelSetGlobal, &&LabelSetGlobalLong,
+    &&LabelDefineGlobal, &&LabelDefineGlobalLong, &&LabelGetProperty,
+    &&LabelGetPropertyLong, &&LabelSetProperty, &&LabelSetPropertyLong,
+    &&LabelGetSuper, &&LabelGetSuperLong, &&LabelEqual, &&LabelNotEqual,
+    &&LabelGreater, &&LabelGreaterEqual, &&LabelLess, &&LabelLessEqual,
+    &&LabelAdd, &&LabelSubtract, &&LabelMultiply, &&LabelDivide, &&LabelModulus,
+    &&LabelNot, &&LabelNegate, &&LabelPrint, &&LabelJump, &&LabelJumpLong,
+    &&LabelJumpIfFalse, &&LabelJumpIfFalseLong, &&LabelJumpIfTrue,
+    &&LabelJumpIfTrueLong, &&LabelLoop, &&LabelLoopLong, &&LabelCall,
+    &&LabelInvoke, &&LabelInvokeLong, &&LabelClosure, &&LabelClosureLong,
+    &&LabelClass, &&LabelClassLong
+  };
+  static_assert(
+      sizeof(kDispatchTable) / sizeof(kDispatchTable[0])
+          == static_cast<size_t>(OpCode::ClassLong) + 1,
+      "Every opcode needs a label in the dispatch table.");
+#endif
+
+  CallFrame* frame;
+  const uint8_t* ip;
+  uint16_t index;
+  uint32_t offset;
+  Value* slots;
+  Ref<Cell>* cells;
+  const core::Chunk* chunk;
+  const Value* constants;
+  const Symbol* names;
+  VM_LOAD_FRAME();
+
+  while (true) {
+    VM_DISPATCH() {
+      VM_CASE(NoOp): {
+        VM_NEXT();
+      }
+      VM_CASE(Return): {
+        Value result = std::move(stack_top_[-1]);
+
+        if (frame->IsConstruction) {
+          result = slots[0];
+        }
+
+        TruncateStack(stack_.begin() + frame->CalleeSlot);
+        frames_.Truncate(frames_.GetCount() - 1);
+
+        if (frames_.GetCount() == base_frame) {
+          return result;
+        }
+
+        VM_PUSH(std::move(result));
+        VM_LOAD_FRAME();
+        VM_NEXT();
+      }
+      VM_INDEXED_CASE(Constant): {
+        VM_PUSH(constants[index]);
+        VM_NEXT();
+      }
+      VM_CASE(Nil): {
+        VM_PUSH(nullptr);
+        VM_NEXT();
+      }
+      VM_CASE(True): {
+        VM_PUSH(true);
+        VM_NEXT();
+      }
+      VM_CASE(False): {
+        VM_PUSH(false);
+        VM_NEXT();
+      }
+      VM_CASE(Pop): {
+        VM_POP();
+        VM_NEXT();
+      }
+      VM_INDEXED_CASE(GetLocal): {
+        VM_PUSH(slots[index]);
+        VM_NEXT();
+      }
+      VM_INDEXED_CASE(SetLocal): {
+        slots[index] = stack_top_[-1];
+        VM_NEXT();
+      }
+      VM_INDEXED_CASE(MakeCell): {
+        cells[index] = lamscript::parsed::MakeRef<Cell>();
+        VM_NEXT();
+      }
+      VM_INDEXED_CASE(GetCell): {
+        VM_PUSH(cells[index]->Get());
+        VM_NEXT();
+      }
+      VM_INDEXED_CASE(SetCell): {
+        cells[index]->Set(stack_top_[-1]);
+        VM_NEXT();
+      }
+      VM_INDEXED_CASE(GetUpvalue): {
+        VM_PUSH(frame->Closure->GetUpvalues()[index]->Get());
+        VM_NEXT();
+      }
+      VM_INDEXED_CASE(SetUpvalue): {
+        frame->Closure->GetUpvalues()[index]->Set(stack_top_[-1]);
+        VM_NEXT();
+      }
+      VM_INDEXED_CASE(GetGlobal): {
+        Symbol name = names[index];
+        auto lookup = globals_.find(name);
+
+        if (lookup == globals_.end()) {
+          VM_ERROR("Undefined variable: '" + name.GetName() + "'.");
+        }
+
+        VM_PUSH(lookup->second);
+        VM_NEXT();
+      }
+      VM_INDEXED_CASE(SetGlobal): {
+        Symbol name = names[index];
+        auto lookup = globals_.find(name);
+
+        if (lookup == globals_.end()) {
+          VM_ERROR("Undefined Variable '" + name.GetName() + "'.");
+        }
+
+        lookup->second = stack_top_[-1];
+        VM_NEXT();
+      }
+      VM_INDEXED_CASE(DefineGlobal): {
+        globals_[names[index]] = std::move(stack_top_[-1]);
+        VM_POP();
+        VM_NEXT();
+      }
+      VM_INDEXED_CASE(GetProperty): {
+        Symbol name = names[index];
+        VM_SAVE_IP();
+        Value property = GetProperty(stack_top_[-1], name);
+        stack_top_[-1] = std::move(property);
+        VM_NEXT();
+      }
+      VM_INDEXED_CASE(SetProperty): {
+        Symbol name = names[index];
+        Value& object = stack_top_[-2];
+
+        if (!object.IsInstance()) {
+          VM_ERROR("Only instances have fields.");
+        }
+
+        object.AsObject<core::Instance>()->SetField(name, stack_top_[-1]);
+        object = std::move(stack_top_[-1]);
+        VM_POP();
+        VM_NEXT();
+      }
+      VM_INDEXED_CASE(GetSuper): {
+        Symbol name = names[index];
+        core::Closure* method = stack_top_[-2].AsObject<core::Class>()
+            ->LookupMethod(name);
+
+        if (method == nullptr) {
+          VM_ERROR("Undefined property '" + name.GetName() + "'.");
+        }
+
+        stack_top_[-2] = lamscript::parsed::MakeRef<core::BoundMethod>(
+            std::move(stack_top_[-1]), Ref<core::Closure>(method));
+        VM_POP();
+        VM_NEXT();
+      }
+      VM_CASE(Equal): {
+        stack_top_[-2] = Interpreter::IsEqual(stack_top_[-2], stack_top_[-1]);
+        VM_POP();
+        VM_NEXT();
+      }
+      VM_CASE(NotEqual): {
+        stack_top_[-2] = !Interpreter::IsEqual(
+            stack_top_[-2], stack_top_[-1]);
+        VM_POP();
+        VM_NEXT();
+      }
+      VM_CASE(Greater): {
+        VM_NUMBER_OPERATION(>);
+        VM_NEXT();
+      }
+      VM_CASE(GreaterEqual): {
+        VM_NUMBER_OPERATION(>=);
+        VM_NEXT();
+      }
+      VM_CASE(Less): {
+        VM_NUMBER_OPERATION(<);
+        VM_NEXT();
+      }
+      VM_CASE(LessEqual): {
+        VM_NUMBER_OPERATION(<=);
+        VM_NEXT();
+      }
+      VM_CASE(Add): {
+        Value& left_side = stack_top_[-2];
+        const Value& right_side = stack_top_[-1];
+
+        if (left_side.IsNumber() && right_side.IsNumber()) {
+          left_side = left_side.AsNumber() + right_side.AsNumber();
+        } else if (left_side.IsString() && right_side.IsString()) {
+          left_side = lamscript::parsed::LamscriptString::Concatenate(
+              left_side.AsObject<lamscript::parsed::LamscriptString>(),
+              right_side.AsObject<lamscript::parsed::LamscriptString>());
+        } else {
+          VM_ERROR("Operands must be two numbers or strings.");
+        }
+
+        VM_POP();
+        VM_NEXT();
+      }
+      VM_CASE(Subtract): {
+        VM_NUMBER_OPERATION(-);
+        VM_NEXT();
+      }
+      VM_CASE(Multiply): {
+        VM_NUMBER_OPERATION(*);
+        VM_NEXT();
+      }
+      VM_CASE(Divide): {
+        Value& left_side = stack_top_[-2];
+        const Value& right_side = stack_top_[-1];
+
+        if (!left_side.IsNumber() || !right_side.IsNumber()) {
+          VM_ERROR("Operands must both be numbers.");
+        }
+
+        if (right_side.AsNumber() == 0) {
+          VM_ERROR("Divide by 0 error.");
+        }
+
+        left_side = left_side.AsNumber() / right_side.AsNumber();
+        VM_POP();
+        VM_NEXT();
+      }
+      VM_CASE(Modulus): {
+        Value& left_side = stack_top_[-2];
+        const Value& right_side = stack_top_[-1];
+
+        if (!left_side.IsNumber() || !right_side.IsNumber()) {
+          VM_ERROR("Operands must both be numbers.");
+        }
+
+        left_side = fmod(left_side.AsNumber(), right_side.AsNumber());
+        VM_POP();
+        VM_NEXT();
+      }
+      VM_CASE(Not): {
+        stack_top_[-1] = !Interpreter::IsTruthy(stack_top_[-1]);
+        VM_NEXT();
+      }
+      VM_CASE(Negate): {
+        if (!stack_top_[-1].IsNumber()) {
+          VM_ERROR("Operand must be a number.");
+        }
+
+        stack_top_[-1] = -stack_top_[-1].AsNumber();
+        VM_NEXT();
+      }
+      VM_CASE(Print): {
+        std::cout << core::ToString(stack_top_[-1]) << std::endl;
+        VM_POP();
+        VM_NEXT();
+      }
+      VM_JUMP_CASE(Jump): {
+        ip += offset;
+        VM_NEXT();
+      }
+      VM_JUMP_CASE(JumpIfFalse): {
+        if (!Interpreter::IsTruthy(stack_top_[-1])) {
+          ip += offset;
+        }
+
+        VM_NEXT();
+      }
+      VM_JUMP_CASE(JumpIfTrue): {
+        if (Interpreter::IsTruthy(stack_top_[-1])) {
+          ip += offset;
+        }
+
+        VM_NEXT();
+      }
+      VM_JUMP_CASE(Loop): {
+        ip -= offset;
+        VM_NEXT();
+      }
+      VM_CASE(Call): {
+        uint8_t argument_count = VM_READ_OPERAND();
+        VM_SAVE_IP();
+        CallValue(argument_count);
+        VM_LOAD_FRAME();
+        VM_NEXT();
+      }
+      VM_INDEXED_CASE(Invoke): {
+        Symbol name = names[index];
+        uint8_t argument_count = VM_READ_OPERAND();
+        VM_SAVE_IP();
+        Invoke(name, argument_count);
+        VM_LOAD_FRAME();
+        VM_NEXT();
+      }
+      VM_INDEXED_CASE(Closure): {
+        core::Function* prototype = constants[index].AsObject<core::Function>();
+        const std::vector<Ref<Cell>>& enclosing_upvalues =
+            frame->Closure->GetUpvalues();
+        std::vector<Ref<Cell>> upvalues;
+        upvalues.reserve(prototype->GetUpvalues().size());
+
+        // Cells from this frame are captured directly while cells from
+        // further out are shared through this closure's own upvalues.
+        for (const auto& upvalue : prototype->GetUpvalues()) {
+          upvalues.push_back(
+              upvalue.IsLocal
+                  ? cells[upvalue.Index]
+                  : enclosing_upvalues[upvalue.Index]);
+        }
+
+        VM_PUSH(
+            lamscript::parsed::MakeRef<core::Closure>(
+                Ref<core::Function>(prototype), std::move(upvalues)));
+        VM_NEXT();
+      }
+      VM_INDEXED_CASE(Class): {
+        const Value& name = constants[index];
+        bool has_super_class = VM_READ_OPERAND() == 1;
+        uint16_t method_count = VM_READ_SHORT();
+        VM_SAVE_IP();
+        DefineClass(name, method_count, has_super_class);
+        VM_NEXT();
+      }
+    }
+  }
+}
+
+/// Operands are read before anything that can raise an error, so errors are
+/// attributed to the instruction that the saved instruction pointer is in.
+Value VirtualMachine::ExecuteRegisters(size_t base_frame) {
+  using Op = core::RegisterOpCode;
+
+#ifdef LAMSCRIPTEN_COMPUTED_GOTO
+  // Must list a label for every opcode in the order they're declared in.
+  static void* kDispatchTable[] = {
+    &&LabelNoOp, &&LabelReturn, &&LabelMove, &&LabelLoadConstant,
+    &&LabelLoadConstantLong, &&LabelLoadNil, &&LabelLoadTrue, &&LabelLoadFalse,
+    &&LabelMakeCell, &&LabelGetCell, &&LabelSetCell, &&LabelGetUpvalue,
+    &&LabelGetUpvalueLong, &&LabelSetUpvalue, &&LabelSetUpvalueLong,
+    &&LabelGetGlobal, &&LabelGetGlobalLong, &&LabelSetGlobal,
+    &&LabelSetGlobalLong, &&LabelDefineGlobal, &&LabelDefineGlobalLong,
+    &&LabelGetProperty, &&LabelGetPropertyLong, &&LabelSetProperty,
+    &&LabelSetPropertyLong, &&LabelGetSuper, &&LabelGetSuperLong, &&LabelEqual,
+    &&LabelNotEqual, &&LabelGreater, &&LabelGreaterEqual, &&LabelLess,
+    &&LabelLessEqual, &&LabelAdd, &&LabelSubtract, &&LabelMultiply,
+    &&LabelDivide, &&LabelModulus, &&LabelNot, &&LabelNegate, &&LabelPrint,
+    &&LabelJump, &&LabelJumpLong, &&LabelJumpIfFalse, &&LabelJumpIfFalseLong,
+    &&LabelJumpIfTrue, &&LabelJumpIfTrueLong, &&LabelLoop, &&LabelLoopLong,
+    &&LabelCall, &&LabelInvoke, &&LabelInvokeLong, &&LabelClosure,
+    &&LabelClosureLong, &&LabelClass, &&LabelClassLong, &&LabelMethod
+  };
+  static_assert(
+      sizeof(kDispatchTable) / sizeof(kDispatchTable[0])
+          == static_cast<size_t>(Op::Method) + 1,
+      "Every opcode needs a label in the dispatch table.");
+#endif
+
+  CallFrame* frame;
+  const uint8_t* ip;
+  uint16_t index;
+  uint32_t offset;
+  const Value* condition;
+  Value* slots;
+  Ref<Cell>* cells;
+  const core::Chunk* chunk;
+  const Value* constants;
+  const Symbol* names;
+  VM_LOAD_REGISTER_FRAME();
+
+  while (true) {
+    VM_DISPATCH() {
+      VM_CASE(NoOp): {
+        VM_NEXT();
+      }
+      VM_CASE(Return): {
+        Value result = frame->IsConstruction
+            ? slots[0] : std::move(slots[VM_READ_OPERAND()]);
+
+        TruncateStack(stack_.begin() + frame->CalleeSlot);
+        frames_.Truncate(frames_.GetCount() - 1);
+
+        if (frames_.GetCount() == base_frame) {
+          return result;
+        }
+
+        // The result replaces the callee in the register of the caller that
+        // the call was made from.
+        VM_PUSH(std::move(result));
+        VM_LOAD_REGISTER_FRAME();
+        VM_NEXT();
+      }
+      VM_CASE(Move): {
+        uint8_t destination = VM_READ_OPERAND();
+        slots[destination] = slots[VM_READ_OPERAND()];
+        VM_NEXT();
+      }
+      VM_INDEXED_CASE(LoadConstant): {
+        slots[VM_READ_OPERAND()] = constants[index];
+        VM_NEXT();
+      }
+      VM_CASE(LoadNil): {
+        slots[VM_READ_OPERAND()] = nullptr;
+        VM_NEXT();
+      }
+      VM_CASE(LoadTrue): {
+        slots[VM_READ_OPERAND()] = true;
+        VM_NEXT();
+      }
+      VM_CASE(LoadFalse): {
+        slots[VM_READ_OPERAND()] = false;
+        VM_NEXT();
+      }
+      VM_CASE(MakeCell): {
+        cells[VM_READ_OPERAND()] = lamscript::parsed::MakeRef<Cell>();
+        VM_NEXT();
+      }
+      VM_CASE(GetCell): {
+        uint8_t destination = VM_READ_OPERAND();
+        slots[destination] = cells[VM_READ_OPERAND()]->Get();
+        VM_NEXT();
+      }
+      VM_CASE(SetCell): {
+        uint8_t slot = VM_READ_OPERAND();
+        cells[slot]->Set(slots[VM_READ_OPERAND()]);
+        VM_NEXT();
+      }
+      VM_INDEXED_CASE(GetUpvalue): {
+        slots[VM_READ_OPERAND()] = frame->Closure->GetUpvalues()[index]->Get();
+        VM_NEXT();
+      }
+      VM_INDEXED_CASE(SetUpvalue): {
+        frame->Closure->GetUpvalues()[index]->Set(slots[VM_READ_OPERAND()]);
+        VM_NEXT();
+      }
+      VM_INDEXED_CASE(GetGlobal): {
+        Symbol name = names[index];
+        uint8_t destination = VM_READ_OPERAND();
+        auto lookup = globals_.find(name);
+
+        if (lookup == globals_.end()) {
+          VM_ERROR("Undefined variable: '" + name.GetName() + "'.");
+        }
+
+        slots[destination] = lookup->second;
+        VM_NEXT();
+      }
+      VM_INDEXED_CASE(SetGlobal): {
+        Symbol name = names[index];
+        uint8_t source = VM_READ_OPERAND();
+        auto lookup = globals_.find(name);
+
+        if (lookup == globals_.end()) {
+          VM_ERROR("Undefined Variable '" + name.GetName() + "'.");
+        }
+
+        lookup->second = slots[source];
+        VM_NEXT();
+      }
+      VM_INDEXED_CASE(DefineGlobal): {
+        Symbol name = names[index];
+        globals_[name] = slots[VM_READ_OPERAND()];
+        VM_NEXT();
+      }
+      VM_INDEXED_CASE(GetProperty): {
+        Symbol name = names[index];
+        uint8_t destination = VM_READ_OPERAND();
+        uint8_t object = VM_READ_OPERAND();
+        VM_SAVE_IP();
+        Value property = GetProperty(slots[object], name);
+        slots[destination] = std::move(property);
+        VM_NEXT();
+      }
+      VM_INDEXED_CASE(SetProperty): {
+        Symbol name = names[index];
+        Value& object = slots[VM_READ_OPERAND()];
+        const Value& value = slots[VM_READ_OPERAND()];
+
+        if (!object.IsInstance()) {
+          VM_ERROR("Only instances have fields.");
+        }
+
+        object.AsObject<core::Instance>()->SetField(name, value);
+        VM_NEXT();
+      }
+      VM_INDEXED_CASE(GetSuper): {
+        Symbol name = names[index];
+        uint8_t destination = VM_READ_OPERAND();
+        const Value& super_class = slots[VM_READ_OPERAND()];
+        const Value& receiver = slots[VM_READ_OPERAND()];
+        core::Closure* method = super_class.AsObject<core::Class>()
+            ->LookupMethod(name);
+
+        if (method == nullptr) {
+          VM_ERROR("Undefined property '" + name.GetName() + "'.");
+        }
+
+        slots[destination] = lamscript::parsed::MakeRef<core::BoundMethod>(
+            receiver, Ref<core::Closure>(method));
+        VM_NEXT();
+      }
+      VM_CASE(Equal): {
+        Value& destination = slots[VM_READ_OPERAND()];
+        const Value& left_side = slots[VM_READ_OPERAND()];
+        destination = Interpreter::IsEqual(
+            left_side, slots[VM_READ_OPERAND()]);
+        VM_NEXT();
+      }
+      VM_CASE(NotEqual): {
+        Value& destination = slots[VM_READ_OPERAND()];
+        const Value& left_side = slots[VM_READ_OPERAND()];
+        destination = !Interpreter::IsEqual(
+            left_side, slots[VM_READ_OPERAND()]);
+        VM_NEXT();
+      }
+      VM_CASE(Greater): {
+        VM_REGISTER_NUMBER_OPERATION(>);
+        VM_NEXT();
+      }
+      VM_CASE(GreaterEqual): {
+        VM_REGISTER_NUMBER_OPERATION(>=);
+        VM_NEXT();
+      }
+      VM_CASE(Less): {
+        VM_REGISTER_NUMBER_OPERATION(<);
+        VM_NEXT();
+      }
+      VM_CASE(LessEqual): {
+        VM_REGISTER_NUMBER_OPERATION(<=);
+        VM_NEXT();
+      }
+      VM_CASE(Add): {
+        Value& destination = slots[VM_READ_OPERAND()];
+        const Value& left_side = slots[VM_READ_OPERAND()];
+        const Value& right_side = slots[VM_READ_OPERAND()];
+
+        if (left_side.IsNumber() && right_side.IsNumber()) {
+          destination = left_side.AsNumber() + right_side.AsNumber();
+        } else if (left_side.IsString() && right_side.IsString()) {
+          destination = lamscript::parsed::LamscriptString::Concatenate(
+              left_side.AsObject<lamscript::parsed::LamscriptString>(),
+              right_side.AsObject<lamscript::parsed::LamscriptString>());
+        } else {
+          VM_ERROR("Operands must be two numbers or strings.");
+        }
+
+        VM_NEXT();
+      }
+      VM_CASE(Subtract): {
+        VM_REGISTER_NUMBER_OPERATION(-);
+        VM_NEXT();
+      }
+      VM_CASE(Multiply): {
+        VM_REGISTER_NUMBER_OPERATION(*);
+        VM_NEXT();
+      }
+      VM_CASE(Divide): {
+        Value& destination = slots[VM_READ_OPERAND()];
+        const Value& left_side = slots[VM_READ_OPERAND()];
+        const Value& right_side = slots[VM_READ_OPERAND()];
+
+        if (!left_side.IsNumber() || !right_side.IsNumber()) {
+          VM_ERROR("Operands must both be numbers.");
+        }
+
+        if (right_side.AsNumber() == 0) {
+          VM_ERROR("Divide by 0 error.");
+        }
+
+        destination = left_side.AsNumber() / right_side.AsNumber();
+        VM_NEXT();
+      }
+      VM_CASE(Modulus): {
+        Value& destination = slots[VM_READ_OPERAND()];
+        const Value& left_side = slots[VM_READ_OPERAND()];
+        const Value& right_side = slots[VM_READ_OPERAND()];
+
+        if (!left_side.IsNumber() || !right_side.IsNumber()) {
+          VM_ERROR("Operands must both be numbers.");
+        }
+
+        destination = fmod(left_side.AsNumber(), right_side.AsNumber());
+        VM_NEXT();
+      }
+      VM_CASE(Not): {
+        Value& destination = slots[VM_READ_OPERAND()];
+        destination = !Interpreter::IsTruthy(slots[VM_READ_OPERAND()]);
+        VM_NEXT();
+      }
+      VM_CASE(Negate): {
+        Value& destination = slots[VM_READ_OPERAND()];
+        const Value& operand = slots[VM_READ_OPERAND()];
+
+        if (!operand.IsNumber()) {
+          VM_ERROR("Operand must be a number.");
+        }
+
+        destination = -operand.AsNumber();
+        VM_NEXT();
+      }
+      VM_CASE(Print): {
+        std::cout << core::ToString(slots[VM_READ_OPERAND()]) << std::endl;
+        VM_NEXT();
+      }
+      VM_JUMP_CASE(Jump): {
+        ip += offset;
+        VM_NEXT();
+      }
+      // The condition's register comes before the offset.
+      VM_CASE(JumpIfFalseLong):
+        condition = &slots[VM_READ_OPERAND()];
+        offset = VM_READ_LONG();
+        goto OffsetJumpIfFalse;
+      VM_CASE(JumpIfFalse):
+        condition = &slots[VM_READ_OPERAND()];
+        offset = VM_READ_SHORT();
+      OffsetJumpIfFalse: {
+        if (!Interpreter::IsTruthy(*condition)) {
+          ip += offset;
+        }
+
+        VM_NEXT();
+      }
+      VM_CASE(JumpIfTrueLong):
+        condition = &slots[VM_READ_OPERAND()];
+        offset = VM_READ_LONG();
+        goto OffsetJumpIfTrue;
+      VM_CASE(JumpIfTrue):
+        condition = &slots[VM_READ_OPERAND()];
+        offset = VM_READ_SHORT();
+      OffsetJumpIfTrue: {
+        if (Interpreter::IsTruthy(*condition)) {
+          ip += offset;
+        }
+
+        VM_NEXT();
+      }
+      VM_JUMP_CASE(Loop): {
+        ip -= offset;
+        VM_NEXT();
+      }
+      // Calls drop the registers above the arguments, which only hold dead
+      // temporaries, so that the callee's frame starts right after them.
+      VM_CASE(Call): {
+        uint8_t base = VM_READ_OPERAND();
+        uint8_t argument_count = VM_READ_OPERAND();
+        VM_SAVE_IP();
+        TruncateStack(slots + base + argument_count + 1);
+        CallValue(argument_count);
+        VM_LOAD_REGISTER_FRAME();
+        VM_NEXT();
+      }
+      VM_INDEXED_CASE(Invoke): {
+        Symbol name = names[index];
+        uint8_t base = VM_READ_OPERAND();
+        uint8_t argument_count = VM_READ_OPERAND();
+        VM_SAVE_IP();
+        TruncateStack(slots + base + argument_count + 1);
+        Invoke(name, argument_count);
+        VM_LOAD_REGISTER_FRAME();
+        VM_NEXT();
+      }
+      VM_INDEXED_CASE(Closure): {
+        core::Function* prototype = constants[index].AsObject<core::Function>();
+        uint8_t destination = VM_READ_OPERAND();
+        const std::vector<Ref<Cell>>& enclosing_upvalues =
+            frame->Closure->GetUpvalues();
+        std::vector<Ref<Cell>> upvalues;
+        upvalues.reserve(prototype->GetUpvalues().size());
+
+        for (const auto& upvalue : prototype->GetUpvalues()) {
+          upvalues.push_back(
+              upvalue.IsLocal
+                  ? cells[upvalue.Index]
+                  : enclosing_upvalues[upvalue.Index]);
+        }
+
+        slots[destination] = lamscript::parsed::MakeRef<core::Closure>(
+            Ref<core::Function>(prototype), std::move(upvalues));
+        VM_NEXT();
+      }
+      VM_INDEXED_CASE(Class): {
+        const Value& name = constants[index];
+        Value& class_def = slots[VM_READ_OPERAND()];
+        Ref<core::Class> super_class = nullptr;
+
+        if (VM_READ_OPERAND() == 1) {
+          if (!IsKind(class_def, core::ObjectKind::Class)) {
+            VM_ERROR("Superclass must be a class.");
+          }
+
+          super_class = Ref<core::Class>(class_def.AsObject<core::Class>());
+        }
+
+        class_def = lamscript::parsed::MakeRef<core::Class>(
+            name.AsString(),
+            std::move(super_class),
+            lamscript::parsing::SymbolMap<Ref<core::Closure>>());
+        VM_NEXT();
+      }
+      VM_CASE(Method): {
+        core::Class* class_def = slots[VM_READ_OPERAND()]
+            .AsObject<core::Class>();
+        class_def->AddMethod(
+            Ref<core::Closure>(
+                slots[VM_READ_OPERAND()].AsObject<core::Closure>()));
+        VM_NEXT();
+      }
+    }
+  }
+}
+
+#undef VM_LOAD_FRAME
+#undef VM_LOAD_REGISTER_FRAME
+#undef VM_SAVE_IP
+#undef VM_ERROR
+#undef VM_READ_OPERAND
+#undef VM_READ_SHORT
+#undef VM_READ_LONG
+#undef VM_PUSH
+#undef VM_POP
+#undef VM_NUMBER_OPERATION
+#undef VM_REGISTER_NUMBER_OPERATION
+#undef VM_COUNT_DISPATCH
+#undef VM_DISPATCH
+#undef VM_CASE
+#undef VM_INDEXED_CASE
+#undef VM_JUMP_CASE
+#undef VM_NEXT
+
+bool VirtualMachine::RecoverFromError(
+    const lamscript::RuntimeError& error, size_t base_frame) {
+  for (size_t i = frames_.GetCount(); i-- > base_frame;) {
+    CallFrame& frame = frames_[i];
+    const core::Function* function = frame.Closure->GetFunction();
+    const core::Chunk& chunk = function->GetChunk();
+    size_t index = frame.Ip - chunk.GetCode() - 1;
+
+    // Inner handlers are added before the handlers that enclose them.
+    for (const core::ErrorHandler& handler : chunk.GetErrorHandlers()) {
+      if (index < handler.Start || index >= handler.End) {
+        continue;
+      }
+
+      Lamscript::RuntimeError(error);
+      had_error_ = true;
+
+      frames_.Truncate(i + 1);
+      TruncateStack(stack_.begin() + frame.Base + function->GetFrameSize());
+      frame.Ip = chunk.GetCode() + handler.Target;
+      return true;
+    }
+  }
+
+  TruncateStack(stack_.begin() + frames_[base_frame].CalleeSlot);
+  frames_.Truncate(base_frame);
+  return false;
+}
+
+lamscript::RuntimeError VirtualMachine::Error(const std::string& message) {
+  const CallFrame& frame = frames_[frames_.GetCount() - 1];
+  const core::Chunk& chunk = frame.Closure->GetFunction()->GetChunk();
+  size_t line = chunk.GetLineAt(frame.Ip - chunk.GetCode() - 1);
+
+  return lamscript::RuntimeError(
+      lamscript::parsing::Token{
+          lamscript::parsing::IDENTIFIER, "", nullptr, static_cast<int>(line)},
+      message);
+}
+
+void VirtualMachine::CallValue(size_t argument_count) {
+  Value* callee = stack_top_ - argument_count - 1;
+  size_t callee_slot = callee - stack_.begin();
+
+  if (!callee->IsCallable()) {
+    throw Error("Can only call functions and classes;");
+  }
+
+  core::Object* object = callee->AsObject<core::Object>();
+
+  switch (object->GetKind()) {
+    case core::ObjectKind::Closure:
+      CallClosure(
+          static_cast<core::Closure*>(object),
+          callee_slot,
+          argument_count,
+          false);
+      return;
+    case core::ObjectKind::BoundMethod:
+    {
+      // The receiver replaces the bound method, so the method is kept alive
+      // by the frame from here on.
+      Ref<core::BoundMethod> bound(static_cast<core::BoundMethod*>(object));
+      *callee = bound->GetReceiver();
+      CallClosure(bound->GetMethod(), callee_slot, argument_count, false);
+      return;
+    }
+    case core::ObjectKind::Class:
+    {
+      core::Class* class_def = static_cast<core::Class*>(object);
+      core::Closure* constructor = class_def->GetConstructor();
+
+      if (constructor == nullptr && argument_count != 0) {
+        throw Error(
+            "Expected 0 arguments but got "
+                + std::to_string(argument_count) + ".");
+      }
+
+      *callee = lamscript::parsed::MakeRef<core::Instance>(class_def);
+
+      if (constructor != nullptr) {
+        CallClosure(constructor, callee_slot, argument_count, true);
+      }
+      return;
+    }
+    case core::ObjectKind::Native:
+    {
+      core::NativeFunction* native = static_cast<core::NativeFunction*>(
+          object);
+
+      if (native->GetArity() != argument_count) {
+        throw Error(
+            "Expected " + std::to_string(native->GetArity())
+                + " arguments but got " + std::to_string(argument_count)
+                + ".");
+      }
+
+      Value result = native->Call(callee + 1);
+      TruncateStack(callee);
+      *stack_top_++ = std::move(result);
+      return;
+    }
+    default:
+      throw Error("Can only call functions and classes;");
+  }
+}
+
+void VirtualMachine::CallClosure(
+    core::Closure* closure,
+    size_t callee_slot,
+    size_t argument_count,
+    bool is_construction) {
+  const core::Function* function = closure->GetFunction();
+
+  if (function->GetArity() != argument_count) {
+    throw Error(
+        "Expected " + std::to_string(function->GetArity())
+            + " arguments but got " + std::to_string(argument_count) + ".");
+  }
+
+  size_t base = function->IsMethod() ? callee_slot : callee_slot + 1;
+  size_t frame_size = std::max(
+      function->GetFrameSize(),
+      argument_count + (function->IsMethod() ? 1 : 0));
+
+  // Pushes are only bounds checked in debug builds, so the frame needs room
+  // for the most temporaries that the compiler found its instructions push.
+  if (frames_.IsFull()
+      || base + frame_size + function->GetStackDepth() > kMaxStackSize) {
+    throw Error("Stack overflow.");
+  }
+
+  stack_top_ = std::max(stack_top_, stack_.begin() + base + frame_size);
+
+  for (size_t slot : function->GetCapturedParameters()) {
+    cells_[base + slot] = lamscript::parsed::MakeRef<Cell>(
+        stack_[base + slot]);
+  }
+
+  size_t _ = frames_.Push(CallFrame{
+      Ref<core::Closure>(closure),
+      function->GetChunk().GetCode(),
+      base,
+      callee_slot,
+      is_construction});
+}
+
+void VirtualMachine::Invoke(Symbol name, size_t argument_count) {
+  Value* receiver = stack_top_ - argument_count - 1;
+  core::Closure* method = FindMethod(*receiver, name);
+
+  if (method != nullptr) {
+    // Static methods aren't bound to the class they're called on.
+    if (!receiver->IsInstance()) {
+      *receiver = nullptr;
+    }
+
+    CallClosure(method, receiver - stack_.begin(), argument_count, false);
+    return;
+  }
+
+  *receiver = GetProperty(*receiver, name);
+  CallValue(argument_count);
+}
+
+core::Closure* VirtualMachine::FindMethod(const Value& object, Symbol name) {
+  core::Class* class_def = nullptr;
+  bool is_instance = object.IsInstance();
+
+  if (is_instance) {
+    core::Instance* instance = object.AsObject<core::Instance>();
+
+    if (instance->FindField(name) != nullptr) {
+      return nullptr;
+    }
+
+    class_def = instance->GetClass();
+  } else if (IsKind(object, core::ObjectKind::Class)) {
+    class_def = object.AsObject<core::Class>();
+  } else {
+    return nullptr;
+  }
+
+  core::Closure* method = class_def->LookupMethod(name);
+
+  if (method == nullptr
+      || method->GetFunction()->IsGetter()
+      || (!is_instance && !method->GetFunction()->IsStatic())) {
+    return nullptr;
+  }
+
+  return method;
+}
+
+Value VirtualMachine::GetProperty(const Value& object, Symbol name) {
+  if (IsKind(object, core::ObjectKind::Class)) {
+    core::Closure* method = object.AsObject<core::Class>()->LookupMethod(name);
+
+    if (method == nullptr) {
+      throw Error("No static function found on class.");
+    }
+
+    if (!method->GetFunction()->IsStatic()) {
+      throw Error("Only instances can access non-static class methods.");
+    }
+
+    if (method->GetFunction()->IsGetter()) {
+      return CallGetter(method, nullptr);
+    }
+
+    return lamscript::parsed::MakeRef<core::BoundMethod>(
+        nullptr, Ref<core::Closure>(method));
+  }
+
+  if (!object.IsInstance()) {
+    throw Error("Only instances have properties.");
+  }
+
+  core::Instance* instance = object.AsObject<core::Instance>();
+  const Value* field = instance->FindField(name);
+
+  if (field == nullptr) {
+    core::Closure* method = instance->GetClass()->LookupMethod(name);
+
+    if (method == nullptr) {
+      throw Error("Undefined property '" + name.GetName() + "'.");
+    }
+
+    if (method->GetFunction()->IsGetter()) {
+      return CallGetter(method, object);
+    }
+
+    return lamscript::parsed::MakeRef<core::BoundMethod>(
+        object, Ref<core::Closure>(method));
+  }
+
+  // Getters that were bound through super and stored in a field are still
+  // called when they're read, like in lamscript's interpreter.
+  if (IsKind(*field, core::ObjectKind::BoundMethod)) {
+    core::BoundMethod* bound = field->AsObject<core::BoundMethod>();
+
+    if (bound->GetMethod()->GetFunction()->IsGetter()) {
+      Ref<core::BoundMethod> getter(bound);
+      return CallGetter(getter->GetMethod(), getter->GetReceiver());
+    }
+  }
+
+  return *field;
+}
+
+Value VirtualMachine::CallGetter(
+    core::Closure* getter, const Value& receiver) {
+  [[unlikely]] if (stack_top_ == stack_.end()) {
+    throw Error("Stack overflow.");
+  }
+
+  Value* callee = stack_top_;
+  *stack_top_++ = receiver;
+  CallClosure(getter, callee - stack_.begin(), 0, false);
+  return Run(frames_.GetCount() - 1);
+}
+
+void VirtualMachine::DefineClass(
+    const Value& name, size_t method_count, bool has_super_class) {
+  Value* methods_start = stack_top_ - method_count;
+  Value* class_slot = has_super_class ? methods_start - 1 : methods_start;
+  Ref<core::Class> super_class = nullptr;
+
+  if (has_super_class) {
+    if (!IsKind(*class_slot, core::ObjectKind::Class)) {
+      throw Error("Superclass must be a class.");
+    }
+
+    super_class = Ref<core::Class>(class_slot->AsObject<core::Class>());
+  }
+
+  lamscript::parsing::SymbolMap<Ref<core::Closure>> methods;
+
+  for (Value* method = methods_start; method < stack_top_; method++) {
+    core::Closure* closure = method->AsObject<core::Closure>();
+    methods.emplace(
+        Symbol::Intern(closure->GetFunction()->GetName()),
+        Ref<core::Closure>(closure));
+  }
+
+  Value class_def = lamscript::parsed::MakeRef<core::Class>(
+      name.AsString(), std::move(super_class), std::move(methods));
+  TruncateStack(class_slot);
+  *stack_top_++ = std::move(class_def);
+}
+
+/// Slots above the top of the stack are always nil, so values are released as
+/// soon as they're popped.
+void VirtualMachine::TruncateStack(Value* new_top) {
+  for (Value* slot = new_top; slot < stack_top_; slot++) {
+    *slot = nullptr;
+    cells_[slot - stack_.begin()] = nullptr;
+  }
+
+  stack_top_ = new_top;
+}
+
+}  // namespace lamscripten::vm
@@ -0,0 +1,146 @@
+#ifndef SRC_LAMSCRIPTEN_VM_VIRTUALMACHINE_H_
+#define SRC_LAMSCRIPTEN_VM_VIRTUALMACHINE_H_
+
+#include <cstdint>
+#include <string>
+
+#include <Lamscript/errors/RuntimeError.h>
+#include <Lamscript/parsing/Symbol.h>
+#include <Lamscript/runtime/Cell.h>
+#include <Lamscripten/core/Closure.h>
+#include <Lamscripten/core/Function.h>
+#include <Lamscripten/core/Types.h>
+#include <Lamscripten/core/Value.h>
+
+namespace lamscripten::vm {
+
+/// @brief The result of interpreting a program.
+enum class InterpretResult {
+  Ok,
+  /// @brief At least one runtime error was reported, whether or not the
+  /// program recovered from it.
+  RuntimeError
+};
+
+/// @brief A stack based virtual machine that runs compiled Lamscripten
+/// functions.
+///
+/// Every call gets a frame on a fixed capacity value stack. A frame starts at
+/// the callee's first argument (or the receiver for methods) and reserves the
+/// function's frame_size slots for its parameters and locals, with captured
+/// variables boxed into cells stored in a parallel array. Temporaries are
+/// pushed above the frame.
+///
+/// Functions compiled into register instructions address the slots of their
+/// frame as registers, with their temporaries in the slots above their locals.
+///
+/// Instructions are dispatched with computed gotos when compiling with GCC or
+/// Clang, and with a switch otherwise.
+///
+/// The value stack and call frames are stored inline, which makes machines
+/// a few megabytes large, so they should be allocated on the heap.
+class VirtualMachine {
+ public:
+  static constexpr size_t kMaxStackSize = 1 << 16;
+  static constexpr size_t kMaxFrames = 1 << 14;
+
+  VirtualMachine();
+
+  /// @brief Runs the top level function of a program. Globals that it defines
+  /// stay defined for the programs that are interpreted after it.
+  InterpretResult Interpret(const core::Ref<core::Function>& script);
+
+#ifdef LAMSCRIPTEN_COUNT_DISPATCHES
+  /// @brief The number of instructions that have been dispatched so far.
+  [[nodiscard]] uint64_t GetDispatchCount() const { return dispatch_count_; }
+#endif
+
+ private:
+  struct CallFrame {
+    /// @brief Keeps the closure alive while it's running, since methods can
+    /// be called without a reference to them on the stack.
+    core::Ref<core::Closure> Closure;
+    /// @brief The next instruction, which is only up to date while the frame
+    /// isn't the one running.
+    const uint8_t* Ip;
+    size_t Base;
+    /// @brief The slot that the result of the call replaces.
+    size_t CalleeSlot;
+    /// @brief Calls to a class return the new instance from its constructor
+    /// no matter what the constructor returns.
+    bool IsConstruction;
+  };
+
+  /// @brief Every slot of the stack is in use as far as the array is
+  /// concerned, and stack_top_ tracks the top instead.
+  core::FixedArray<core::Value, kMaxStackSize> stack_;
+  core::FixedArray<core::Ref<lamscript::runtime::Cell>, kMaxStackSize> cells_;
+  core::Value* stack_top_;
+  core::FixedArray<CallFrame, kMaxFrames> frames_;
+  lamscript::parsing::SymbolMap<core::Value> globals_;
+  bool had_error_;
+#ifdef LAMSCRIPTEN_COUNT_DISPATCHES
+  uint64_t dispatch_count_ = 0;
+#endif
+
+  /// @brief Runs frames until the frame at base_frame returns, recovering
+  /// from the errors that the frames handle.
+  core::Value Run(size_t base_frame);
+
+  /// @brief The dispatch loop of stack instructions.
+  core::Value Execute(size_t base_frame);
+
+  /// @brief The dispatch loop of register instructions.
+  core::Value ExecuteRegisters(size_t base_frame);
+
+  /// @brief Reports an error and resumes at the innermost handler of the
+  /// frames above base_frame. Returns false, leaving only the frames below
+  /// base_frame, when none of them handle it.
+  bool RecoverFromError(
+      const lamscript::RuntimeError& error, size_t base_frame);
+
+  /// @brief Creates an error at the line of the instruction that the top
+  /// frame is running.
+  [[nodiscard]] lamscript::RuntimeError Error(const std::string& message);
+
+  /// @brief Calls the callee below the arguments on top of the stack. Calls
+  /// to closures push a frame for the dispatch loop to run, while everything
+  /// else is called in place.
+  void CallValue(size_t argument_count);
+
+  void CallClosure(
+      core::Closure* closure,
+      size_t callee_slot,
+      size_t argument_count,
+      bool is_construction);
+
+  /// @brief Calls a method of the object below the arguments on top of the
+  /// stack without binding it first.
+  void Invoke(lamscript::parsing::Symbol name, size_t argument_count);
+
+  /// @brief Finds the method that calling the named property of the object
+  /// would call, or a nullptr if the call has to read the property instead.
+  [[nodiscard]] static core::Closure* FindMethod(
+      const core::Value& object, lamscript::parsing::Symbol name);
+
+  /// @brief Reads a property of an instance or a static method of a class,
+  /// calling getters.
+  core::Value GetProperty(
+      const core::Value& object, lamscript::parsing::Symbol name);
+
+  /// @brief Calls a getter, running it to completion before returning.
+  core::Value CallGetter(core::Closure* getter, const core::Value& receiver);
+
+  /// @brief Creates a class out of the method closures on top of the stack
+  /// and the super class below them.
+  void DefineClass(
+      const core::Value& name, size_t method_count, bool has_super_class);
+
+  /// @brief Pops the stack down to the slot, releasing the values and cells
+  /// above it.
+  void TruncateStack(core::Value* new_top);
+};
+
+}  // namespace lamscripten::vm
+
+#endif  // SRC_LAMSCRIPTEN_VM_VIRTUALMACHINE_H_
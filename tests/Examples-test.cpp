@@ -2,6 +2,7 @@
 
 #include <Lamscript/runtime/Lamscript.h>
 
+using ::lamscript::runtime::ExecutionEngine;
 using ::lamscript::runtime::ProgramStatus;
 using ::lamscript::runtime::ProgramResult;
 using ::lamscript::runtime::Lamscript;
@@ -95,3 +96,15 @@ TEST(Examples, Variables) {
   ASSERT_EQ(result.Status, ProgramStatus::Success);
   EXPECT_EQ(result.ReturnCode, 0);
 }
+
+TEST(Examples, ClosureCompiledClassesAndClosures) {
+  Lamscript::SetExecutionEngine(ExecutionEngine::ClosureCompiler);
+  ProgramResult closures = Lamscript::RunFile("examples/closure.ls");
+  ProgramResult classes = Lamscript::RunFile("examples/super.ls");
+  Lamscript::SetExecutionEngine(ExecutionEngine::TreeWalker);
+
+  ASSERT_EQ(closures.Status, ProgramStatus::Success);
+  EXPECT_EQ(closures.ReturnCode, 0);
+  ASSERT_EQ(classes.Status, ProgramStatus::Success);
+  EXPECT_EQ(classes.ReturnCode, 0);
+}
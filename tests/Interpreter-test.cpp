@@ -0,0 +1,238 @@
+#include <gtest/gtest.h>
+
+#include <iostream>
+#include <sstream>
+#include <string>
+
+#include <Lamscript/runtime/Lamscript.h>
+
+using ::lamscript::runtime::ExecutionEngine;
+using ::lamscript::runtime::Lamscript;
+using ::lamscript::runtime::ProgramResult;
+using ::lamscript::runtime::ProgramStatus;
+
+namespace {
+
+/// @brief A way of running programs that every behavior test is checked
+/// against.
+struct Configuration {
+  const char* Name;
+  ExecutionEngine Engine;
+  bool Optimize;
+};
+
+const Configuration kConfigurations[] = {
+  {"tree walker", ExecutionEngine::TreeWalker, true},
+  {"tree walker without optimizations", ExecutionEngine::TreeWalker, false},
+  {"closure compiler", ExecutionEngine::ClosureCompiler, true},
+};
+
+/// @brief Runs the source and returns everything that it printed.
+std::string RunAndCapture(
+    const std::string& source, const Configuration& configuration) {
+  std::ostringstream output;
+  std::streambuf* previous_buffer = std::cout.rdbuf(output.rdbuf());
+
+  Lamscript::SetExecutionEngine(configuration.Engine);
+  Lamscript::SetOptimizationsEnabled(configuration.Optimize);
+  Lamscript::Run(source);
+  Lamscript::SetOptimizationsEnabled(true);
+  Lamscript::SetExecutionEngine(ExecutionEngine::TreeWalker);
+
+  std::cout.rdbuf(previous_buffer);
+  return output.str();
+}
+
+/// @brief Expects the source to print the same output in every
+/// configuration.
+void ExpectOutput(const std::string& source, const std::string& expected) {
+  for (const Configuration& configuration : kConfigurations) {
+    EXPECT_EQ(RunAndCapture(source, configuration), expected)
+        << "when run by the " << configuration.Name;
+  }
+}
+
+}  // namespace
+
+TEST(Interpreter, InlineCachesOutliveTheirShapes) {
+  // The classes are freed after every call, so their shapes would be
+  // allocated at the same addresses if the cache of `o.y` didn't hold them.
+  ExpectOutput(
+      "func makeA() {"
+      "  class A { constructor() { this.x = \"A-x\"; this.y = \"A-y\"; } }"
+      "  return A();"
+      "}"
+      "func makeB() {"
+      "  class B { constructor() { this.y = \"B-y\"; this.z = \"B-z\"; } }"
+      "  return B();"
+      "}"
+      "func read(o) { return o.y; }"
+      "var i = 0;"
+      "while (i < 3) {"
+      "  print read(makeA());"
+      "  print read(makeB());"
+      "  i = i + 1;"
+      "}",
+      "A-y\nB-y\nA-y\nB-y\nA-y\nB-y\n");
+}
+
+TEST(Interpreter, FlattenDeeplyConcatenatedStrings) {
+  ExpectOutput(
+      "var appended = \"\";"
+      "var prepended = \"\";"
+      "var i = 0;"
+      "while (i < 20000) {"
+      "  appended = appended + \"ab\";"
+      "  prepended = \"ab\" + prepended;"
+      "  i = i + 1;"
+      "}"
+      "print appended == prepended;"
+      "print appended == prepended + \"a\";"
+      "print (appended + \"c\") == (\"a\" + prepended + \"c\");"
+      "var short = \"x\";"
+      "i = 0;"
+      "while (i < 40) { short = short + \"y\"; i = i + 1; }"
+      "print short;",
+      "true\nfalse\nfalse\nx" + std::string(40, 'y') + "\n");
+}
+
+TEST(Interpreter, FoldedArithmeticMatchesUnoptimized) {
+  ExpectOutput(
+      "print (1 + 2) * 3 - (4 / 2);"
+      "print 7 % 4 + -(2 * 3);"
+      "print 1 < 2 and 3 >= 3;"
+      "print !(1 == 1) or nil;"
+      "{"
+      "  var base = 10;"
+      "  var scaled = base * 2;"
+      "  var counter = 0;"
+      "  counter = counter + scaled;"
+      "  func add(value) { return value + base; }"
+      "  print add(scaled) + counter;"
+      "  { var base = 1; print base + scaled; }"
+      "}",
+      "7.000000\n-3.000000\ntrue\nnil\n50.000000\n21.000000\n");
+}
+
+TEST(Interpreter, FoldedStringsMatchUnoptimized) {
+  ExpectOutput(
+      "print \"con\" + \"cat\" + \"enated\";"
+      "print \"a\" + \"b\" == \"ab\";"
+      "{ var name = \"lam\"; print name + \"script\"; }",
+      "concatenated\ntrue\nlamscript\n");
+}
+
+TEST(Interpreter, DeadBranchesMatchUnoptimized) {
+  ExpectOutput(
+      "if (1 > 2) { print \"then\"; } else { print \"else\"; }"
+      "if (\"yes\") print \"truthy\";"
+      "if (nil) print \"never\";"
+      "{ var debug = false; if (debug) print \"debug\"; else print \"off\"; }"
+      "print \"done\";",
+      "else\ntruthy\noff\ndone\n");
+}
+
+TEST(Interpreter, DeoptimizeBinaryExpressionsOnNewTypes) {
+  ExpectOutput(
+      "func subtract(a, b) { return a - b; }\n"
+      "print subtract(3, 1);\n"
+      "print subtract(\"a\", \"b\");\n",
+      "2.000000\n[line 1] RuntimeError: Operands must both be numbers.\nnil\n");
+  ExpectOutput(
+      "func add(a, b) { return a + b; }\n"
+      "print add(1, 2);\n"
+      "print add(\"a\", \"b\");\n"
+      "print add(1, \"b\");\n",
+      "3.000000\nab\n"
+      "[line 1] RuntimeError: Operands must be two numbers or strings.\n"
+      "nil\n");
+  ExpectOutput(
+      "func less(a, b) { return a < b; }\n"
+      "print less(1, 2);\n"
+      "print less(\"a\", 2);\n",
+      "true\n[line 1] RuntimeError: Operands must both be numbers.\nnil\n");
+  ExpectOutput(
+      "func same(a, b) { return a == b; }\n"
+      "print same(1, 1);\n"
+      "print same(\"a\", \"a\");\n"
+      "print same(1, \"1\");\n",
+      "true\ntrue\nfalse\n");
+}
+
+TEST(Interpreter, DeoptimizeUnaryExpressionsOnNewTypes) {
+  ExpectOutput(
+      "func negate(a) { return -a; }\n"
+      "print negate(1);\n"
+      "print negate(\"a\");\n",
+      "-1.000000\n[line 1] RuntimeError: Operand must be a number.\nnil\n");
+  ExpectOutput(
+      "func invert(a) { return !a; }\n"
+      "print invert(true);\n"
+      "print invert(nil);\n"
+      "print invert(0);\n",
+      "false\ntrue\ntrue\n");
+}
+
+TEST(Interpreter, RuntimeErrorsOnlyFailTheirOwnRun) {
+  std::ostringstream output;
+  std::streambuf* previous_buffer = std::cout.rdbuf(output.rdbuf());
+
+  ProgramResult failed = Lamscript::Run("print -\"a\";");
+  ProgramResult succeeded = Lamscript::Run("print 1;");
+
+  std::cout.rdbuf(previous_buffer);
+  EXPECT_EQ(failed.Status, ProgramStatus::FailedAtInterpeter);
+  EXPECT_EQ(succeeded.Status, ProgramStatus::Success);
+}
+
+TEST(Interpreter, RecurseAsDeeplyAsTheNativeStackAllows) {
+  ExpectOutput(
+      "func Count(n) { if (n == 0) return 0; return 1 + Count(n - 1); }\n"
+      "print Count(3000);\n",
+      "3000.000000\n");
+}
+
+TEST(Interpreter, ReportStackOverflowsOnce) {
+  // The overflow stops the program instead of every frame that it unwinds
+  // recovering and failing to add nil.
+  ExpectOutput(
+      "func Count(n) { if (n == 0) return 0; return 1 + Count(n - 1); }\n"
+      "print Count(100000);\n"
+      "print \"unreachable\";\n",
+      "[line 1] RuntimeError: Stack overflow.\n");
+  ExpectOutput(
+      "func Recurse(depth) { { return Recurse(depth + 1); } }\n"
+      "print Recurse(0);\n",
+      "[line 1] RuntimeError: Stack overflow.\n");
+}
+
+TEST(Interpreter, StackOverflowsPopEveryFrame) {
+  for (int i = 0; i < 8; ++i) {
+    ExpectOutput(
+        "func Count(n) { if (n == 0) return 0; return 1 + Count(n - 1); }\n"
+        "Count(100000);\n",
+        "[line 1] RuntimeError: Stack overflow.\n");
+  }
+
+  ExpectOutput(
+      "func Count(n) { if (n == 0) return 0; return 1 + Count(n - 1); }\n"
+      "print Count(3000);\n",
+      "3000.000000\n");
+}
+
+TEST(Interpreter, TopLevelErrorsPopTheirFrames) {
+  std::ostringstream output;
+  std::streambuf* previous_buffer = std::cout.rdbuf(output.rdbuf());
+
+  for (int i = 0; i < 2000; ++i) {
+    Lamscript::Run("print -\"a\";");
+  }
+
+  Lamscript::Run(
+      "func Count(n) { if (n == 0) return 0; return 1 + Count(n - 1); }\n"
+      "print Count(1000);\n");
+
+  std::cout.rdbuf(previous_buffer);
+  EXPECT_EQ(
+      output.str().substr(output.str().size() - 12), "1000.000000\n");
+}
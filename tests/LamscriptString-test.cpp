@@ -0,0 +1,62 @@
+#include <gtest/gtest.h>
+
+#include <string>
+
+#include <Lamscript/parsed/LamscriptString.h>
+
+using ::lamscript::parsed::LamscriptString;
+using ::lamscript::parsed::MakeRef;
+using ::lamscript::parsed::Ref;
+
+TEST(LamscriptString, FlattenDeepRopes) {
+  const std::string piece = "0123456789abcdefghijklmnopqrstuvwxyz";
+  Ref<LamscriptString> appended = MakeRef<LamscriptString>(piece);
+  Ref<LamscriptString> prepended = MakeRef<LamscriptString>(piece);
+  Ref<LamscriptString> other = MakeRef<LamscriptString>(piece);
+  std::string expected = piece;
+
+  for (int i = 0; i < 100000; ++i) {
+    appended = LamscriptString::Concatenate(appended.get(), other.get());
+    prepended = LamscriptString::Concatenate(other.get(), prepended.get());
+    expected += piece;
+  }
+
+  EXPECT_EQ(appended->GetLength(), expected.size());
+  EXPECT_EQ(appended->GetValue(), expected);
+  EXPECT_EQ(prepended->GetLength(), expected.size());
+  EXPECT_EQ(prepended->GetValue(), expected);
+}
+
+TEST(LamscriptString, FlattenSharedRopes) {
+  Ref<LamscriptString> shared = LamscriptString::Concatenate(
+      MakeRef<LamscriptString>(std::string(40, 'a')).get(),
+      MakeRef<LamscriptString>(std::string(40, 'b')).get());
+  Ref<LamscriptString> first = LamscriptString::Concatenate(
+      shared.get(), MakeRef<LamscriptString>(std::string(40, 'c')).get());
+  Ref<LamscriptString> second = LamscriptString::Concatenate(
+      MakeRef<LamscriptString>(std::string(40, 'd')).get(), shared.get());
+
+  // Flattening one rope mustn't change the strings that others share with it.
+  EXPECT_EQ(
+      first->GetValue(),
+      std::string(40, 'a') + std::string(40, 'b') + std::string(40, 'c'));
+  EXPECT_EQ(
+      second->GetValue(),
+      std::string(40, 'd') + std::string(40, 'a') + std::string(40, 'b'));
+  EXPECT_EQ(shared->GetValue(), std::string(40, 'a') + std::string(40, 'b'));
+}
+
+TEST(LamscriptString, CopyShortConcatenations) {
+  Ref<LamscriptString> left = MakeRef<LamscriptString>(std::string("foo"));
+  Ref<LamscriptString> right = MakeRef<LamscriptString>(std::string("bar"));
+  Ref<LamscriptString> empty = MakeRef<LamscriptString>(std::string());
+
+  EXPECT_EQ(
+      LamscriptString::Concatenate(left.get(), right.get())->GetValue(),
+      "foobar");
+  EXPECT_EQ(
+      LamscriptString::Concatenate(left.get(), empty.get()).get(), left.get());
+  EXPECT_EQ(
+      LamscriptString::Concatenate(empty.get(), right.get()).get(),
+      right.get());
+}
@@ -0,0 +1,152 @@
+#include <gtest/gtest.h>
+
+#include <cstdio>
+#include <filesystem>
+#include <fstream>
+#include <string>
+
+#include <Lamscripten/cache/BytecodeCache.h>
+#include <Lamscripten/core/Chunk.h>
+#include <Lamscripten/core/Function.h>
+
+#include "RunScript.h"
+
+using ::lamscripten::cache::GetCachePath;
+using ::lamscripten::cache::HashSource;
+using ::lamscripten::cache::LoadCache;
+using ::lamscripten::cache::WriteCache;
+using ::lamscripten::core::Function;
+using ::lamscripten::core::InstructionSet;
+using ::lamscripten::core::Ref;
+using ::lamscripten::test::Compile;
+using ::lamscripten::test::RunScript;
+
+namespace {
+
+const char kSource[] =
+    "class Counter {\n"
+    "  constructor(start) { this.count = start; }\n"
+    "  Next() { this.count = this.count + 1; return this.count; }\n"
+    "}\n"
+    "func MakeGreeting(name) {\n"
+    "  func Greet() { return \"hello \" + name; }\n"
+    "  return Greet;\n"
+    "}\n"
+    "var counter = Counter(41);\n"
+    "print counter.Next();\n"
+    "print MakeGreeting(\"cache\")();\n";
+
+const char kOutput[] = "42.000000\nhello cache\n";
+
+/// @brief Removes the cache file at the path when the test is done with it.
+class CacheFile {
+ public:
+  explicit CacheFile(const char* name)
+      : path_(
+          (std::filesystem::temp_directory_path() / name).string()) {}
+
+  ~CacheFile() { std::remove(path_.c_str()); }
+
+  [[nodiscard]] const std::string& GetPath() const { return path_; }
+
+ private:
+  std::string path_;
+};
+
+}  // namespace
+
+TEST(BytecodeCache, LoadWhatWasWritten) {
+  CacheFile file("lamscripten-cache-test.lsc");
+
+  for (InstructionSet set : {InstructionSet::Stack, InstructionSet::Register}) {
+    Ref<Function> script = Compile(kSource, set);
+    ASSERT_NE(script.get(), nullptr);
+    ASSERT_TRUE(WriteCache(file.GetPath(), HashSource(kSource), *script));
+
+    Ref<Function> cached = LoadCache(file.GetPath(), HashSource(kSource), set);
+    ASSERT_NE(cached.get(), nullptr);
+    EXPECT_EQ(RunScript(cached), kOutput);
+  }
+}
+
+TEST(BytecodeCache, RejectStaleSources) {
+  CacheFile file("lamscripten-stale-test.lsc");
+  Ref<Function> script = Compile(kSource, InstructionSet::Stack);
+  ASSERT_NE(script.get(), nullptr);
+  ASSERT_TRUE(WriteCache(file.GetPath(), HashSource(kSource), *script));
+
+  std::string edited = std::string(kSource) + "print 1;\n";
+  EXPECT_NE(HashSource(edited), HashSource(kSource));
+  EXPECT_EQ(
+      LoadCache(file.GetPath(), HashSource(edited), InstructionSet::Stack)
+          .get(),
+      nullptr);
+}
+
+TEST(BytecodeCache, RejectOtherInstructionSets) {
+  CacheFile file("lamscripten-set-test.lsc");
+  Ref<Function> script = Compile(kSource, InstructionSet::Register);
+  ASSERT_NE(script.get(), nullptr);
+  ASSERT_TRUE(WriteCache(file.GetPath(), HashSource(kSource), *script));
+
+  EXPECT_EQ(
+      LoadCache(file.GetPath(), HashSource(kSource), InstructionSet::Stack)
+          .get(),
+      nullptr);
+}
+
+TEST(BytecodeCache, RejectTruncatedFiles) {
+  CacheFile file("lamscripten-truncated-test.lsc");
+  Ref<Function> script = Compile(kSource, InstructionSet::Stack);
+  ASSERT_NE(script.get(), nullptr);
+  ASSERT_TRUE(WriteCache(file.GetPath(), HashSource(kSource), *script));
+
+  // Cuts the file off at every length, in the header, within a nested
+  // function, and partway through the code.
+  uintmax_t size = std::filesystem::file_size(file.GetPath());
+
+  for (uintmax_t length = size; length-- > 0;) {
+    std::filesystem::resize_file(file.GetPath(), length);
+    EXPECT_EQ(
+        LoadCache(file.GetPath(), HashSource(kSource), InstructionSet::Stack)
+            .get(),
+        nullptr)
+        << "when truncated to " << length << " of " << size << " bytes";
+  }
+}
+
+TEST(BytecodeCache, RejectCorruptedFiles) {
+  CacheFile file("lamscripten-corrupted-test.lsc");
+  Ref<Function> script = Compile(kSource, InstructionSet::Stack);
+  ASSERT_NE(script.get(), nullptr);
+  ASSERT_TRUE(WriteCache(file.GetPath(), HashSource(kSource), *script));
+
+  // The script's code is at the end of the file, so flipping the last byte
+  // changes an instruction without changing the size of the file.
+  std::fstream stream(
+      file.GetPath(), std::ios::in | std::ios::out | std::ios::binary);
+  stream.seekg(-1, std::ios::end);
+  char byte = static_cast<char>(stream.get());
+  stream.seekp(-1, std::ios::end);
+  stream.put(static_cast<char>(byte ^ 0x5a));
+  stream.close();
+
+  EXPECT_EQ(
+      LoadCache(file.GetPath(), HashSource(kSource), InstructionSet::Stack)
+          .get(),
+      nullptr);
+}
+
+TEST(BytecodeCache, RejectMissingFiles) {
+  CacheFile file("lamscripten-missing-test.lsc");
+
+  EXPECT_EQ(
+      LoadCache(file.GetPath(), HashSource(kSource), InstructionSet::Stack)
+          .get(),
+      nullptr);
+}
+
+TEST(BytecodeCache, PutCacheFilesNextToScripts) {
+  EXPECT_EQ(GetCachePath("examples/class.ls"), "examples/class.lsc");
+  EXPECT_EQ(GetCachePath("script"), "script.lsc");
+}
@@ -0,0 +1,144 @@
+#include <gtest/gtest.h>
+
+#include <string>
+
+#include <Lamscript/parsing/Symbol.h>
+#include <Lamscripten/core/Chunk.h>
+#include <Lamscripten/core/Function.h>
+#include <Lamscripten/core/Value.h>
+
+using ::lamscript::parsed::FunctionMetadata;
+using ::lamscript::parsed::MakeRef;
+using ::lamscript::parsing::Symbol;
+using ::lamscripten::core::Chunk;
+using ::lamscripten::core::Function;
+using ::lamscripten::core::OpCode;
+using ::lamscripten::core::Ref;
+using ::lamscripten::core::Value;
+
+TEST(Chunk, ShareLineRunsWithinALine) {
+  Chunk chunk;
+  size_t _ = chunk.WriteOpCode(OpCode::Constant, 1);
+  _ = chunk.WriteBytes({0});
+  _ = chunk.WriteOpCode(OpCode::Constant, 1);
+  _ = chunk.WriteBytes({1});
+  _ = chunk.WriteOpCode(OpCode::Add, 1);
+  _ = chunk.WriteOpCode(OpCode::Print, 3);
+  _ = chunk.WriteOpCode(OpCode::Nil, 3);
+  _ = chunk.WriteOpCode(OpCode::Return, 3);
+
+  ASSERT_EQ(chunk.GetLineRuns().GetCount(), 2u);
+  EXPECT_EQ(chunk.GetLineRuns().begin()[0].Start, 0u);
+  EXPECT_EQ(chunk.GetLineRuns().begin()[0].Line, 1u);
+  EXPECT_EQ(chunk.GetLineRuns().begin()[1].Start, 5u);
+  EXPECT_EQ(chunk.GetLineRuns().begin()[1].Line, 3u);
+
+  // Operands are on the line of their instruction.
+  const size_t expected_lines[] = {1, 1, 1, 1, 1, 3, 3, 3};
+  for (size_t i = 0; i < chunk.GetOpCodeCount(); i++) {
+    EXPECT_EQ(chunk.GetLineAt(i), expected_lines[i]) << "at byte " << i;
+  }
+}
+
+TEST(Chunk, StartNewRunsWhenLinesRepeatLater) {
+  Chunk chunk;
+  size_t _ = chunk.WriteOpCode(OpCode::True, 2);
+  _ = chunk.WriteOpCode(OpCode::False, 7);
+  _ = chunk.WriteOpCode(OpCode::Not, 2);
+  _ = chunk.WriteOpCode(OpCode::Pop, 2);
+
+  ASSERT_EQ(chunk.GetLineRuns().GetCount(), 3u);
+  EXPECT_EQ(chunk.GetLineAt(0), 2u);
+  EXPECT_EQ(chunk.GetLineAt(1), 7u);
+  EXPECT_EQ(chunk.GetLineAt(2), 2u);
+  EXPECT_EQ(chunk.GetLineAt(3), 2u);
+
+  auto bytes = chunk.GetBytesFromLine(2);
+  ASSERT_EQ(bytes.GetCount(), 3u);
+  EXPECT_EQ(bytes.begin()[0], static_cast<uint8_t>(OpCode::True));
+  EXPECT_EQ(bytes.begin()[1], static_cast<uint8_t>(OpCode::Not));
+  EXPECT_EQ(bytes.begin()[2], static_cast<uint8_t>(OpCode::Pop));
+  EXPECT_EQ(chunk.GetBytesFromLine(4).GetCount(), 0u);
+}
+
+TEST(Chunk, LoadLineRunsAddedInOrder) {
+  Chunk chunk;
+  chunk.AddLineRun({0, 4});
+  chunk.AddLineRun({3, 9});
+  chunk.AddLineRun({10, 12});
+
+  EXPECT_EQ(chunk.GetLineAt(0), 4u);
+  EXPECT_EQ(chunk.GetLineAt(2), 4u);
+  EXPECT_EQ(chunk.GetLineAt(3), 9u);
+  EXPECT_EQ(chunk.GetLineAt(9), 9u);
+  EXPECT_EQ(chunk.GetLineAt(10), 12u);
+  EXPECT_EQ(chunk.GetLineAt(1000), 12u);
+}
+
+TEST(Chunk, HaveNoLineBeforeTheFirstInstruction) {
+  Chunk chunk;
+  EXPECT_EQ(chunk.GetLineAt(0), 0u);
+  EXPECT_EQ(chunk.GetLineRuns().GetCount(), 0u);
+}
+
+TEST(Chunk, ReuseTheIndicesOfEqualConstants) {
+  Chunk chunk;
+  size_t number = chunk.AddConstant(1.0);
+  size_t text = chunk.AddConstant(std::string("text"));
+  size_t truth = chunk.AddConstant(true);
+  size_t nil = chunk.AddConstant(nullptr);
+
+  EXPECT_EQ(chunk.AddConstant(1.0), number);
+  // Strings are equal by their text rather than by their object.
+  EXPECT_EQ(chunk.AddConstant(std::string("text")), text);
+  EXPECT_EQ(chunk.AddConstant(true), truth);
+  EXPECT_EQ(chunk.AddConstant(nullptr), nil);
+  EXPECT_EQ(chunk.GetConstantCount(), 4u);
+  EXPECT_EQ(chunk.GetConstantAt(text)->AsString(), "text");
+}
+
+TEST(Chunk, KeepConstantsOfDifferentTypesApart) {
+  Chunk chunk;
+  size_t number = chunk.AddConstant(1.0);
+  size_t text = chunk.AddConstant(std::string("1"));
+  size_t truth = chunk.AddConstant(true);
+  size_t zero = chunk.AddConstant(0.0);
+  size_t falsehood = chunk.AddConstant(false);
+  size_t nil = chunk.AddConstant(nullptr);
+
+  EXPECT_NE(number, text);
+  EXPECT_NE(number, truth);
+  EXPECT_NE(zero, falsehood);
+  EXPECT_NE(zero, nil);
+  EXPECT_NE(falsehood, nil);
+  // Negative zero prints differently, so it isn't folded into zero.
+  EXPECT_NE(chunk.AddConstant(-0.0), zero);
+  EXPECT_EQ(chunk.GetConstantCount(), 7u);
+}
+
+TEST(Chunk, KeepDifferentFunctionsApart) {
+  Chunk chunk;
+  Ref<Function> first = MakeRef<Function>(
+      "same", 0, 0, FunctionMetadata{false, false, false}, false);
+  Ref<Function> second = MakeRef<Function>(
+      "same", 0, 0, FunctionMetadata{false, false, false}, false);
+
+  size_t first_index = chunk.AddConstant(Value(first));
+  size_t second_index = chunk.AddConstant(Value(second));
+
+  EXPECT_NE(first_index, second_index);
+  EXPECT_EQ(chunk.AddConstant(Value(first)), first_index);
+  EXPECT_EQ(chunk.GetConstantCount(), 2u);
+}
+
+TEST(Chunk, ReuseTheIndicesOfNames) {
+  Chunk chunk;
+  size_t first = chunk.AddName(Symbol::Intern("first"));
+  size_t second = chunk.AddName(Symbol::Intern("second"));
+
+  EXPECT_NE(first, second);
+  EXPECT_EQ(chunk.AddName(Symbol::Intern("first")), first);
+  EXPECT_EQ(chunk.AddName(Symbol::Intern("second")), second);
+  EXPECT_EQ(chunk.GetNameAt(first)->GetName(), "first");
+  EXPECT_FALSE(chunk.GetNameAt(2).has_value());
+}
@@ -0,0 +1,247 @@
+#include <gtest/gtest.h>
+
+#include <string>
+
+#include <Lamscripten/core/Chunk.h>
+#include <Lamscripten/core/Function.h>
+#include <Lamscripten/util/Debug.h>
+
+#include "RunScript.h"
+
+using ::lamscripten::core::Function;
+using ::lamscripten::core::InstructionSet;
+using ::lamscripten::core::Ref;
+using ::lamscripten::test::CaptureOutput;
+using ::lamscripten::test::Compile;
+using ::lamscripten::test::RunScript;
+using ::lamscripten::test::RunWithLamscript;
+using ::lamscripten::test::RunWithLamscripten;
+using ::lamscripten::util::DisassembleFunction;
+
+namespace {
+
+const InstructionSet kInstructionSets[] = {
+  InstructionSet::Stack,
+  InstructionSet::Register,
+};
+
+/// @brief Compiles the source and returns its disassembly, or an empty string
+/// if it doesn't compile.
+std::string Disassemble(
+    const std::string& source, InstructionSet instruction_set) {
+  Ref<Function> script = Compile(source, instruction_set);
+
+  if (script.get() == nullptr) {
+    return "";
+  }
+
+  return CaptureOutput([&script]() { DisassembleFunction(*script); });
+}
+
+/// @brief Gets a function that counts to count in its body, which takes more
+/// code than a short jump can skip over.
+std::string MakeLongBody(const std::string& header, int count) {
+  std::string source = "func Count(limit) {\n  var total = 0;\n";
+  source += "  " + header + " {\n";
+
+  for (int i = 0; i < count; ++i) {
+    source += "    total = total + 1;\n";
+  }
+
+  return source + "  }\n  return total;\n}\n";
+}
+
+}  // namespace
+
+TEST(Compiler, UseShortFormsForSmallOperands) {
+  const std::string source =
+      "func Add(a) {\n"
+      "  var b = 2;\n"
+      "  if (a > b) { return a + b; }\n"
+      "  return a;\n"
+      "}\n"
+      "print Add(3);\n";
+
+  for (InstructionSet instruction_set : kInstructionSets) {
+    std::string disassembly = Disassemble(source, instruction_set);
+    EXPECT_NE(disassembly.find("OP_JUMP_IF_FALSE "), std::string::npos);
+    EXPECT_EQ(disassembly.find("_LONG"), std::string::npos) << disassembly;
+    EXPECT_EQ(RunWithLamscripten(source, instruction_set), "5.000000\n");
+  }
+}
+
+TEST(Compiler, ShareConstantsAndNamesWithinAChunk) {
+  const std::string source =
+      "var first = \"text\";\n"
+      "var second = \"text\";\n"
+      "first = 2;\n"
+      "second = 2;\n"
+      "print first == second;\n";
+
+  for (InstructionSet instruction_set : kInstructionSets) {
+    Ref<Function> script = Compile(source, instruction_set);
+    ASSERT_NE(script.get(), nullptr);
+    EXPECT_EQ(script->GetChunk()->GetConstantCount(), 2u);
+    EXPECT_TRUE(script->GetChunk()->GetNameAt(1).has_value());
+    EXPECT_FALSE(script->GetChunk()->GetNameAt(2).has_value());
+    EXPECT_EQ(RunScript(script), "true\n");
+  }
+}
+
+TEST(Compiler, CountTheMostTemporariesOnTheStack) {
+  Ref<Function> script = Compile(
+      "var a = 1;\n"
+      "print a + (a - (a - a));\n"
+      "if (a > 0) { print a; } else { print -a; }\n",
+      InstructionSet::Stack);
+  ASSERT_NE(script.get(), nullptr);
+  EXPECT_EQ(script->GetStackDepth(), 4u);
+
+  std::string source = "class Many {\n";
+
+  for (int i = 0; i < 300; ++i) {
+    source += "  method" + std::to_string(i) + "() { return 0; }\n";
+  }
+
+  script = Compile(source + "}\n", InstructionSet::Stack);
+  ASSERT_NE(script.get(), nullptr);
+  EXPECT_EQ(script->GetStackDepth(), 300u);
+
+  // Register instructions keep their temporaries within the frame.
+  script = Compile(source + "}\n", InstructionSet::Register);
+  ASSERT_NE(script.get(), nullptr);
+  EXPECT_EQ(script->GetStackDepth(), 0u);
+}
+
+TEST(Compiler, UseLongFormsForConstantsAndNamesPastAByte) {
+  std::string source;
+
+  for (int i = 0; i < 300; ++i) {
+    std::string index = std::to_string(i);
+    source += "var global" + index + " = " + index + ";\n";
+  }
+
+  source += "print global0 + global299;\n";
+
+  for (InstructionSet instruction_set : kInstructionSets) {
+    std::string disassembly = Disassemble(source, instruction_set);
+    EXPECT_NE(disassembly.find("CONSTANT_LONG"), std::string::npos);
+    EXPECT_NE(disassembly.find("OP_GET_GLOBAL_LONG"), std::string::npos);
+    EXPECT_EQ(RunWithLamscripten(source, instruction_set), "299.000000\n");
+  }
+}
+
+TEST(Compiler, UseLongFormsForLocalsPastAByte) {
+  // Locals are initialized from the parameter so that their loads aren't
+  // replaced with constants.
+  std::string source = "func Sum(start) {\n  var sum = 0;\n";
+
+  for (int i = 0; i < 300; ++i) {
+    std::string name = "local" + std::to_string(i);
+    source += "  var " + name + " = start + " + std::to_string(i) + ";\n";
+    source += "  sum = sum + " + name + ";\n";
+  }
+
+  source += "  return sum;\n}\nprint Sum(0);\n";
+
+  std::string disassembly = Disassemble(source, InstructionSet::Stack);
+  EXPECT_NE(disassembly.find("OP_GET_LOCAL_LONG"), std::string::npos);
+  EXPECT_NE(disassembly.find("OP_SET_LOCAL_LONG"), std::string::npos);
+
+  std::string output = RunWithLamscripten(source, InstructionSet::Stack);
+  EXPECT_EQ(output, "44850.000000\n");
+  EXPECT_EQ(output, RunWithLamscript(source));
+}
+
+TEST(Compiler, UseLongFormsForCellsAndUpvaluesPastAByte) {
+  std::string outer = "func outer() {\n";
+  std::string inner = "  func inner() {\n    var sum = 0;\n";
+
+  for (int i = 0; i < 300; ++i) {
+    std::string name = "captured" + std::to_string(i);
+    outer += "  var " + name + " = " + std::to_string(i) + ";\n";
+    inner += "    " + name + " = " + name + " + 1;\n";
+    inner += "    sum = sum + " + name + ";\n";
+  }
+
+  std::string source =
+      outer + inner + "    return sum;\n  }\n  return inner;\n}\n"
+      "var inner = outer();\n"
+      "print inner();\n"
+      "print inner();\n";
+
+  std::string disassembly = Disassemble(source, InstructionSet::Stack);
+  EXPECT_NE(disassembly.find("OP_MAKE_CELL_LONG"), std::string::npos);
+  EXPECT_NE(disassembly.find("OP_GET_UPVALUE_LONG"), std::string::npos);
+  EXPECT_NE(disassembly.find("OP_SET_UPVALUE_LONG"), std::string::npos);
+
+  std::string output = RunWithLamscripten(source, InstructionSet::Stack);
+  EXPECT_EQ(output, "45150.000000\n45450.000000\n");
+  EXPECT_EQ(output, RunWithLamscript(source));
+}
+
+TEST(Compiler, JumpOverLongIfBodies) {
+  std::string source =
+      MakeLongBody("if (limit > 0)", 20000) + "print Count(1);\n"
+      "print Count(0);\n";
+
+  for (InstructionSet instruction_set : kInstructionSets) {
+    std::string disassembly = Disassemble(source, instruction_set);
+    EXPECT_NE(disassembly.find("OP_JUMP_IF_FALSE_LONG"), std::string::npos);
+    EXPECT_EQ(disassembly.find("OP_JUMP_IF_FALSE "), std::string::npos);
+
+    std::string output = RunWithLamscripten(source, instruction_set);
+    EXPECT_EQ(output, "20000.000000\n0.000000\n");
+    EXPECT_EQ(output, RunWithLamscript(source));
+  }
+}
+
+TEST(Compiler, LoopOverLongWhileBodies) {
+  std::string source =
+      MakeLongBody("while (total < limit)", 20000)
+      + "print Count(50000);\n"
+      "print Count(0);\n";
+
+  for (InstructionSet instruction_set : kInstructionSets) {
+    std::string disassembly = Disassemble(source, instruction_set);
+    EXPECT_NE(disassembly.find("OP_LOOP_LONG"), std::string::npos);
+
+    std::string output = RunWithLamscripten(source, instruction_set);
+    EXPECT_EQ(output, "60000.000000\n0.000000\n");
+    EXPECT_EQ(output, RunWithLamscript(source));
+  }
+}
+
+TEST(Compiler, KeepShortJumpsInFunctionsAroundLongOnes) {
+  std::string source =
+      "func Small(value) { if (value) { return 1; } return 2; }\n"
+      + MakeLongBody("if (Small(limit) == 1)", 20000)
+      + "print Count(true);\n";
+
+  for (InstructionSet instruction_set : kInstructionSets) {
+    std::string disassembly = Disassemble(source, instruction_set);
+    EXPECT_NE(disassembly.find("OP_JUMP_IF_FALSE "), std::string::npos);
+    EXPECT_NE(disassembly.find("OP_JUMP_IF_FALSE_LONG"), std::string::npos);
+    EXPECT_EQ(
+        RunWithLamscripten(source, instruction_set), "20000.000000\n");
+  }
+}
+
+TEST(Compiler, ReportOtherErrorsOnceInFunctionsWithLongJumps) {
+  std::string locals;
+
+  for (int i = 0; i < 300; ++i) {
+    std::string name = "local" + std::to_string(i);
+    locals += "  var " + name + " = " + std::to_string(i) + ";\n";
+    locals += "  total = total + " + name + ";\n";
+  }
+
+  std::string source = MakeLongBody("if (limit > 0)", 20000);
+  source.insert(source.find("  if"), locals);
+
+  source += "print Count(1);\n";
+
+  EXPECT_EQ(
+      RunWithLamscripten(source, InstructionSet::Register),
+      "[line 1] Error: Too many local variables in function.\n");
+}
@@ -0,0 +1,105 @@
+#include <gtest/gtest.h>
+
+#include <cstdio>
+#include <filesystem>
+#include <string>
+
+#include <Lamscripten/cache/BytecodeCache.h>
+#include <Lamscripten/core/Chunk.h>
+#include <Lamscripten/core/Function.h>
+
+#include "RunScript.h"
+
+using ::lamscripten::core::Function;
+using ::lamscripten::core::InstructionSet;
+using ::lamscripten::core::Ref;
+using ::lamscripten::test::Compile;
+using ::lamscripten::test::ReadFile;
+using ::lamscripten::test::RunScript;
+using ::lamscripten::test::RunWithLamscript;
+using ::lamscripten::test::RunWithLamscripten;
+
+namespace {
+
+/// @brief The examples that print the same output every time they're run.
+/// math.ls prints the time and lambda.ls prints the generated names of its
+/// lambdas, so they're left out.
+const char* kExamples[] = {
+  "examples/anonymous.ls",
+  "examples/blocks.ls",
+  "examples/class.ls",
+  "examples/closure.ls",
+  "examples/conditionals.ls",
+  "examples/func.ls",
+  "examples/getters.ls",
+  "examples/inheritance.ls",
+  "examples/logical.ls",
+  "examples/loops.ls",
+  "examples/print.ls",
+  "examples/recursion.ls",
+  "examples/super.ls",
+  "examples/variable.ls",
+};
+
+/// @brief Compiles the example, writes it to a cache file and runs the script
+/// loaded back from the cache.
+std::string RunFromCache(
+    const std::string& source, InstructionSet instruction_set) {
+  std::string path = (
+      std::filesystem::temp_directory_path() / "lamscripten-example.lsc")
+          .string();
+  uint64_t hash = lamscripten::cache::HashSource(source);
+  Ref<Function> script = Compile(source, instruction_set);
+
+  if (script.get() == nullptr
+      || !lamscripten::cache::WriteCache(path, hash, *script)) {
+    return "couldn't cache the example";
+  }
+
+  Ref<Function> cached = lamscripten::cache::LoadCache(
+      path, hash, instruction_set);
+  std::remove(path.c_str());
+
+  if (cached.get() == nullptr) {
+    return "couldn't load the cached example";
+  }
+
+  return RunScript(cached);
+}
+
+}  // namespace
+
+TEST(LamscriptenExamples, StackMachineMatchesTheTreeWalker) {
+  for (const char* example : kExamples) {
+    std::string source = ReadFile(example);
+    ASSERT_FALSE(source.empty()) << "couldn't read " << example;
+    EXPECT_EQ(
+        RunWithLamscripten(source, InstructionSet::Stack),
+        RunWithLamscript(source))
+        << "when running " << example;
+  }
+}
+
+TEST(LamscriptenExamples, RegisterMachineMatchesTheTreeWalker) {
+  for (const char* example : kExamples) {
+    std::string source = ReadFile(example);
+    ASSERT_FALSE(source.empty()) << "couldn't read " << example;
+    EXPECT_EQ(
+        RunWithLamscripten(source, InstructionSet::Register),
+        RunWithLamscript(source))
+        << "when running " << example;
+  }
+}
+
+TEST(LamscriptenExamples, CachedScriptsMatchTheTreeWalker) {
+  for (const char* example : kExamples) {
+    std::string source = ReadFile(example);
+    ASSERT_FALSE(source.empty()) << "couldn't read " << example;
+    std::string expected = RunWithLamscript(source);
+
+    EXPECT_EQ(RunFromCache(source, InstructionSet::Stack), expected)
+        << "when running " << example << " from a stack cache";
+    EXPECT_EQ(RunFromCache(source, InstructionSet::Register), expected)
+        << "when running " << example << " from a register cache";
+  }
+}
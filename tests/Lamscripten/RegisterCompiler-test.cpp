@@ -0,0 +1,75 @@
+#include <gtest/gtest.h>
+
+#include <string>
+
+#include <Lamscripten/core/Chunk.h>
+
+#include "RunScript.h"
+
+using ::lamscripten::core::InstructionSet;
+using ::lamscripten::test::RunWithLamscript;
+using ::lamscripten::test::RunWithLamscripten;
+
+TEST(RegisterCompiler, CompileClassesWithMoreMethodsThanRegisters) {
+  std::string source = "class Many extends Base {\n";
+
+  for (int i = 0; i < 300; ++i) {
+    source += "  method" + std::to_string(i) + "() { return "
+        + std::to_string(i) + "; }\n";
+  }
+
+  source =
+      "class Base { inherited() { return \"base\"; } method0() { return -1; } "
+      "}\n" + source + "}\n"
+      "var many = Many();\n"
+      "print many.method0();\n"
+      "print many.method299();\n"
+      "print many.inherited();\n";
+
+  std::string output = RunWithLamscripten(source, InstructionSet::Register);
+  EXPECT_EQ(output, "0.000000\n299.000000\nbase\n");
+  EXPECT_EQ(output, RunWithLamscript(source));
+}
+
+TEST(RegisterCompiler, CompileFunctionsWithMoreUpvaluesThanRegisters) {
+  std::string outer = "func outer() {\n";
+  std::string middle = "  func middle() {\n";
+  std::string inner = "    func inner() {\n      var sum = 0;\n";
+
+  for (int i = 0; i < 150; ++i) {
+    std::string index = std::to_string(i);
+    outer += "  var outer" + index + " = " + index + ";\n";
+    middle += "    var middle" + index + " = " + index + ";\n";
+    inner += "      sum = sum + outer" + index + ";\n";
+    inner += "      middle" + index + " = middle" + index + " + 1;\n";
+    inner += "      sum = sum + middle" + index + ";\n";
+  }
+
+  std::string source =
+      outer + middle + inner
+      + "      return sum;\n    }\n    return inner;\n  }\n"
+      "  return middle();\n}\n"
+      "var inner = outer();\n"
+      "print inner();\n"
+      "print inner();\n";
+
+  std::string output = RunWithLamscripten(source, InstructionSet::Register);
+  EXPECT_EQ(output, "22500.000000\n22650.000000\n");
+  EXPECT_EQ(output, RunWithLamscript(source));
+}
+
+TEST(RegisterCompiler, ReportTooManyLocalsOnceAtTheirFunction) {
+  std::string source = "\nfunc many() {\n";
+
+  for (int i = 0; i < 300; ++i) {
+    std::string name = "local" + std::to_string(i);
+    source += "  var " + name + " = " + std::to_string(i) + "; print " + name
+        + ";\n";
+  }
+
+  source += "}\n";
+
+  EXPECT_EQ(
+      RunWithLamscripten(source, InstructionSet::Register),
+      "[line 2] Error: Too many local variables in function.\n");
+}
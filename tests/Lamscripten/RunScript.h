@@ -0,0 +1,98 @@
+#ifndef TESTS_LAMSCRIPTEN_RUNSCRIPT_H_
+#define TESTS_LAMSCRIPTEN_RUNSCRIPT_H_
+
+#include <fstream>
+#include <iostream>
+#include <iterator>
+#include <memory>
+#include <sstream>
+#include <string>
+
+#include <Lamscript/runtime/Lamscript.h>
+#include <Lamscripten/compiler/Compiler.h>
+#include <Lamscripten/compiler/RegisterCompiler.h>
+#include <Lamscripten/core/Chunk.h>
+#include <Lamscripten/core/Function.h>
+#include <Lamscripten/vm/VirtualMachine.h>
+
+namespace lamscripten::test {
+
+/// @brief Calls run and returns everything that it printed.
+template<class Callable>
+std::string CaptureOutput(Callable run) {
+  std::ostringstream output;
+  std::streambuf* previous_buffer = std::cout.rdbuf(output.rdbuf());
+  run();
+  std::cout.rdbuf(previous_buffer);
+  return output.str();
+}
+
+inline std::string ReadFile(const std::string& path) {
+  std::ifstream file(path, std::ios::in | std::ios::binary);
+  return std::string(
+      (std::istreambuf_iterator<char>(file)),
+      std::istreambuf_iterator<char>());
+}
+
+/// @brief Compiles source into the instruction set the same way lamscripten
+/// does. Returns a nullptr if the source doesn't parse or can't be encoded,
+/// after the errors have been reported.
+inline core::Ref<core::Function> Compile(
+    const std::string& source, core::InstructionSet instruction_set) {
+  lamscript::runtime::ParsedProgram program;
+  lamscript::runtime::ProgramResult result =
+      lamscript::runtime::Lamscript::Parse(source, &program);
+
+  if (result.Status != lamscript::runtime::ProgramStatus::Success) {
+    return nullptr;
+  }
+
+  if (instruction_set == core::InstructionSet::Register) {
+    compiler::RegisterCompiler compiler;
+    core::Ref<core::Function> script = compiler.Compile(
+        program.Statements, program.FrameSize);
+    return compiler.HadError() ? nullptr : script;
+  }
+
+  compiler::Compiler compiler;
+  core::Ref<core::Function> script = compiler.Compile(
+      program.Statements, program.FrameSize);
+  return compiler.HadError() ? nullptr : script;
+}
+
+/// @brief Runs a compiled script on a new virtual machine and returns
+/// everything that it printed.
+inline std::string RunScript(const core::Ref<core::Function>& script) {
+  return CaptureOutput([&script]() {
+    auto machine = std::make_unique<vm::VirtualMachine>();
+    machine->Interpret(script);
+  });
+}
+
+/// @brief Compiles and runs source with lamscripten, returning everything
+/// that was printed, including the errors that were reported.
+inline std::string RunWithLamscripten(
+    const std::string& source, core::InstructionSet instruction_set) {
+  core::Ref<core::Function> script;
+  std::string output = CaptureOutput([&]() {
+    script = Compile(source, instruction_set);
+  });
+
+  if (script.get() == nullptr) {
+    return output;
+  }
+
+  return output + RunScript(script);
+}
+
+/// @brief Runs source with lamscript's tree walking interpreter, returning
+/// everything that it printed.
+inline std::string RunWithLamscript(const std::string& source) {
+  return CaptureOutput([&source]() {
+    lamscript::runtime::Lamscript::Run(source);
+  });
+}
+
+}  // namespace lamscripten::test
+
+#endif  // TESTS_LAMSCRIPTEN_RUNSCRIPT_H_
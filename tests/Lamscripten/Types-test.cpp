@@ -0,0 +1,230 @@
+#include <gtest/gtest.h>
+
+#include <string>
+#include <utility>
+
+#include <Lamscripten/core/Types.h>
+
+using ::lamscripten::core::DynamicArray;
+using ::lamscripten::core::FixedArray;
+
+namespace {
+
+/// @brief Counts the bytes that arrays using it hold, to check that every
+/// allocation is freed with the size it was made with.
+struct CountingAllocator {
+  static inline size_t allocated_bytes = 0;
+
+  [[nodiscard]] static void* Allocate(size_t bytes) {
+    allocated_bytes += bytes;
+    return HeapAllocator::Allocate(bytes);
+  }
+
+  [[nodiscard]] static void* Reallocate(
+      void* memory, size_t old_bytes, size_t new_bytes) {
+    allocated_bytes += new_bytes - old_bytes;
+    return HeapAllocator::Reallocate(memory, old_bytes, new_bytes);
+  }
+
+  static void Free(void* memory, size_t bytes) {
+    allocated_bytes -= bytes;
+    HeapAllocator::Free(memory, bytes);
+  }
+};
+
+/// @brief Fills an array with the strings "0" through "count - 1", which are
+/// long enough to live on the heap so that leaks and double frees show up.
+DynamicArray<std::string> MakeStrings(size_t count) {
+  DynamicArray<std::string> array;
+
+  for (size_t i = 0; i < count; i++) {
+    size_t _ = array.PushCopy(std::to_string(i) + std::string(32, '.'));
+  }
+
+  return array;
+}
+
+std::string GetString(size_t index) {
+  return std::to_string(index) + std::string(32, '.');
+}
+
+}  // namespace
+
+TEST(DynamicArray, DoubleItsCapacityAsItGrows) {
+  DynamicArray<int> array;
+  EXPECT_EQ(array.GetCapacity(), 0u);
+
+  for (int i = 0; i < 9; i++) {
+    EXPECT_EQ(array.PushCopy(i), static_cast<size_t>(i));
+  }
+
+  EXPECT_EQ(array.GetCount(), 9u);
+  EXPECT_EQ(array.GetCapacity(), 16u);
+
+  for (int i = 0; i < 9; i++) {
+    EXPECT_EQ(array.GetAtIndex(i), i);
+  }
+
+  EXPECT_FALSE(array.GetAtIndex(9).has_value());
+}
+
+TEST(DynamicArray, MoveElementsThatAreNotTriviallyCopyable) {
+  DynamicArray<std::string> array = MakeStrings(100);
+
+  ASSERT_EQ(array.GetCount(), 100u);
+  for (size_t i = 0; i < array.GetCount(); i++) {
+    EXPECT_EQ(array.begin()[i], GetString(i));
+  }
+
+  EXPECT_EQ(array.Pop(), GetString(99));
+  EXPECT_EQ(array.GetCount(), 99u);
+}
+
+TEST(DynamicArray, CopyIntoIndependentMemory) {
+  DynamicArray<std::string> original = MakeStrings(10);
+  DynamicArray<std::string> copy(original);
+
+  EXPECT_EQ(copy.GetCount(), 10u);
+  EXPECT_EQ(copy.GetCapacity(), 10u);
+  EXPECT_NE(copy.begin(), original.begin());
+
+  copy.SetAtIndex(0, "changed");
+  size_t _ = copy.PushCopy("added");
+  EXPECT_EQ(original.GetAtIndex(0), GetString(0));
+  EXPECT_EQ(original.GetCount(), 10u);
+
+  DynamicArray<std::string> assigned = MakeStrings(3);
+  assigned = original;
+  EXPECT_EQ(assigned.GetCount(), 10u);
+  EXPECT_EQ(assigned.GetAtIndex(9), GetString(9));
+  EXPECT_NE(assigned.begin(), original.begin());
+}
+
+TEST(DynamicArray, MoveByTakingMemory) {
+  DynamicArray<std::string> original = MakeStrings(10);
+  const std::string* elements = original.begin();
+
+  DynamicArray<std::string> moved(std::move(original));
+  EXPECT_EQ(moved.begin(), elements);
+  EXPECT_EQ(moved.GetCount(), 10u);
+  EXPECT_EQ(original.GetCount(), 0u);  // NOLINT(bugprone-use-after-move)
+  EXPECT_EQ(original.GetCapacity(), 0u);
+
+  DynamicArray<std::string> assigned = MakeStrings(3);
+  assigned = std::move(moved);
+  EXPECT_EQ(assigned.begin(), elements);
+  EXPECT_EQ(assigned.GetAtIndex(9), GetString(9));
+  EXPECT_EQ(moved.GetCount(), 0u);  // NOLINT(bugprone-use-after-move)
+
+  // Arrays that were moved from can be used again.
+  size_t _ = moved.PushCopy("reused");
+  EXPECT_EQ(moved.GetAtIndex(0), "reused");
+}
+
+TEST(DynamicArray, KeepElementsWhenAssignedToThemselves) {
+  DynamicArray<std::string> array = MakeStrings(10);
+  DynamicArray<std::string>& same = array;
+
+  array = same;
+  EXPECT_EQ(array.GetCount(), 10u);
+  EXPECT_EQ(array.GetAtIndex(9), GetString(9));
+
+  array = std::move(same);
+  EXPECT_EQ(array.GetCount(), 10u);
+  EXPECT_EQ(array.GetAtIndex(9), GetString(9));
+}
+
+TEST(DynamicArray, DestroyElementsThatNoLongerFit) {
+  DynamicArray<std::string> array = MakeStrings(10);
+
+  array.ShrinkTo(5);
+  EXPECT_EQ(array.GetCapacity(), 16u);
+
+  array.ResizeTo(4);
+  EXPECT_EQ(array.GetCount(), 4u);
+  EXPECT_EQ(array.GetCapacity(), 4u);
+  EXPECT_EQ(array.GetAtIndex(3), GetString(3));
+
+  array.ResizeTo(0);
+  EXPECT_EQ(array.GetCount(), 0u);
+  EXPECT_EQ(array.begin(), nullptr);
+}
+
+TEST(DynamicArray, FreeWhatItAllocates) {
+  {
+    DynamicArray<double, CountingAllocator> numbers;
+    DynamicArray<std::string, CountingAllocator> strings;
+
+    for (int i = 0; i < 100; i++) {
+      size_t _ = numbers.PushCopy(i);
+      _ = strings.PushCopy(GetString(i));
+    }
+
+    EXPECT_EQ(
+        CountingAllocator::allocated_bytes,
+        numbers.GetCapacity() * sizeof(double)
+            + strings.GetCapacity() * sizeof(std::string));
+
+    DynamicArray<double, CountingAllocator> copy(numbers);
+    copy.ShrinkTo(copy.GetCount());
+    numbers = std::move(copy);
+  }
+
+  EXPECT_EQ(CountingAllocator::allocated_bytes, 0u);
+}
+
+TEST(FixedArray, PushAndPopInOrder) {
+  FixedArray<int, 4> array;
+  static_assert(FixedArray<int, 4>::GetCapacity() == 4);
+
+  EXPECT_EQ(array.Push(1), 0u);
+  EXPECT_EQ(array.Push(2), 1u);
+  EXPECT_EQ(array.Push(3), 2u);
+  EXPECT_EQ(array.Push(4), 3u);
+  EXPECT_TRUE(array.IsFull());
+  EXPECT_EQ(array.end() - array.begin(), 4);
+
+  EXPECT_EQ(array.Pop(), 4);
+  EXPECT_EQ(array.Pop(), 3);
+  EXPECT_FALSE(array.IsFull());
+  EXPECT_EQ(array.GetCount(), 2u);
+  EXPECT_EQ(array[1], 2);
+
+  array[1] = 5;
+  EXPECT_EQ(array.Pop(), 5);
+  EXPECT_EQ(array.Pop(), 1);
+  EXPECT_FALSE(array.Pop().has_value());
+}
+
+TEST(FixedArray, StartWithSlotsInUse) {
+  FixedArray<int, 8> array(8);
+
+  EXPECT_TRUE(array.IsFull());
+  for (int value : array) {
+    EXPECT_EQ(value, 0);
+  }
+}
+
+TEST(FixedArray, ResetElementsWhenTheyArePopped) {
+  FixedArray<std::string, 4> array;
+  size_t _ = array.Push(GetString(0));
+  _ = array.Push(GetString(1));
+  _ = array.Push(GetString(2));
+
+  array.Truncate(1);
+  EXPECT_EQ(array.GetCount(), 1u);
+  EXPECT_EQ(array[0], GetString(0));
+  EXPECT_TRUE(array.begin()[1].empty());
+  EXPECT_TRUE(array.begin()[2].empty());
+
+  EXPECT_EQ(array.Pop(), GetString(0));
+  EXPECT_TRUE(array.begin()[0].empty());
+}
+
+TEST(FixedArray, CheckIndicesInDebugBuilds) {
+  FixedArray<int, 4> array;
+  size_t _ = array.Push(1);
+
+  EXPECT_DEBUG_DEATH({ array[2] = 0; }, "");
+  EXPECT_DEBUG_DEATH(array.Truncate(3), "");
+}
@@ -0,0 +1,160 @@
+#include <gtest/gtest.h>
+
+#include <memory>
+#include <string>
+
+#include <Lamscripten/core/Chunk.h>
+#include <Lamscripten/core/Function.h>
+#include <Lamscripten/vm/VirtualMachine.h>
+
+#include "RunScript.h"
+
+using ::lamscripten::core::Function;
+using ::lamscripten::core::InstructionSet;
+using ::lamscripten::core::Ref;
+using ::lamscripten::test::CaptureOutput;
+using ::lamscripten::test::Compile;
+using ::lamscripten::test::RunWithLamscript;
+using ::lamscripten::test::RunWithLamscripten;
+using ::lamscripten::vm::InterpretResult;
+using ::lamscripten::vm::VirtualMachine;
+
+namespace {
+
+const InstructionSet kInstructionSets[] = {
+  InstructionSet::Stack,
+  InstructionSet::Register,
+};
+
+}  // namespace
+
+TEST(VirtualMachine, RecoverFromErrorsInFunctionBodies) {
+  const std::string source =
+      "func Fail(value) {\n"
+      "  print value;\n"
+      "  print value + nil;\n"
+      "  print \"unreachable\";\n"
+      "}\n"
+      "print Fail(1);\n"
+      "{\n"
+      "  print -\"text\";\n"
+      "  print \"unreachable\";\n"
+      "}\n"
+      "print \"done\";\n";
+
+  for (InstructionSet instruction_set : kInstructionSets) {
+    std::string output = RunWithLamscripten(source, instruction_set);
+    EXPECT_EQ(
+        output,
+        "1.000000\n"
+        "[line 3] RuntimeError: Operands must be two numbers or strings.\n"
+        "nil\n"
+        "[line 8] RuntimeError: Operand must be a number.\n"
+        "done\n");
+    EXPECT_EQ(output, RunWithLamscript(source));
+  }
+}
+
+TEST(VirtualMachine, StopAtErrorsInTopLevelStatements) {
+  for (InstructionSet instruction_set : kInstructionSets) {
+    EXPECT_EQ(
+        RunWithLamscripten(
+            "print 1;\nprint missing;\nprint 2;\n", instruction_set),
+        "1.000000\n[line 2] RuntimeError: Undefined variable: 'missing'.\n");
+  }
+}
+
+TEST(VirtualMachine, ReportStackOverflows) {
+  const std::string source =
+      "func Recurse(depth) { return Recurse(depth + 1); }\n"
+      "print Recurse(0);\n"
+      "print \"done\";\n";
+
+  for (InstructionSet instruction_set : kInstructionSets) {
+    EXPECT_EQ(
+        RunWithLamscripten(source, instruction_set),
+        "[line 1] RuntimeError: Stack overflow.\nnil\ndone\n");
+  }
+}
+
+TEST(VirtualMachine, ReportStackOverflowsOfFramesEndingAtTheStackLimit) {
+  // Each call to Recurse takes six registers and starts four slots above the
+  // last, so once the frames run out the innermost one ends exactly at the
+  // end of the stack, where the error is recovered from.
+  static_assert(VirtualMachine::kMaxStackSize == 4 * VirtualMachine::kMaxFrames);
+  const std::string source =
+      "func Recurse(depth, step) {\n"
+      "  var next = depth;\n"
+      "  return Recurse(next, step);\n"
+      "}\n"
+      "print Recurse(0, 1);\n"
+      "print \"done\";\n";
+
+  EXPECT_EQ(
+      RunWithLamscripten(source, InstructionSet::Register),
+      "[line 3] RuntimeError: Stack overflow.\nnil\ndone\n");
+}
+
+TEST(VirtualMachine, ReportStackOverflowsBeforeDefiningLargeClasses) {
+  // Each call keeps its locals on the stack and pushes a closure for every
+  // method of the class, so the stack runs out partway through a class.
+  std::string source = "func Recurse(depth) {\n";
+
+  for (int i = 0; i < 50; ++i) {
+    std::string name = "local" + std::to_string(i);
+    source += "  var " + name + " = depth; depth = " + name + ";\n";
+  }
+
+  source += "  class Many {\n";
+
+  for (int i = 0; i < 300; ++i) {
+    source += "    method" + std::to_string(i) + "() { return "
+        + std::to_string(i) + "; }\n";
+  }
+
+  source +=
+      "  }\n"
+      "  return Recurse(depth + Many().method1());\n"
+      "}\n"
+      "print Recurse(0);\n"
+      "print \"done\";\n";
+
+  Ref<Function> script = Compile(source, InstructionSet::Stack);
+  ASSERT_NE(script.get(), nullptr);
+  EXPECT_GE(script->GetStackDepth(), 1u);
+
+  std::string output = RunWithLamscripten(source, InstructionSet::Stack);
+  EXPECT_NE(output.find("RuntimeError: Stack overflow.\n"), std::string::npos)
+      << output;
+  EXPECT_EQ(output.substr(output.size() - 9), "nil\ndone\n");
+}
+
+TEST(VirtualMachine, KeepGlobalsBetweenPrograms) {
+  for (InstructionSet instruction_set : kInstructionSets) {
+    Ref<Function> define = Compile(
+        "var greeting = \"hello\";\n"
+        "func Greet(name) { print greeting + name; }\n",
+        instruction_set);
+    Ref<Function> call = Compile("Greet(\"world\");\n", instruction_set);
+    Ref<Function> fail = Compile("print greeting + 1;\n", instruction_set);
+    ASSERT_NE(define.get(), nullptr);
+    ASSERT_NE(call.get(), nullptr);
+    ASSERT_NE(fail.get(), nullptr);
+
+    auto machine = std::make_unique<VirtualMachine>();
+    InterpretResult result = InterpretResult::Ok;
+    std::string output = CaptureOutput([&]() {
+      result = machine->Interpret(define);
+      EXPECT_EQ(result, InterpretResult::Ok);
+      result = machine->Interpret(call);
+      EXPECT_EQ(result, InterpretResult::Ok);
+      result = machine->Interpret(fail);
+    });
+
+    EXPECT_EQ(result, InterpretResult::RuntimeError);
+    EXPECT_EQ(
+        output,
+        "helloworld\n"
+        "[line 1] RuntimeError: Operands must be two numbers or strings.\n");
+  }
+}
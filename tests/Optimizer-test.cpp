@@ -0,0 +1,67 @@
+#include <gtest/gtest.h>
+
+#include <string>
+
+#include <Lamscript/parsed/Expression.h>
+#include <Lamscript/parsed/Statement.h>
+#include <Lamscript/runtime/Lamscript.h>
+
+using ::lamscript::parsed::Block;
+using ::lamscript::parsed::Literal;
+using ::lamscript::parsed::Print;
+using ::lamscript::parsed::Statement;
+using ::lamscript::runtime::Lamscript;
+using ::lamscript::runtime::ParsedProgram;
+using ::lamscript::runtime::ProgramStatus;
+
+namespace {
+
+/// @brief Parses a program that consists of a single block and returns the
+/// expression printed by its last statement.
+const Literal* ParsePrintedLiteral(
+    const std::string& source, ParsedProgram* program) {
+  EXPECT_EQ(Lamscript::Parse(source, program).Status, ProgramStatus::Success);
+  auto block = dynamic_cast<Block*>(program->Statements.front().get());
+  auto print = dynamic_cast<Print*>(block->GetStatements().back().get());
+  return dynamic_cast<const Literal*>(print->GetExpression());
+}
+
+}  // namespace
+
+TEST(Optimizer, FoldConstantExpressions) {
+  ParsedProgram program;
+  const Literal* literal = ParsePrintedLiteral(
+      "{ print (1 + 2) * 3 - (4 / 2) > 6 and !false; }", &program);
+
+  ASSERT_NE(literal, nullptr);
+  ASSERT_TRUE(literal->GetValue().IsBoolean());
+  EXPECT_TRUE(literal->GetValue().AsBoolean());
+}
+
+TEST(Optimizer, PropagateLocalsThatAreNeverReassigned) {
+  ParsedProgram program;
+  const Literal* literal = ParsePrintedLiteral(
+      "{ var width = 4; var height = width * 2; print width * height; }",
+      &program);
+
+  ASSERT_NE(literal, nullptr);
+  ASSERT_TRUE(literal->GetValue().IsNumber());
+  EXPECT_EQ(literal->GetValue().AsNumber(), 32);
+}
+
+TEST(Optimizer, KeepReadingReassignedLocals) {
+  ParsedProgram program;
+  const Literal* literal = ParsePrintedLiteral(
+      "{ var count = 1; print count; count = count + 1; print count; }",
+      &program);
+
+  EXPECT_EQ(literal, nullptr);
+}
+
+TEST(Optimizer, KeepDivisionsByZero) {
+  ParsedProgram program;
+  const Literal* literal = ParsePrintedLiteral(
+      "{ var zero = 0; print 1 / zero; }", &program);
+
+  EXPECT_EQ(literal, nullptr);
+}
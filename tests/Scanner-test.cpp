@@ -75,3 +75,34 @@ TEST(Scanner, ScanPrint) {
   const Token& eof = tokens[3];
   EXPECT_EQ(eof.Type, TokenType::END_OF_FILE);
 }
+
+TEST(Scanner, InternIdentifiers) {
+  Scanner scanner("foo bar foo print;");
+  const std::vector<Token> tokens = scanner.ScanTokens();
+  ASSERT_EQ(tokens.size(), 6);
+
+  const Token& first_foo = tokens[0];
+  const Token& bar = tokens[1];
+  const Token& second_foo = tokens[2];
+  EXPECT_EQ(first_foo.Type, TokenType::IDENTIFIER);
+  EXPECT_TRUE(first_foo.Identifier.IsValid());
+  EXPECT_EQ(first_foo.Identifier, second_foo.Identifier);
+  EXPECT_NE(first_foo.Identifier, bar.Identifier);
+  EXPECT_EQ(first_foo.Identifier.GetName(), "foo");
+
+  const Token& print = tokens[3];
+  EXPECT_FALSE(print.Identifier.IsValid());
+}
+
+TEST(Scanner, InternSynthesizedNames) {
+  Scanner scanner("this super");
+  const std::vector<Token> tokens = scanner.ScanTokens();
+  ASSERT_EQ(tokens.size(), 3);
+
+  const Token this_token{TokenType::THIS, "this", nullptr, 0};
+  const Token super_token{TokenType::SUPER, "super", nullptr, 0};
+  EXPECT_EQ(this_token.Identifier, tokens[0].Identifier);
+  EXPECT_EQ(super_token.Identifier, tokens[1].Identifier);
+  EXPECT_EQ(this_token.Identifier.GetName(), "this");
+  EXPECT_FALSE(tokens[2].Identifier.IsValid());
+}